@@ -47,10 +47,33 @@ SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/lcuscene.cpp \
+    src/lcuview.cpp \
+    src/framestats.cpp \
+    src/framestatsoverlay.cpp \
+    src/displaylist.cpp \
+    src/tilerenderer.cpp \
     src/lcuscene3d.cpp \
+    src/instancedparts.cpp \
+    src/layoutbuilder.cpp \
+    src/fleetmodel.cpp \
+    src/fleetview.cpp \
     src/datamodel.cpp \
     src/animationcontroller.cpp \
     src/animationcontroller3d.cpp \
+    src/simulationclock.cpp \
+    src/rendersnapshot.cpp \
+    src/wakeupmonitor.cpp \
+    src/multiratescheduler.cpp \
+    src/pidcontroller.cpp \
+    src/controlinterface.cpp \
+    src/controlsystem.cpp \
+    src/scenarioengine.cpp \
+    src/headlessrunner.cpp \
+    src/benchmarks.cpp \
+    src/lookaheadpredictor.cpp \
+    src/p2quantile.cpp \
+    src/montecarloanalysis.cpp \
+    src/sensorfaultinjector.cpp \
     src/components/basecomponent.cpp \
     src/components/pump.cpp \
     src/components/valve.cpp \
@@ -60,16 +83,47 @@ SOURCES += \
     src/components/condenser.cpp \
     src/components/blower.cpp \
     src/components/pipe.cpp \
+    src/components/rotationatlas.cpp \
+    src/components/rendercache.cpp \
+    src/components/textcache.cpp \
+    src/components/labelitem.cpp \
+    src/components/valuelabel.cpp \
+    src/components/pipebatch.cpp \
+    src/components/statusledbatch.cpp \
     src/components/solenoidvalve.cpp
 
 # Header files
 HEADERS += \
     src/mainwindow.h \
     src/lcuscene.h \
+    src/lcuview.h \
+    src/framestats.h \
+    src/framestatsoverlay.h \
+    src/displaylist.h \
+    src/tilerenderer.h \
     src/lcuscene3d.h \
+    src/instancedparts.h \
+    src/layoutbuilder.h \
+    src/fleetmodel.h \
+    src/fleetview.h \
     src/datamodel.h \
     src/animationcontroller.h \
     src/animationcontroller3d.h \
+    src/simulationclock.h \
+    src/rendersnapshot.h \
+    src/wakeupmonitor.h \
+    src/multiratescheduler.h \
+    src/pidcontroller.h \
+    src/controlinterface.h \
+    src/controlsystem.h \
+    src/scenarioengine.h \
+    src/headlessrunner.h \
+    src/benchmarks.h \
+    src/lookaheadpredictor.h \
+    src/p2quantile.h \
+    src/montecarloanalysis.h \
+    src/sensorfaultinjector.h \
+    src/xoshiro256.h \
     src/components/basecomponent.h \
     src/components/pump.h \
     src/components/valve.h \
@@ -79,6 +133,13 @@ HEADERS += \
     src/components/condenser.h \
     src/components/blower.h \
     src/components/pipe.h \
+    src/components/rotationatlas.h \
+    src/components/rendercache.h \
+    src/components/textcache.h \
+    src/components/labelitem.h \
+    src/components/valuelabel.h \
+    src/components/pipebatch.h \
+    src/components/statusledbatch.h \
     src/components/solenoidvalve.h
 
 # Include paths
@@ -90,9 +151,9 @@ INCLUDEPATH += \
 # FORMS += \
 #     src/mainwindow.ui
 
-# Resources (if any QRC files are added in the future)
-# RESOURCES += \
-#     resources/resources.qrc
+# Resources
+RESOURCES += \
+    resources/resources.qrc
 
 # Platform-specific settings
 win32 {
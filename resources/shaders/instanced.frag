@@ -0,0 +1,76 @@
+#version 150 core
+
+in vec3 worldPosition;
+in vec3 worldNormal;
+in vec4 color;
+
+out vec4 fragColor;
+
+// Qt 3D's light uniforms, filled from the scene's light components
+const int MAX_LIGHTS = 8;
+const int TYPE_POINT = 0;
+const int TYPE_DIRECTIONAL = 1;
+const int TYPE_SPOT = 2;
+struct Light {
+    int type;
+    vec3 position;
+    vec3 color;
+    float intensity;
+    vec3 direction;
+    float constantAttenuation;
+    float linearAttenuation;
+    float quadraticAttenuation;
+    float cutOffAngle;
+};
+uniform Light lights[MAX_LIGHTS];
+uniform int lightCount;
+uniform vec3 eyePosition;
+
+// The look LCUScene3D::phongMaterial() gives the parts drawn one by one
+const vec3 specularColor = vec3(1.0);
+const float shininess = 50.0;
+const float ambientFactor = 1.0 / 1.2;
+
+// Qt 3D's Phong model, as QPhongMaterial evaluates it
+void adsModel(vec3 n, vec3 v, out vec3 diffuseLight, out vec3 specularLight)
+{
+    diffuseLight = vec3(0.0);
+    specularLight = vec3(0.0);
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 s;
+        float attenuation = 1.0;
+        if (lights[i].type != TYPE_DIRECTIONAL) {
+            s = lights[i].position - worldPosition;
+            float d = length(s);
+            if (lights[i].constantAttenuation != 0.0 || lights[i].linearAttenuation != 0.0
+                    || lights[i].quadraticAttenuation != 0.0) {
+                attenuation = 1.0 / (lights[i].constantAttenuation + lights[i].linearAttenuation * d
+                                     + lights[i].quadraticAttenuation * d * d);
+            }
+            s = normalize(s);
+            if (lights[i].type == TYPE_SPOT
+                    && degrees(acos(dot(-s, normalize(lights[i].direction)))) > lights[i].cutOffAngle) {
+                attenuation = 0.0;
+            }
+        } else {
+            s = normalize(-lights[i].direction);
+        }
+        
+        float diffuse = max(dot(s, n), 0.0);
+        float specular = 0.0;
+        if (diffuse > 0.0 && attenuation > 0.0) {
+            vec3 r = reflect(-s, n);
+            specular = (shininess + 2.0) / 2.0 * pow(max(dot(r, v), 0.0), shininess);
+        }
+        diffuseLight += attenuation * lights[i].intensity * diffuse * lights[i].color;
+        specularLight += attenuation * lights[i].intensity * specular * lights[i].color;
+    }
+}
+
+void main()
+{
+    vec3 diffuseLight;
+    vec3 specularLight;
+    adsModel(normalize(worldNormal), normalize(eyePosition - worldPosition), diffuseLight, specularLight);
+    fragColor = vec4(color.rgb * (ambientFactor + diffuseLight) + specularColor * specularLight, color.a);
+}
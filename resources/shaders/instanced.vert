@@ -0,0 +1,28 @@
+#version 150 core
+
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+in vec4 instanceColumn0;
+in vec4 instanceColumn1;
+in vec4 instanceColumn2;
+in vec4 instanceColumn3;
+in vec4 instanceColor;
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+out vec4 color;
+
+uniform mat4 modelMatrix;
+uniform mat4 viewProjectionMatrix;
+
+void main()
+{
+    mat4 world = modelMatrix * mat4(instanceColumn0, instanceColumn1, instanceColumn2, instanceColumn3);
+    // Parts are only scaled along the axes their faces are normal to, or
+    // evenly around a cylinder's axis, so no inverse-transpose is needed
+    worldNormal = normalize(mat3(world) * vertexNormal);
+    color = instanceColor;
+    vec4 position = world * vec4(vertexPosition, 1.0);
+    worldPosition = position.xyz;
+    gl_Position = viewProjectionMatrix * position;
+}
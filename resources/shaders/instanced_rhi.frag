@@ -0,0 +1,94 @@
+#version 450 core
+
+layout(location = 0) in vec3 worldNormal;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec3 worldPosition;
+
+layout(location = 0) out vec4 fragColor;
+
+// Qt 3D's standard render view block, up to the camera position
+layout(std140, binding = 0) uniform qt3d_render_view_uniforms {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 uncorrectedProjectionMatrix;
+    mat4 clipCorrectionMatrix;
+    mat4 viewProjectionMatrix;
+    mat4 inverseViewMatrix;
+    mat4 inverseProjectionMatrix;
+    mat4 inverseViewProjectionMatrix;
+    mat4 viewportMatrix;
+    mat4 inverseViewportMatrix;
+    vec4 textureTransformMatrix;
+    vec3 eyePosition;
+};
+
+// Qt 3D's standard light block, filled from the scene's light components
+const int MAX_LIGHTS = 8;
+const int TYPE_POINT = 0;
+const int TYPE_DIRECTIONAL = 1;
+const int TYPE_SPOT = 2;
+struct Light {
+    vec3 position;
+    float intensity;
+    vec3 color;
+    float constantAttenuation;
+    vec3 direction;
+    float linearAttenuation;
+    float quadraticAttenuation;
+    float cutOffAngle;
+    int type;
+};
+layout(std140, binding = 2) uniform qt3d_light_uniforms {
+    Light lights[MAX_LIGHTS];
+    int lightCount;
+    int envLightCount;
+};
+
+// The look LCUScene3D::phongMaterial() gives the parts drawn one by one
+const vec3 specularColor = vec3(1.0);
+const float shininess = 50.0;
+const float ambientFactor = 1.0 / 1.2;
+
+// Qt 3D's Phong model, as QPhongMaterial evaluates it
+void adsModel(vec3 n, vec3 v, out vec3 diffuseLight, out vec3 specularLight)
+{
+    diffuseLight = vec3(0.0);
+    specularLight = vec3(0.0);
+    for (int i = 0; i < lightCount; ++i) {
+        vec3 s;
+        float attenuation = 1.0;
+        if (lights[i].type != TYPE_DIRECTIONAL) {
+            s = lights[i].position - worldPosition;
+            float d = length(s);
+            if (lights[i].constantAttenuation != 0.0 || lights[i].linearAttenuation != 0.0
+                    || lights[i].quadraticAttenuation != 0.0) {
+                attenuation = 1.0 / (lights[i].constantAttenuation + lights[i].linearAttenuation * d
+                                     + lights[i].quadraticAttenuation * d * d);
+            }
+            s = normalize(s);
+            if (lights[i].type == TYPE_SPOT
+                    && degrees(acos(dot(-s, normalize(lights[i].direction)))) > lights[i].cutOffAngle) {
+                attenuation = 0.0;
+            }
+        } else {
+            s = normalize(-lights[i].direction);
+        }
+        
+        float diffuse = max(dot(s, n), 0.0);
+        float specular = 0.0;
+        if (diffuse > 0.0 && attenuation > 0.0) {
+            vec3 r = reflect(-s, n);
+            specular = (shininess + 2.0) / 2.0 * pow(max(dot(r, v), 0.0), shininess);
+        }
+        diffuseLight += attenuation * lights[i].intensity * diffuse * lights[i].color;
+        specularLight += attenuation * lights[i].intensity * specular * lights[i].color;
+    }
+}
+
+void main()
+{
+    vec3 diffuseLight;
+    vec3 specularLight;
+    adsModel(normalize(worldNormal), normalize(eyePosition - worldPosition), diffuseLight, specularLight);
+    fragColor = vec4(color.rgb * (ambientFactor + diffuseLight) + specularColor * specularLight, color.a);
+}
@@ -0,0 +1,38 @@
+#version 450 core
+
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec3 vertexNormal;
+layout(location = 2) in vec4 instanceColumn0;
+layout(location = 3) in vec4 instanceColumn1;
+layout(location = 4) in vec4 instanceColumn2;
+layout(location = 5) in vec4 instanceColumn3;
+layout(location = 6) in vec4 instanceColor;
+
+layout(location = 0) out vec3 worldNormal;
+layout(location = 1) out vec4 color;
+layout(location = 2) out vec3 worldPosition;
+
+// Leading members of Qt 3D's standard uniform blocks
+layout(std140, binding = 0) uniform qt3d_render_view_uniforms {
+    mat4 viewMatrix;
+    mat4 projectionMatrix;
+    mat4 uncorrectedProjectionMatrix;
+    mat4 clipCorrectionMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+layout(std140, binding = 1) uniform qt3d_command_uniforms {
+    mat4 modelMatrix;
+};
+
+void main()
+{
+    mat4 world = modelMatrix * mat4(instanceColumn0, instanceColumn1, instanceColumn2, instanceColumn3);
+    // Parts are only scaled along the axes their faces are normal to, or
+    // evenly around a cylinder's axis, so no inverse-transpose is needed
+    worldNormal = normalize(mat3(world) * vertexNormal);
+    color = instanceColor;
+    vec4 position = world * vec4(vertexPosition, 1.0);
+    worldPosition = position.xyz;
+    gl_Position = viewProjectionMatrix * position;
+}
@@ -1,17 +1,50 @@
 #include "animationcontroller.h"
 #include "lcuscene.h"
 #include "datamodel.h"
+#include "simulationclock.h"
+#include "framestats.h"
+#include <QEvent>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
 
-AnimationController::AnimationController(LCUScene *scene, DataModel *dataModel, QObject *parent)
+namespace {
+    // Frame rate aimed for while animating, rounded to whole refreshes
+    const double kTargetFrameTime = 1000.0 / 30.0;  // ms
+    const double kDefaultRefreshRate = 60.0;        // Hz
+    
+    // Longer gaps (hidden window, stalls) are not worth animating through
+    const double kMaxFrameTime = 0.25;              // s
+}
+
+AnimationController::AnimationController(LCUScene *scene, SimulationClock *clock, QObject *parent)
     : QObject(parent)
     , m_scene(scene)
-    , m_dataModel(dataModel)
+    , m_clock(clock)
     , m_running(false)
     , m_paused(false)
-    , m_lastUpdateTime(0)
+    , m_visible(true)
+    , m_animating(false)
+    , m_mode(Dormant)
+    , m_frameInterval(33)
+    , m_lastFrameTime(0)
 {
     m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
     connect(m_timer, &QTimer::timeout, this, &AnimationController::update);
+    
+    // Model changes while dormant (a step, a pump started, a valve moved)
+    // get a frame, and keep animating if something started moving
+    connect(m_clock->dataModel(), &DataModel::dataChanged, this, [this]() {
+        if (m_mode == Dormant && m_running) {
+            m_animating = true;
+            schedule();
+        }
+    });
+    
+    m_clock->attach(this);
+    updateFrameInterval();
 }
 
 void AnimationController::start()
@@ -19,9 +52,9 @@ void AnimationController::start()
     if (!m_running) {
         m_running = true;
         m_paused = false;
-        m_elapsedTimer.start();
-        m_lastUpdateTime = 0;
-        m_timer->start(33); // ~30 FPS
+        m_animating = true;
+        m_lastFrameTime = m_clock->now();
+        schedule();
     }
 }
 
@@ -30,7 +63,7 @@ void AnimationController::stop()
     if (m_running) {
         m_running = false;
         m_paused = false;
-        m_timer->stop();
+        schedule();
     }
 }
 
@@ -38,6 +71,7 @@ void AnimationController::pause()
 {
     if (m_running && !m_paused) {
         m_paused = true;
+        schedule();
     }
 }
 
@@ -45,28 +79,137 @@ void AnimationController::resume()
 {
     if (m_running && m_paused) {
         m_paused = false;
-        m_lastUpdateTime = m_elapsedTimer.elapsed();
+        m_animating = true;
+        schedule();
     }
 }
 
-void AnimationController::update()
+void AnimationController::setView(QWidget *view)
 {
-    if (!m_running || m_paused) {
+    if (m_view) {
+        m_view->removeEventFilter(this);
+        m_view->window()->removeEventFilter(this);
+    }
+    
+    m_view = view;
+    if (m_view) {
+        m_view->installEventFilter(this);
+        m_view->window()->installEventFilter(this);
+    }
+    updateVisibility();
+}
+
+bool AnimationController::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::Show:
+    case QEvent::Hide:
+    case QEvent::WindowStateChange:
+    case QEvent::Expose:
+        updateVisibility();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void AnimationController::watchWindow()
+{
+    // The native window only exists once the view has been shown
+    QWindow *window = m_view ? m_view->window()->windowHandle() : nullptr;
+    if (window == m_window) {
         return;
     }
     
-    qint64 currentTime = m_elapsedTimer.elapsed();
-    double deltaTime = (currentTime - m_lastUpdateTime) / 1000.0; // Convert to seconds
+    if (m_window) {
+        m_window->removeEventFilter(this);
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = window;
+    if (m_window) {
+        // Expose events report occlusion where the platform tracks it
+        m_window->installEventFilter(this);
+        connect(m_window, &QWindow::screenChanged, this, &AnimationController::updateFrameInterval);
+    }
+    updateFrameInterval();
+}
+
+void AnimationController::updateVisibility()
+{
+    watchWindow();
     
-    if (m_lastUpdateTime == 0) {
-        deltaTime = 0.033; // First frame
+    bool visible = true;
+    if (m_view) {
+        visible = m_view->isVisible() && !m_view->window()->isMinimized()
+                  && (!m_window || m_window->isExposed());
     }
     
-    m_lastUpdateTime = currentTime;
+    if (visible != m_visible) {
+        m_visible = visible;
+        schedule();
+    }
+}
+
+void AnimationController::updateFrameInterval()
+{
+    QScreen *screen = m_window ? m_window->screen() : QGuiApplication::primaryScreen();
+    double refreshRate = screen ? screen->refreshRate() : kDefaultRefreshRate;
+    if (refreshRate < 1.0) {
+        refreshRate = kDefaultRefreshRate;
+    }
+    
+    // A whole number of refresh periods, so frames do not beat against vsync
+    double refreshPeriod = 1000.0 / refreshRate;
+    int refreshes = qMax(1, qRound(kTargetFrameTime / refreshPeriod));
+    int interval = qMax(1, qRound(refreshes * refreshPeriod));
+    
+    if (interval != m_frameInterval) {
+        m_frameInterval = interval;
+        if (m_mode == Animating) {
+            m_timer->start(m_frameInterval);
+        }
+    }
+}
+
+void AnimationController::schedule()
+{
+    // The clock steps the model while any view is shown
+    bool active = m_running && !m_paused && m_visible;
+    m_clock->setViewActive(this, active);
+    
+    Mode mode = (active && m_animating) ? Animating : Dormant;
+    if (mode == m_mode) {
+        return;
+    }
     
-    // Update data model simulation
-    m_dataModel->updateSimulation(deltaTime);
+    // Frames restart from now rather than animating through the gap
+    if (mode == Animating) {
+        m_lastFrameTime = qMax(m_lastFrameTime, m_clock->now() - m_frameInterval);
+        m_timer->start(m_frameInterval);
+    } else {
+        m_timer->stop();
+    }
+    m_mode = mode;
+}
+
+void AnimationController::update()
+{
+    if (!m_running || m_paused) {
+        return;
+    }
+    
+    qint64 currentTime = m_clock->now();
+    double deltaTime = (currentTime - m_lastFrameTime) / 1000.0; // Convert to seconds
+    m_lastFrameTime = currentTime;
     
     // Update scene animations
-    m_scene->updateAnimations(deltaTime);
+    {
+        FrameStats::Scope timing(FrameStats::SceneUpdate);
+        m_scene->updateAnimations(qMin(deltaTime, kMaxFrameTime), m_clock->renderState());
+    }
+    
+    // Values still gliding towards the latest step count as motion
+    m_animating = m_scene->isAnimating() || m_clock->isInterpolating();
+    schedule();
 }
@@ -3,17 +3,29 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QElapsedTimer>
+#include <QPointer>
 
 class LCUScene;
-class DataModel;
+class SimulationClock;
+class QWidget;
+class QWindow;
 
+// Draws 2D scene frames from a SimulationClock, which steps the model.
+// Frames are a whole number of display refreshes apart while components
+// animate; otherwise one frame follows each model change. No timer runs
+// while stopped, paused, or while the view's window is minimized or not
+// exposed, and the view only keeps the clock stepping while it is shown.
 class AnimationController : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit AnimationController(LCUScene *scene, DataModel *dataModel, QObject *parent = nullptr);
+    enum Mode {
+        Dormant,        // no timer running; model changes wake it
+        Animating       // refresh-aligned frames
+    };
+    
+    explicit AnimationController(LCUScene *scene, SimulationClock *clock, QObject *parent = nullptr);
     
     void start();
     void stop();
@@ -22,19 +34,40 @@ public:
     
     bool isRunning() const { return m_running; }
     bool isPaused() const { return m_paused; }
+    Mode mode() const { return m_mode; }
+    
+    // The view whose window visibility and screen refresh rate gate the frames
+    void setView(QWidget *view);
+    
+    // Milliseconds between frames while animating
+    int frameInterval() const { return m_frameInterval; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void update();
+    void updateVisibility();
+    void updateFrameInterval();
 
 private:
+    void schedule();
+    void watchWindow();
+    
     LCUScene *m_scene;
-    DataModel *m_dataModel;
+    SimulationClock *m_clock;
     QTimer *m_timer;
-    QElapsedTimer m_elapsedTimer;
+    
+    QPointer<QWidget> m_view;
+    QPointer<QWindow> m_window;
     
     bool m_running;
     bool m_paused;
-    qint64 m_lastUpdateTime;
+    bool m_visible;
+    bool m_animating;
+    Mode m_mode;
+    int m_frameInterval;
+    qint64 m_lastFrameTime;
 };
 
 #endif // ANIMATIONCONTROLLER_H
@@ -1,48 +1,62 @@
 #include "animationcontroller3d.h"
 #include "lcuscene3d.h"
-#include "datamodel.h"
+#include "simulationclock.h"
+#include "framestats.h"
 
-AnimationController3D::AnimationController3D(LCUScene3D *scene, DataModel *dataModel, QObject *parent)
+namespace {
+    // Longer gaps are not worth animating through
+    const double kMaxFrameTime = 0.25;  // s
+}
+
+AnimationController3D::AnimationController3D(LCUScene3D *scene, SimulationClock *clock, QObject *parent)
     : QObject(parent)
     , m_scene(scene)
-    , m_dataModel(dataModel)
+    , m_clock(clock)
     , m_lastFrameTime(0)
     , m_frameRate(30)
 {
     m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
     connect(m_timer, &QTimer::timeout, this, &AnimationController3D::updateFrame);
     
     // Set initial frame rate
     setFrameRate(m_frameRate);
+    
+    m_clock->attach(this);
 }
 
 void AnimationController3D::start()
 {
-    m_elapsedTimer.start();
-    m_lastFrameTime = 0;
-    m_timer->start();
+    if (!m_timer->isActive()) {
+        // Frame times continue on the shared clock across view switches
+        m_lastFrameTime = m_clock->now();
+        m_timer->start();
+        m_clock->setViewActive(this, true);
+    }
 }
 
 void AnimationController3D::stop()
 {
     m_timer->stop();
+    m_clock->setViewActive(this, false);
 }
 
 void AnimationController3D::setFrameRate(int fps)
 {
-    m_frameRate = fps;
-    int interval = 1000 / fps; // milliseconds per frame
+    m_frameRate = qMax(1, fps);
+    int interval = 1000 / m_frameRate; // milliseconds per frame
     m_timer->setInterval(interval);
 }
 
 void AnimationController3D::updateFrame()
 {
-    qint64 currentTime = m_elapsedTimer.elapsed();
+    qint64 currentTime = m_clock->now();
     double deltaTime = (currentTime - m_lastFrameTime) / 1000.0; // Convert to seconds
     m_lastFrameTime = currentTime;
     
     // Update scene animations
     if (m_scene) {
-        m_scene->updateAnimations(deltaTime);
+        FrameStats::Scope timing(FrameStats::Update3D);
+        m_scene->updateAnimations(qMin(deltaTime, kMaxFrameTime), m_clock->renderState());
     }
 }
@@ -3,30 +3,32 @@
 
 #include <QObject>
 #include <QTimer>
-#include <QElapsedTimer>
 
 class LCUScene3D;
-class DataModel;
+class SimulationClock;
 
+// Draws 3D scene frames at a fixed rate from a SimulationClock, which
+// steps the model; the view keeps the clock stepping while started
 class AnimationController3D : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit AnimationController3D(LCUScene3D *scene, DataModel *dataModel, QObject *parent = nullptr);
+    explicit AnimationController3D(LCUScene3D *scene, SimulationClock *clock, QObject *parent = nullptr);
     
     void start();
     void stop();
     void setFrameRate(int fps);
+    
+    bool isRunning() const { return m_timer->isActive(); }
 
 private slots:
     void updateFrame();
 
 private:
     LCUScene3D *m_scene;
-    DataModel *m_dataModel;
+    SimulationClock *m_clock;
     QTimer *m_timer;
-    QElapsedTimer m_elapsedTimer;
     qint64 m_lastFrameTime;
     int m_frameRate;
 };
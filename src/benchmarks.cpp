@@ -0,0 +1,1002 @@
+#include "benchmarks.h"
+#include "animationcontroller.h"
+#include "controlsystem.h"
+#include "simulationclock.h"
+#include "components/pipe.h"
+#include "components/pipebatch.h"
+#include "components/pump.h"
+#include "components/blower.h"
+#include "components/tank.h"
+#include "components/valve.h"
+#include "components/solenoidvalve.h"
+#include "components/rendercache.h"
+#include "components/rotationatlas.h"
+#include "components/textcache.h"
+#include "datamodel.h"
+#include "fleetmodel.h"
+#include "fleetview.h"
+#include "framestats.h"
+#include "lcuscene.h"
+#include "lcuscene3d.h"
+#include "layoutbuilder.h"
+#include "lcuview.h"
+#include "tilerenderer.h"
+#include "wakeupmonitor.h"
+#include <Qt3DExtras/QForwardRenderer>
+#include <Qt3DRender/QFrameGraphNode>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QPainterPath>
+#include <QScrollBar>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QtMath>
+#include <functional>
+
+namespace {
+    const QSize kFrameSize(1920, 1080);
+    const double kFrameTime = 1.0 / 60.0;
+    
+    struct BenchmarkOptions {
+        int count;
+        int frames;
+    };
+    
+    struct Benchmark {
+        const char *name;
+        const char *description;
+        std::function<void(const BenchmarkOptions&, QTextStream&)> run;
+    };
+    
+    // Milliseconds per frame for drawFrame() over the requested frames
+    double timeFrames(int frames, const std::function<void(int)> &drawFrame)
+    {
+        drawFrame(0);   // warm caches
+        
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 1; frame <= frames; ++frame) {
+            drawFrame(frame);
+        }
+        return timer.nsecsElapsed() / 1e6 / qMax(1, frames);
+    }
+    
+    // Zig-zag runs laid out on a grid, like a large plant diagram
+    QVector<QVector<QPointF>> pipeNetwork(int count)
+    {
+        const double cellWidth = 160.0;
+        const double cellHeight = 90.0;
+        int columns = qMax(1, int(qCeil(qSqrt(count * 1.8))));
+        
+        QVector<QVector<QPointF>> paths;
+        paths.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            QPointF origin((i % columns) * cellWidth, (i / columns) * cellHeight);
+            paths.append({origin + QPointF(10, 10), origin + QPointF(60, 10), origin + QPointF(60, 70),
+                          origin + QPointF(110, 70), origin + QPointF(150, 40)});
+        }
+        return paths;
+    }
+    
+    // The per-paint path, dashed stroke and arrow work Pipe used to do
+    void strokePipe(QPainter *painter, const QVector<QPointF> &points, double offset)
+    {
+        const double width = 6.0;
+        const QColor fluid(100, 150, 200);
+        
+        QPainterPath path;
+        path.moveTo(points[0]);
+        for (int i = 1; i < points.size(); ++i) {
+            path.lineTo(points[i]);
+        }
+        
+        QPen outlinePen(Qt::black, width + 2);
+        outlinePen.setCapStyle(Qt::RoundCap);
+        outlinePen.setJoinStyle(Qt::RoundJoin);
+        painter->setPen(outlinePen);
+        painter->drawPath(path);
+        
+        QPen innerPen(fluid.lighter(150), width);
+        innerPen.setCapStyle(Qt::RoundCap);
+        innerPen.setJoinStyle(Qt::RoundJoin);
+        painter->setPen(innerPen);
+        painter->drawPath(path);
+        
+        QPen flowPen(fluid.darker(120), width * 0.4);
+        flowPen.setCapStyle(Qt::RoundCap);
+        flowPen.setJoinStyle(Qt::RoundJoin);
+        flowPen.setDashPattern({10, 10});
+        flowPen.setDashOffset(offset);
+        painter->setPen(flowPen);
+        painter->drawPath(path);
+        
+        for (int i = 0; i < points.size() - 1; ++i) {
+            QPointF dir = points[i + 1] - points[i];
+            double length = qSqrt(dir.x() * dir.x() + dir.y() * dir.y());
+            if (length > 30) {
+                dir /= length;
+                QPointF perp(-dir.y(), dir.x());
+                QPointF mid = (points[i] + points[i + 1]) / 2.0;
+                
+                QPainterPath arrow;
+                arrow.moveTo(mid + dir * 8);
+                arrow.lineTo(mid + perp * 4);
+                arrow.moveTo(mid + dir * 8);
+                arrow.lineTo(mid - perp * 4);
+                painter->setPen(QPen(fluid.darker(150), 2));
+                painter->drawPath(arrow);
+            }
+        }
+    }
+    
+    void benchmarkPipes(const BenchmarkOptions &options, QTextStream &out)
+    {
+        const QVector<QVector<QPointF>> paths = pipeNetwork(options.count);
+        int segments = 0;
+        for (const QVector<QPointF> &path : paths) {
+            segments += path.size() - 1;
+        }
+        
+        QGraphicsScene scene;
+        QVector<Pipe*> pipes;
+        for (const QVector<QPointF> &path : paths) {
+            Pipe *pipe = new Pipe();
+            pipe->setPath(path);
+            pipe->setFlowing(true);
+            scene.addItem(pipe);
+            pipes.append(pipe);
+        }
+        
+        QImage image(kFrameSize, QImage::Format_ARGB32_Premultiplied);
+        QRectF source = scene.itemsBoundingRect();
+        
+        double cachedMs = timeFrames(options.frames, [&](int) {
+            for (Pipe *pipe : pipes) {
+                pipe->updateAnimation(kFrameTime);
+            }
+            image.fill(Qt::white);
+            QPainter painter(&image);
+            scene.render(&painter, QRectF(QPointF(0, 0), kFrameSize), source);
+        });
+        
+        // Same network and view transform, drawn the old way
+        double strokedMs = timeFrames(options.frames, [&](int frame) {
+            image.fill(Qt::white);
+            QPainter painter(&image);
+            painter.setRenderHint(QPainter::Antialiasing);
+            double scale = qMin(kFrameSize.width() / source.width(), kFrameSize.height() / source.height());
+            painter.translate((kFrameSize.width() - source.width() * scale) / 2,
+                              (kFrameSize.height() - source.height() * scale) / 2);
+            painter.scale(scale, scale);
+            painter.translate(-source.topLeft());
+            for (const QVector<QPointF> &path : paths) {
+                strokePipe(&painter, path, std::fmod(frame * kFrameTime * 50.0, 20.0));
+            }
+        });
+        
+        out << QString("pipes: %1 pipes, %2 flowing segments, %3x%4 frame")
+                   .arg(options.count).arg(segments).arg(kFrameSize.width()).arg(kFrameSize.height()) << Qt::endl;
+        out << QString("  precomputed geometry + dash texture: %1 ms/frame (%2 segments/ms)")
+                   .arg(cachedMs, 0, 'f', 2).arg(segments / qMax(1e-6, cachedMs), 0, 'f', 0) << Qt::endl;
+        out << QString("  per-paint path + dashed stroke:      %1 ms/frame (%2 segments/ms)")
+                   .arg(strokedMs, 0, 'f', 2).arg(segments / qMax(1e-6, strokedMs), 0, 'f', 0) << Qt::endl;
+    }
+    
+    // Scene render time for the same network as separate items and as one batch
+    void benchmarkBatch(const BenchmarkOptions &options, QTextStream &out)
+    {
+        const QVector<QVector<QPointF>> paths = pipeNetwork(options.count);
+        const QColor colors[] = { QColor(100, 150, 200), QColor(200, 150, 100), QColor(150, 200, 150) };
+        
+        QGraphicsScene itemScene;
+        QVector<Pipe*> pipes;
+        QGraphicsScene batchScene;
+        PipeBatch *batch = new PipeBatch();
+        int segments = 0;
+        
+        for (int i = 0; i < paths.size(); ++i) {
+            const QColor &color = colors[i % 3];
+            
+            Pipe *pipe = new Pipe();
+            pipe->setPath(paths[i]);
+            pipe->setFluidColor(color);
+            pipe->setFlowing(true);
+            itemScene.addItem(pipe);
+            pipes.append(pipe);
+            
+            int index = batch->addPipe(paths[i], color);
+            batch->setFlowing(index, true);
+            segments += paths[i].size() - 1;
+        }
+        batchScene.addItem(batch);
+        
+        QImage image(kFrameSize, QImage::Format_ARGB32_Premultiplied);
+        QRectF source = itemScene.itemsBoundingRect();
+        
+        auto measure = [&](QGraphicsScene &scene, const std::function<void()> &animate, quint64 *paints) {
+            quint64 before = BaseComponent::totalPaints();
+            double ms = timeFrames(options.frames, [&](int) {
+                animate();
+                image.fill(Qt::white);
+                QPainter painter(&image);
+                scene.render(&painter, QRectF(QPointF(0, 0), kFrameSize), source);
+            });
+            *paints = (BaseComponent::totalPaints() - before) / (options.frames + 1);
+            return ms;
+        };
+        
+        quint64 itemPaints = 0;
+        quint64 batchPaints = 0;
+        double itemMs = measure(itemScene, [&]() {
+            for (Pipe *pipe : pipes) {
+                pipe->updateAnimation(kFrameTime);
+            }
+        }, &itemPaints);
+        double batchMs = measure(batchScene, [&]() { batch->updateAnimation(kFrameTime); }, &batchPaints);
+        
+        out << QString("batch: %1 pipes, %2 segments, %3 styles")
+                   .arg(options.count).arg(segments).arg(batch->styleCount()) << Qt::endl;
+        out << QString("  one item per pipe: %1 ms/frame, %2 item paints/frame")
+                   .arg(itemMs, 0, 'f', 2).arg(itemPaints) << Qt::endl;
+        out << QString("  batched:           %1 ms/frame, %2 item paints/frame")
+                   .arg(batchMs, 0, 'f', 2).arg(batchPaints) << Qt::endl;
+    }
+    
+    // Running pumps and blowers, rotors drawn directly vs blitted from the atlas
+    void benchmarkRotors(const BenchmarkOptions &options, QTextStream &out)
+    {
+        QGraphicsScene scene;
+        QVector<BaseComponent*> rotors;
+        int columns = qMax(1, int(qCeil(qSqrt(options.count * 1.8))));
+        
+        for (int i = 0; i < options.count; ++i) {
+            BaseComponent *component;
+            if (i % 2 == 0) {
+                Pump *pump = new Pump(i);
+                pump->setRunning(true);
+                component = pump;
+            } else {
+                Blower *blower = new Blower(i);
+                blower->setRunning(true);
+                blower->setSpeed(50.0);
+                component = blower;
+            }
+            component->setPos((i % columns) * 60.0, (i / columns) * 60.0);
+            scene.addItem(component);
+            rotors.append(component);
+        }
+        
+        QImage image(kFrameSize, QImage::Format_ARGB32_Premultiplied);
+        QRectF source = scene.itemsBoundingRect();
+        
+        auto measure = [&]() {
+            return timeFrames(options.frames, [&](int) {
+                for (BaseComponent *rotor : rotors) {
+                    rotor->updateAnimation(kFrameTime);
+                }
+                image.fill(Qt::white);
+                QPainter painter(&image);
+                scene.render(&painter, QRectF(QPointF(0, 0), kFrameSize), source);
+            });
+        };
+        
+        bool wasEnabled = RotationAtlas::isEnabled();
+        RotationAtlas::setEnabled(false);
+        double directMs = measure();
+        RotationAtlas::setEnabled(true);
+        double atlasMs = measure();
+        RotationAtlas::setEnabled(wasEnabled);
+        
+        out << QString("rotors: %1 pumps and blowers").arg(options.count) << Qt::endl;
+        out << QString("  drawn each frame: %1 ms/frame (%2 µs per component)")
+                   .arg(directMs, 0, 'f', 2).arg(directMs * 1000.0 / options.count, 0, 'f', 2) << Qt::endl;
+        out << QString("  rotation atlas:   %1 ms/frame (%2 µs per component), %3 atlases, %4 KiB")
+                   .arg(atlasMs, 0, 'f', 2).arg(atlasMs * 1000.0 / options.count, 0, 'f', 2)
+                   .arg(RotationAtlas::atlasCount()).arg(RotationAtlas::memoryBytes() / 1024) << Qt::endl;
+    }
+    
+    // Full repaints of the stock schematic on a 4K wall display, on the GUI
+    // thread vs tiled on a growing number of workers
+    void benchmarkTiles(const BenchmarkOptions &options, QTextStream &out)
+    {
+        DataModel model;
+        model.setSystemRunning(true);
+        LCUScene scene(&model);
+        
+        LCUView view(&scene);
+        view.resize(3840, 2160);
+        view.setRenderHint(QPainter::Antialiasing);
+        view.setBackgroundBrush(QBrush(QColor(200, 220, 240)));
+        view.show();
+        view.fitInView(scene.sceneRect(), Qt::KeepAspectRatio);
+        
+        // Item paints show the recording walks the scene once per frame
+        double itemsPerFrame = 0;
+        auto measure = [&]() {
+            quint64 paintsBefore = BaseComponent::totalPaints();
+            double ms = timeFrames(options.frames, [&](int) {
+                model.updateSimulation(kFrameTime);
+                scene.updateAnimations(kFrameTime);
+                view.viewport()->repaint();
+            });
+            itemsPerFrame = double(BaseComponent::totalPaints() - paintsBefore) / qMax(1, options.frames);
+            return ms;
+        };
+        
+        out << QString("tiles: stock layout at %1x%2, full repaint per frame")
+                   .arg(view.viewport()->width()).arg(view.viewport()->height()) << Qt::endl;
+        double plainMs = measure();
+        out << QString("  GUI thread:          %1 ms/frame, %2 item paints")
+                   .arg(plainMs, 0, 'f', 2).arg(itemsPerFrame, 0, 'f', 0) << Qt::endl;
+        
+        view.setTiledRendering(true);
+        QVector<int> threadCounts = { 1 };
+        for (int threads = 2; threads < QThread::idealThreadCount(); threads *= 2) {
+            threadCounts.append(threads);
+        }
+        if (QThread::idealThreadCount() > 1) {
+            threadCounts.append(QThread::idealThreadCount());
+        }
+        
+        for (int threads : threadCounts) {
+            view.tileRenderer()->setThreadCount(threads);
+            view.tileRenderer()->resetStatistics();
+            double ms = measure();
+            
+            TileRenderer::Statistics stats = view.tileRenderer()->statistics();
+            double frames = qMax<quint64>(1, stats.frames);
+            out << QString("  tiled, %1 threads: %2 ms/frame, %3x (record %4, raster %5, composite %6 ms), %7 item paints")
+                       .arg(threads, 2).arg(ms, 0, 'f', 2).arg(plainMs / qMax(ms, 1e-6), 0, 'f', 2)
+                       .arg(stats.recordNs / 1e6 / frames, 0, 'f', 2)
+                       .arg(stats.rasterNs / 1e6 / frames, 0, 'f', 2)
+                       .arg(stats.compositeNs / 1e6 / frames, 0, 'f', 2)
+                       .arg(itemsPerFrame, 0, 'f', 0) << Qt::endl;
+        }
+    }
+    
+    // Mean component paint time of the stock schematic shrunk to dashboard
+    // sizes, with and without level-of-detail tiers
+    void benchmarkLevelOfDetail(const BenchmarkOptions &options, QTextStream &out)
+    {
+        DataModel model;
+        model.setSystemRunning(true);
+        LCUScene scene(&model);
+        QRectF source = scene.sceneRect();
+        
+        auto meanPaintUs = [&](qreal zoom) {
+            QImage image((source.size() * zoom).toSize().expandedTo(QSize(1, 1)), QImage::Format_ARGB32_Premultiplied);
+            BaseComponent::resetRenderCosts();
+            timeFrames(options.frames, [&](int) {
+                model.updateSimulation(kFrameTime);
+                scene.updateAnimations(kFrameTime);
+                image.fill(Qt::white);
+                QPainter painter(&image);
+                painter.setRenderHint(QPainter::Antialiasing);
+                scene.render(&painter, QRectF(QPointF(0, 0), image.size()), source);
+            });
+            
+            quint64 paints = 0;
+            qint64 paintNs = 0;
+            const QHash<QString, BaseComponent::RenderCost> costs = BaseComponent::renderCosts();
+            for (const BaseComponent::RenderCost &cost : costs) {
+                paints += cost.paints;
+                paintNs += cost.paintNs;
+            }
+            return paints > 0 ? paintNs / 1000.0 / paints : 0.0;
+        };
+        
+        out << "lod: stock layout, mean paint time per component" << Qt::endl;
+        bool wasEnabled = BaseComponent::isLevelOfDetailEnabled();
+        for (qreal zoom : { 1.0, 0.5, 0.25, 0.125 }) {
+            BaseComponent::setLevelOfDetailEnabled(false);
+            double fullUs = meanPaintUs(zoom);
+            BaseComponent::setLevelOfDetailEnabled(true);
+            double tieredUs = meanPaintUs(zoom);
+            
+            out << QString("  zoom %1: %2 µs full detail, %3 µs with LOD (%4)")
+                       .arg(zoom, 5, 'f', 3).arg(fullUs, 0, 'f', 2).arg(tieredUs, 0, 'f', 2)
+                       .arg(QStringList({ "symbols", "reduced", "full" })
+                                [BaseComponent::detailLevelFor(zoom)]) << Qt::endl;
+        }
+        BaseComponent::setLevelOfDetailEnabled(wasEnabled);
+    }
+    
+    // Changing numeric readouts, shaped by drawText each frame vs composed
+    // from cached glyphs
+    void benchmarkText(const BenchmarkOptions &options, QTextStream &out)
+    {
+        QImage image(kFrameSize, QImage::Format_ARGB32_Premultiplied);
+        const QFont font("Arial", 7);
+        const QString suffix = QStringLiteral(" °C");
+        int columns = qMax(1, kFrameSize.width() / 80);
+        
+        auto measure = [&](bool cached) {
+            return timeFrames(options.frames, [&](int frame) {
+                image.fill(Qt::white);
+                QPainter painter(&image);
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setFont(font);
+                for (int i = 0; i < options.count; ++i) {
+                    QPointF position((i % columns) * 80.0, (i / columns) * 14.0);
+                    double value = 20.0 + std::fmod(i * 0.37 + frame * 0.1, 15.0);
+                    if (cached) {
+                        TextCache::drawNumber(&painter, position, value, 1, suffix, font);
+                    } else {
+                        painter.drawText(QRectF(position, QSizeF(80, 14)), Qt::AlignLeft | Qt::AlignTop,
+                                         QString::number(value, 'f', 1) + suffix);
+                    }
+                }
+            });
+        };
+        
+        double drawTextMs = measure(false);
+        double cachedMs = measure(true);
+        out << QString("text: %1 changing readouts per frame").arg(options.count) << Qt::endl;
+        out << QString("  drawText:       %1 ms/frame").arg(drawTextMs, 0, 'f', 2) << Qt::endl;
+        out << QString("  cached glyphs:  %1 ms/frame, %2 cache entries")
+                   .arg(cachedMs, 0, 'f', 2).arg(TextCache::entryCount()) << Qt::endl;
+    }
+    
+    // Offsets [x, y] points, [x, y, w, h] rects and [x, y, z] points
+    QJsonArray shifted(const QJsonArray &point, double dx, double dy, double dz = 0.0)
+    {
+        QJsonArray result = point;
+        result[0] = point.at(0).toDouble() + dx;
+        if (point.size() == 3) {
+            result[2] = point.at(2).toDouble() + dz;
+        } else {
+            result[1] = point.at(1).toDouble() + dy;
+        }
+        return result;
+    }
+    
+    QJsonArray shiftedPath(const QJsonArray &path, double dx, double dy, double dz = 0.0)
+    {
+        QJsonArray result;
+        for (const QJsonValue &point : path) {
+            result.append(shifted(point.toArray(), dx, dy, dz));
+        }
+        return result;
+    }
+    
+    // The stock unit repeated on a grid until the plant holds at least
+    // count components (labels and panels not counted)
+    QByteArray plantLayoutJson(int count, int *components)
+    {
+        // 3D footprint of one unit, the size of its floor
+        const double unitWidth = 60.0;
+        const double unitDepth = 40.0;
+        
+        QFile file(LayoutBuilder::stockLayoutFile());
+        file.open(QIODevice::ReadOnly);
+        const QJsonObject unit = QJsonDocument::fromJson(file.readAll()).object();
+        const QJsonArray unitItems = unit.value("items").toArray();
+        const QJsonArray unitRect = unit.value("scene_rect").toArray();
+        double width = unitRect.at(2).toDouble();
+        double height = unitRect.at(3).toDouble();
+        
+        int perUnit = 0;
+        for (const QJsonValue &value : unitItems) {
+            QString type = value.toObject().value("type").toString();
+            if (type != "label" && type != "panel") {
+                perUnit++;
+            }
+        }
+        int units = qMax(1, (count + perUnit - 1) / qMax(1, perUnit));
+        int columns = qMax(1, int(qCeil(qSqrt(units))));
+        int rows = (units + columns - 1) / columns;
+        *components = units * perUnit;
+        
+        QJsonArray items;
+        for (int u = 0; u < units; ++u) {
+            double dx = (u % columns) * width;
+            double dy = (u / columns) * height;
+            double dx3D = (u % columns) * unitWidth;
+            double dz3D = (u / columns) * unitDepth;
+            for (const QJsonValue &value : unitItems) {
+                QJsonObject item = value.toObject();
+                if (item.contains("pos")) {
+                    item["pos"] = shifted(item.value("pos").toArray(), dx, dy);
+                }
+                if (item.contains("rect")) {
+                    item["rect"] = shifted(item.value("rect").toArray(), dx, dy);
+                }
+                if (item.contains("path")) {
+                    item["path"] = shiftedPath(item.value("path").toArray(), dx, dy);
+                }
+                if (item.contains("pos3d")) {
+                    item["pos3d"] = shifted(item.value("pos3d").toArray(), dx3D, 0.0, dz3D);
+                }
+                if (item.contains("path3d")) {
+                    item["path3d"] = shiftedPath(item.value("path3d").toArray(), dx3D, 0.0, dz3D);
+                }
+                items.append(item);
+            }
+        }
+        
+        QJsonObject plant;
+        plant["name"] = QString("%1 unit plant").arg(units);
+        plant["scene_rect"] = QJsonArray({ unitRect.at(0), unitRect.at(1), columns * width, rows * height });
+        plant["items"] = items;
+        return QJsonDocument(plant).toJson(QJsonDocument::Compact);
+    }
+    
+    // Parse and build time of a large plant layout in both scenes
+    void benchmarkLayout(const BenchmarkOptions &options, QTextStream &out)
+    {
+        int components = 0;
+        const QByteArray json = plantLayoutJson(options.count, &components);
+        DataModel model;
+        
+        // Warm up fonts, resources and allocators on the stock unit
+        {
+            LCUScene scene(&model);
+            LCUScene3D scene3D(&model);
+        }
+        
+        QElapsedTimer timer;
+        timer.start();
+        PlantLayout layout;
+        LayoutBuilder::parse(json, &layout);
+        double parseMs = timer.nsecsElapsed() / 1e6;
+        
+        timer.restart();
+        LCUScene scene(&model, layout);
+        double buildMs = timer.nsecsElapsed() / 1e6;
+        
+        // The BSP tree itself is built on the first lookup
+        timer.restart();
+        scene.items(QRectF(scene.sceneRect().center(), QSizeF(1, 1)));
+        double indexMs = timer.nsecsElapsed() / 1e6;
+        
+        timer.restart();
+        LCUScene3D scene3D(&model, layout);
+        double build3DMs = timer.nsecsElapsed() / 1e6;
+        
+        out << QString("layout: %1 components, %2 layout items, %3 KB of JSON")
+                   .arg(components).arg(layout.items.size()).arg(json.size() / 1024) << Qt::endl;
+        out << QString("  parse:        %1 ms").arg(parseMs, 0, 'f', 1) << Qt::endl;
+        out << QString("  2D build:     %1 ms (%2 items), first index lookup %3 ms")
+                   .arg(buildMs, 0, 'f', 1).arg(scene.items().size()).arg(indexMs, 0, 'f', 1) << Qt::endl;
+        out << QString("  3D build:     %1 ms").arg(build3DMs, 0, 'f', 1) << Qt::endl;
+        out << QString("  total:        %1 ms").arg(parseMs + buildMs + indexMs + build3DMs, 0, 'f', 1) << Qt::endl;
+    }
+    
+    // Fleet overview frames while scrolling through the middle of the fleet
+    void benchmarkFleet(const BenchmarkOptions &options, QTextStream &out)
+    {
+        DataModel model;
+        model.setSystemRunning(true);
+        SimulationClock clock(&model);
+        
+        out << QString("fleet: %1x%2 view, %3 frames per fleet size")
+                   .arg(kFrameSize.width()).arg(kFrameSize.height()).arg(options.frames) << Qt::endl;
+        for (int units : { 10, 100, 1000, 10000 }) {
+            FleetModel fleet(&model);
+            fleet.setUnitCount(units);
+            FleetView view(&fleet, &clock);
+            view.resize(kFrameSize);
+            view.show();
+            QCoreApplication::processEvents();
+            
+            // One tile row per frame, so renderers are recycled every frame
+            QScrollBar *scrollBar = view.verticalScrollBar();
+            int middle = scrollBar->maximum() / 2;
+            double ms = timeFrames(options.frames, [&](int frame) {
+                scrollBar->setValue(qMin(scrollBar->maximum(), middle + frame * scrollBar->singleStep()));
+                view.advance(kFrameTime);
+                view.viewport()->repaint();
+            });
+            
+            FleetView::Statistics stats = view.statistics();
+            out << QString("  %1 units: %2 ms/frame, %3 live tiles, %4 renderers, %5 summary pixmaps")
+                       .arg(units, 5)
+                       .arg(ms, 0, 'f', 2)
+                       .arg(stats.liveTiles)
+                       .arg(stats.renderers)
+                       .arg(stats.summaryPixmaps) << Qt::endl;
+        }
+    }
+    
+    // GUI and control thread wakeups and model steps per second of the
+    // animation drivers, the simulation clock and the controller, by state
+    void benchmarkWakeups(const BenchmarkOptions &options, QTextStream &out)
+    {
+        Q_UNUSED(options);
+        const int window = 2000;    // ms per state
+        
+        DataModel model;
+        LCUScene scene(&model);
+        LCUView view(&scene);
+        view.resize(1400, 900);
+        view.show();
+        SimulationClock clock(&model);
+        AnimationController controller(&scene, &clock);
+        controller.setView(&view);
+        
+        // The supervisory controller, running as with the system started
+        ControlSystem control(model.controlInterface());
+        clock.setControlSystem(&control);
+        control.startControl();
+        
+        // A second view of the same model, as on a two-monitor console
+        LCUScene secondScene(&model);
+        LCUView secondView(&secondScene);
+        secondView.resize(1400, 900);
+        AnimationController secondController(&secondScene, &clock);
+        secondController.setView(&secondView);
+        
+        const char *const modes[] = { "dormant", "animating" };
+        auto measure = [&](const QString &state) {
+            QEventLoop loop;
+            QTimer::singleShot(window, &loop, &QEventLoop::quit);
+            WakeupMonitor::reset();
+            quint64 steps = clock.stepCount();
+            loop.exec();
+            
+            WakeupMonitor::Statistics stats = WakeupMonitor::statistics();
+            out << QString("  %1 %2 wakeups/s, %3 model steps/s (%4, %5 ms frames)")
+                       .arg(state, -12)
+                       .arg(stats.perSecond(), 6, 'f', 1)
+                       .arg((clock.stepCount() - steps) / qMax(0.001, stats.seconds), 0, 'f', 1)
+                       .arg(modes[controller.mode()])
+                       .arg(controller.frameInterval()) << Qt::endl;
+        };
+        
+        out << QString("wakeups: GUI and control threads, %1 s per state").arg(window / 1000.0) << Qt::endl;
+        WakeupMonitor::setEnabled(true);
+        controller.start();
+        measure("stopped:");
+        
+        model.setSystemRunning(true);
+        measure("running:");
+        
+        secondView.show();
+        secondController.start();
+        measure("two views:");
+        secondController.stop();
+        secondView.hide();
+        
+        view.hide();
+        measure("hidden:");
+        
+        view.show();
+        model.setSystemRunning(false);
+        measure("stopped:");
+        WakeupMonitor::setEnabled(false);
+        clock.setControlSystem(nullptr);
+    }
+    
+    // Tanks, valves and solenoid valves of many units, each frame showing a
+    // different mix of the few looks they have, as in fleet tiles
+    void benchmarkRenderCache(const BenchmarkOptions &options, QTextStream &out)
+    {
+        QGraphicsScene scene;
+        QVector<Tank*> tanks;
+        QVector<Valve*> valves;
+        QVector<SolenoidValve*> solenoids;
+        int columns = qMax(1, int(qCeil(qSqrt(options.count * 1.8))));
+        
+        for (int i = 0; i < options.count; ++i) {
+            BaseComponent *component;
+            if (i % 3 == 0) {
+                tanks.append(new Tank);
+                component = tanks.last();
+            } else if (i % 3 == 1) {
+                valves.append(new Valve(i));
+                component = valves.last();
+            } else {
+                solenoids.append(new SolenoidValve(i % 4 + 1));
+                component = solenoids.last();
+            }
+            component->setPos((i % columns) * 90.0, (i / columns) * 130.0);
+            scene.addItem(component);
+        }
+        
+        QImage image(kFrameSize, QImage::Format_ARGB32_Premultiplied);
+        QRectF source = scene.itemsBoundingRect();
+        
+        auto rebuilds = []() {
+            quint64 total = 0;
+            const QHash<QString, BaseComponent::RenderCost> costs = BaseComponent::renderCosts();
+            for (const BaseComponent::RenderCost &cost : costs) {
+                total += cost.staticRebuilds;
+            }
+            return total;
+        };
+        
+        auto measure = [&]() {
+            RenderCache::clear();
+            BaseComponent::resetRenderCosts();
+            return timeFrames(options.frames, [&](int frame) {
+                for (int i = 0; i < tanks.size(); ++i) {
+                    tanks[i]->setLevel((i * 7 + frame) % 101);
+                    tanks[i]->setTemperature(15.0 + (i + frame / 10) % 3 * 10.0);
+                }
+                for (int i = 0; i < valves.size(); ++i) {
+                    valves[i]->setOpen((i + frame / 15) % 2 == 0);
+                    valves[i]->updateAnimation(kFrameTime);
+                }
+                for (int i = 0; i < solenoids.size(); ++i) {
+                    solenoids[i]->setOpen((i + frame / 20) % 2 == 0);
+                    solenoids[i]->setEnergized((i + frame / 20) % 3 != 0);
+                    solenoids[i]->updateAnimation(kFrameTime);
+                }
+                image.fill(Qt::white);
+                QPainter painter(&image);
+                scene.render(&painter, QRectF(QPointF(0, 0), kFrameSize), source);
+            });
+        };
+        
+        bool wasEnabled = RenderCache::isEnabled();
+        RenderCache::setEnabled(false);
+        double unsharedMs = measure();
+        quint64 unsharedRebuilds = rebuilds();
+        RenderCache::setEnabled(true);
+        double sharedMs = measure();
+        quint64 sharedRebuilds = rebuilds();
+        RenderCache::Statistics stats = RenderCache::statistics();
+        RenderCache::setEnabled(wasEnabled);
+        
+        out << QString("rendercache: %1 tanks, valves and solenoid valves, %2 frames")
+                   .arg(options.count).arg(options.frames) << Qt::endl;
+        out << QString("  per component: %1 ms/frame, %2 layer rebuilds")
+                   .arg(unsharedMs, 0, 'f', 2).arg(unsharedRebuilds) << Qt::endl;
+        out << QString("  shared cache:  %1 ms/frame, %2 layer rebuilds, %3% hit rate, %4 entries, %5 KiB")
+                   .arg(sharedMs, 0, 'f', 2).arg(sharedRebuilds)
+                   .arg(stats.hitRate() * 100.0, 0, 'f', 1)
+                   .arg(stats.entries).arg(stats.bytes / 1024) << Qt::endl;
+    }
+    
+    // Render views a frame graph produces: one per leaf
+    int frameGraphLeaves(Qt3DRender::QFrameGraphNode *node)
+    {
+        int leaves = 0;
+        for (Qt3DCore::QNode *child : node->childNodes()) {
+            if (Qt3DRender::QFrameGraphNode *frameGraphChild = qobject_cast<Qt3DRender::QFrameGraphNode*>(child)) {
+                leaves += frameGraphLeaves(frameGraphChild);
+            }
+        }
+        return qMax(1, leaves);
+    }
+    
+    // Draw calls per frame of the 3D scene through the 3D window's default
+    // frame graph, with repeated parts as entities vs instanced
+    void benchmarkInstancing(const BenchmarkOptions &options, QTextStream &out)
+    {
+        int components = 0;
+        PlantLayout plant;
+        LayoutBuilder::parse(plantLayoutJson(options.count, &components), &plant);
+        DataModel model;
+        model.setSystemRunning(true);
+        
+        Qt3DExtras::QForwardRenderer frameGraph;
+        int renderViews = frameGraphLeaves(&frameGraph);
+        
+        out << QString("instancing: stock unit and a plant of %1 components, %2 render view(s) per frame")
+                   .arg(components).arg(renderViews) << Qt::endl;
+        const PlantLayout *layouts[] = { &LayoutBuilder::stockLayout(), &plant };
+        bool wasInstancing = LCUScene3D::isInstancing();
+        for (bool instancing : { false, true }) {
+            LCUScene3D::setInstancing(instancing);
+            for (const PlantLayout *layout : layouts) {
+                LCUScene3D scene3D(&model, *layout);
+                double updateMs = timeFrames(options.frames, [&](int) {
+                    scene3D.updateAnimations(kFrameTime);
+                });
+                
+                LCUScene3D::Statistics stats = scene3D.statistics();
+                out << QString("  %1 %2 %3 entities, %4 draw calls/frame for %5 parts, update %6 ms/frame")
+                           .arg(instancing ? "instanced:" : "entities: ")
+                           .arg(layout == &plant ? "plant:" : "stock:")
+                           .arg(stats.entities, 6)
+                           .arg(stats.drawCalls * renderViews, 6)
+                           .arg(stats.instances)
+                           .arg(updateMs, 0, 'f', 3) << Qt::endl;
+            }
+        }
+        LCUScene3D::setInstancing(wasInstancing);
+    }
+    
+    // Build time, node counts and geometry memory of the 3D scene with a
+    // mesh and material per part vs shared by parameters and colour
+    void benchmarkMeshes(const BenchmarkOptions &options, QTextStream &out)
+    {
+        int components = 0;
+        PlantLayout plant;
+        LayoutBuilder::parse(plantLayoutJson(options.count, &components), &plant);
+        DataModel model;
+        
+        // Warm up allocators on the stock unit
+        {
+            LCUScene3D scene3D(&model);
+        }
+        
+        out << QString("meshes: stock unit and a plant of %1 components").arg(components) << Qt::endl;
+        const PlantLayout *layouts[] = { &LayoutBuilder::stockLayout(), &plant };
+        bool wasSharing = LCUScene3D::isResourceSharing();
+        for (bool sharing : { false, true }) {
+            LCUScene3D::setResourceSharing(sharing);
+            for (const PlantLayout *layout : layouts) {
+                QElapsedTimer timer;
+                timer.start();
+                LCUScene3D scene3D(&model, *layout);
+                double buildMs = timer.nsecsElapsed() / 1e6;
+                
+                LCUScene3D::Statistics stats = scene3D.statistics();
+                out << QString("  %1 %2 %3 ms, %4 entities, %5 meshes, %6 materials, %7 KiB of geometry")
+                           .arg(sharing ? "shared:  " : "per part:")
+                           .arg(layout == &plant ? "plant:" : "stock:")
+                           .arg(buildMs, 7, 'f', 1)
+                           .arg(stats.entities)
+                           .arg(stats.meshes)
+                           .arg(stats.materials)
+                           .arg(stats.geometryBytes / 1024) << Qt::endl;
+            }
+        }
+        LCUScene3D::setResourceSharing(wasSharing);
+    }
+    
+    // Material writes and notified property changes per frame of the 3D
+    // scene, parts recoloured every frame vs shared looks swapped on change
+    void benchmarkMaterials(const BenchmarkOptions &options, QTextStream &out)
+    {
+        int components = 0;
+        PlantLayout plant;
+        LayoutBuilder::parse(plantLayoutJson(options.count, &components), &plant);
+        DataModel model;
+        model.setSystemRunning(true);
+        
+        // The system and every compressor switch every 30 frames
+        RenderSnapshot running = RenderSnapshot::capture(&model);
+        RenderSnapshot stopped = running;
+        stopped.systemRunning = false;
+        for (int loop = 0; loop < RenderSnapshot::LoopCount; ++loop) {
+            running.compressorStates[loop] = true;
+            stopped.compressorStates[loop] = false;
+        }
+        
+        out << QString("materials: plant of %1 components, %2 frames, states switching every 30 frames")
+                   .arg(components).arg(options.frames) << Qt::endl;
+        bool wasSharing = LCUScene3D::isResourceSharing();
+        for (bool sharing : { false, true }) {
+            LCUScene3D::setResourceSharing(sharing);
+            LCUScene3D scene3D(&model, plant);
+            scene3D.setPropertyChangeCounting(true);
+            
+            FrameStats::reset();
+            double updateMs = timeFrames(options.frames, [&](int frame) {
+                scene3D.updateAnimations(kFrameTime, (frame / 30) % 2 == 0 ? running : stopped);
+            });
+            scene3D.setPropertyChangeCounting(false);
+            
+            double frames = options.frames + 1;     // with the warm-up frame
+            out << QString("  %1 %2 material updates/frame, %3 property changes/frame, %4 materials, update %5 ms/frame")
+                       .arg(sharing ? "shared looks:" : "recoloured:  ")
+                       .arg(FrameStats::counter(FrameStats::MaterialUpdates3D) / frames, 8, 'f', 2)
+                       .arg(FrameStats::counter(FrameStats::PropertyChanges3D) / frames, 8, 'f', 2)
+                       .arg(scene3D.statistics().materials)
+                       .arg(updateMs, 0, 'f', 3) << Qt::endl;
+        }
+        LCUScene3D::setResourceSharing(wasSharing);
+        FrameStats::reset();
+    }
+    
+    // Repainted area per frame of the stock LCU schematic, per viewport update mode
+    void benchmarkRepaintArea(const BenchmarkOptions &options, QTextStream &out)
+    {
+        DataModel model;
+        model.setSystemRunning(true);
+        LCUScene scene(&model);
+        
+        const QVector<QPair<QString, QGraphicsView::ViewportUpdateMode>> modes = {
+            { "bounding rect", QGraphicsView::BoundingRectViewportUpdate },
+            { "minimal", QGraphicsView::MinimalViewportUpdate },
+        };
+        
+        out << QString("repaint: stock layout, %1 frames per mode").arg(options.frames) << Qt::endl;
+        for (const auto &mode : modes) {
+            LCUView view(&scene);
+            view.resize(1400, 900);
+            view.setRenderHint(QPainter::Antialiasing);
+            view.setViewportUpdateMode(mode.second);
+            view.show();
+            
+            auto frame = [&]() {
+                model.updateSimulation(kFrameTime);
+                scene.updateAnimations(kFrameTime);
+                QCoreApplication::processEvents();
+                QCoreApplication::sendPostedEvents();
+            };
+            
+            // Skip the initial full exposure
+            for (int i = 0; i < 10; ++i) {
+                frame();
+            }
+            view.resetRepaintStats();
+            for (int i = 0; i < options.frames; ++i) {
+                frame();
+            }
+            
+            LCUView::RepaintStats stats = view.repaintStats();
+            double frames = qMax<quint64>(1, stats.frames);
+            double coverage = stats.viewPixels > 0 ? 100.0 * stats.pixels / stats.viewPixels : 0.0;
+            out << QString("  %1: %2 k pixels/frame (%3% of view), %4 items/frame")
+                       .arg(mode.first, -14)
+                       .arg(stats.pixels / frames / 1000.0, 0, 'f', 1)
+                       .arg(coverage, 0, 'f', 1)
+                       .arg(stats.items / frames, 0, 'f', 1) << Qt::endl;
+        }
+    }
+    
+    const QVector<Benchmark> &benchmarks()
+    {
+        static const QVector<Benchmark> list = {
+            { "pipes", "Flowing pipe network, cached vs stroked pipe painting", benchmarkPipes },
+            { "batch", "Pipe network as separate items vs one PipeBatch", benchmarkBatch },
+            { "rotors", "Pump and blower rotors drawn directly vs from the rotation atlas", benchmarkRotors },
+            { "tiles", "Full 4K repaints on the GUI thread vs tiled on worker threads", benchmarkTiles },
+            { "lod", "Component paint time at dashboard zooms, with and without LOD tiers", benchmarkLevelOfDetail },
+            { "text", "Changing numeric readouts via drawText vs the glyph cache", benchmarkText },
+            { "layout", "Parse and build time of a large plant layout in the 2D and 3D scenes", benchmarkLayout },
+            { "fleet", "Fleet overview frame time from 10 to 10,000 units", benchmarkFleet },
+            { "wakeups", "GUI thread wakeups and model steps per second while stopped, running and hidden", benchmarkWakeups },
+            { "rendercache", "Tank, valve and solenoid layers rebuilt per component vs shared by state", benchmarkRenderCache },
+            { "meshes", "3D scene build time, node counts and geometry memory, per part vs shared", benchmarkMeshes },
+            { "instancing", "3D draw calls per frame with repeated parts as entities vs instanced", benchmarkInstancing },
+            { "materials", "3D material updates per frame, recoloured every frame vs swapped on state change", benchmarkMaterials },
+            { "repaint", "Repainted area per frame of the stock layout, by viewport update mode", benchmarkRepaintArea },
+        };
+        return list;
+    }
+}
+
+int runBenchmarks(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Liquid Cooling Unit Simulator - rendering benchmarks");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("benchmark", "Benchmark to run, or \"all\".", "name", "all"));
+    parser.addOption(QCommandLineOption("count", "Number of items to render.", "count", "2000"));
+    parser.addOption(QCommandLineOption("frames", "Frames to time per measurement.", "frames", "60"));
+    parser.addOption(QCommandLineOption("list", "List the benchmarks and exit."));
+    parser.process(arguments);
+    
+    if (parser.isSet("list")) {
+        for (const Benchmark &benchmark : benchmarks()) {
+            out << benchmark.name << "  " << benchmark.description << Qt::endl;
+        }
+        return 0;
+    }
+    
+    BenchmarkOptions options;
+    options.count = qMax(1, parser.value("count").toInt());
+    options.frames = qMax(1, parser.value("frames").toInt());
+    
+    const QString name = parser.value("benchmark");
+    bool found = false;
+    for (const Benchmark &benchmark : benchmarks()) {
+        if (name == "all" || name.compare(benchmark.name, Qt::CaseInsensitive) == 0) {
+            benchmark.run(options, out);
+            found = true;
+        }
+    }
+    if (!found) {
+        err << "Unknown benchmark: " << name << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
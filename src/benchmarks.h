@@ -0,0 +1,11 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <QStringList>
+
+// Offscreen rendering benchmarks (--benchmark <name|all>). Needs a
+// QGuiApplication; use -platform offscreen on machines without a display.
+// Returns the process exit code.
+int runBenchmarks(const QStringList &arguments);
+
+#endif // BENCHMARKS_H
@@ -1,24 +1,52 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include "basecomponent.h"
+#include "rendercache.h"
+#include <QStyleOptionGraphicsItem>
+#include <QPaintDevice>
+#include <QElapsedTimer>
+#include <QtMath>
+
+namespace {
+    // Cached layers are rebuilt when the zoom crosses a quarter step
+    const qreal kScaleQuantum = 0.25;
+    const qreal kMaxCacheScale = 8.0;
+    
+    // Device-independent pixels per unit below which detail is dropped
+    const qreal kSymbolDetailBelow = 0.35;
+    const qreal kReducedDetailBelow = 0.7;
+}
+
+QHash<const QMetaObject *, BaseComponent::RenderCost> BaseComponent::s_renderCosts;
+quint64 BaseComponent::s_totalPaints = 0;
+bool BaseComponent::s_levelOfDetailEnabled = true;
 
 BaseComponent::BaseComponent(QObject *parent)
     : QObject(parent)
     , m_boundingRect(0, 0, 50, 50)
     , m_isActive(false)
     , m_animationPhase(0.0)
+    , m_staticLayers(0)
+    , m_statusLedBatched(false)
+    , m_detailLevel(FullDetail)
 {
     setFlag(QGraphicsItem::ItemIsSelectable, false);
+    
+    for (LayerCache &cache : m_layerCache) {
+        cache.scale = 0.0;
+        cache.state = 0;
+        cache.detail = FullDetail;
+    }
 }
 
 void BaseComponent::updateAnimation(double deltaTime)
 {
+    // Subclasses schedule their own repaints when the drawn state changes
     if (m_isActive) {
         m_animationPhase += deltaTime * 2.0; // Animation speed
         if (m_animationPhase > 2.0 * M_PI) {
             m_animationPhase -= 2.0 * M_PI;
         }
-        update();
     }
 }
 
@@ -27,6 +55,73 @@ void BaseComponent::updateState()
     update();
 }
 
+bool BaseComponent::statusLed(StatusLed *led) const
+{
+    Q_UNUSED(led);
+    return false;
+}
+
+void BaseComponent::setStatusLedBatched(bool batched)
+{
+    if (m_statusLedBatched != batched) {
+        m_statusLedBatched = batched;
+        invalidateStaticLayers();
+    }
+}
+
+void BaseComponent::drawStatusLed(QPainter *painter) const
+{
+    StatusLed led;
+    if (!m_statusLedBatched && statusLed(&led)) {
+        painter->setBrush(QBrush(led.color));
+        painter->setPen(QPen(Qt::black, 1));
+        painter->drawEllipse(led.center, led.radius, led.radius);
+    }
+}
+
+qreal BaseComponent::cacheScale(const QPainter *painter)
+{
+    // Device pixels per item unit, quantized so small zoom changes reuse caches
+    qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    if (painter->device()) {
+        scale *= painter->device()->devicePixelRatioF();
+    }
+    return qBound(kScaleQuantum, std::ceil(scale / kScaleQuantum) * kScaleQuantum, kMaxCacheScale);
+}
+
+QHash<QString, BaseComponent::RenderCost> BaseComponent::renderCosts()
+{
+    QHash<QString, RenderCost> costs;
+    for (auto it = s_renderCosts.constBegin(); it != s_renderCosts.constEnd(); ++it) {
+        costs.insert(QString::fromLatin1(it.key()->className()), it.value());
+    }
+    return costs;
+}
+
+BaseComponent::DetailLevel BaseComponent::detailLevelFor(qreal levelOfDetail)
+{
+    if (levelOfDetail < kSymbolDetailBelow) {
+        return SymbolDetail;
+    } else if (levelOfDetail < kReducedDetailBelow) {
+        return ReducedDetail;
+    }
+    return FullDetail;
+}
+
+void BaseComponent::paintSymbol(QPainter *painter)
+{
+    // Too small for outlines to show or antialiasing to matter
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    qreal inset = qMin(m_boundingRect.width(), m_boundingRect.height()) * 0.1;
+    painter->fillRect(m_boundingRect.adjusted(inset, inset, -inset, -inset), symbolColor());
+}
+
+QColor BaseComponent::symbolColor() const
+{
+    StatusLed led;
+    return statusLed(&led) ? led.color : QColor(150, 150, 150);
+}
+
 QRectF BaseComponent::boundingRect() const
 {
     return m_boundingRect;
@@ -37,6 +132,94 @@ void BaseComponent::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     Q_UNUSED(option);
     Q_UNUSED(widget);
     
+    QElapsedTimer timer;
+    timer.start();
+    
+    RenderCost &cost = s_renderCosts[metaObject()];
+    
+    m_detailLevel = FullDetail;
+    if (s_levelOfDetailEnabled) {
+        m_detailLevel = detailLevelFor(QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()));
+    }
+    
     painter->setRenderHint(QPainter::Antialiasing);
-    paintComponent(painter);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    
+    if (m_detailLevel == SymbolDetail) {
+        paintSymbol(painter);
+    } else if (m_staticLayers) {
+        qreal scale = cacheScale(painter);
+        drawStaticLayer(painter, BackgroundLayer, scale, cost);
+        paintComponent(painter);
+        drawStaticLayer(painter, ForegroundLayer, scale, cost);
+    } else {
+        paintComponent(painter);
+    }
+    
+    cost.paints++;
+    s_totalPaints++;
+    cost.paintNs += timer.nsecsElapsed();
+}
+
+void BaseComponent::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    Q_UNUSED(painter);
+    Q_UNUSED(layer);
+}
+
+int BaseComponent::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return 0;
+}
+
+void BaseComponent::invalidateStaticLayers()
+{
+    for (LayerCache &cache : m_layerCache) {
+        cache.pixmap = QPixmap();
+    }
+    update();
+}
+
+void BaseComponent::drawStaticLayer(QPainter *painter, StaticLayer layer, qreal scale, RenderCost &cost)
+{
+    if (!(m_staticLayers & layer)) {
+        return;
+    }
+    
+    LayerCache &cache = m_layerCache[layer == BackgroundLayer ? 0 : 1];
+    int state = staticLayerState(layer);
+    
+    if (cache.pixmap.isNull() || cache.scale != scale || cache.state != state || cache.detail != m_detailLevel) {
+        // A batched LED is not part of the artwork
+        RenderCache::Key key{ metaObject(), staticLayerVariant(), layer | (m_statusLedBatched ? 0x100 : 0),
+                              state, m_detailLevel, scale };
+        
+        if (!RenderCache::find(key, &cache.pixmap)) {
+            QElapsedTimer timer;
+            timer.start();
+            
+            QSize size(qCeil(m_boundingRect.width() * scale), qCeil(m_boundingRect.height() * scale));
+            cache.pixmap = QPixmap(size);
+            cache.pixmap.setDevicePixelRatio(scale);
+            cache.pixmap.fill(Qt::transparent);
+            
+            QPainter layerPainter(&cache.pixmap);
+            layerPainter.setRenderHint(QPainter::Antialiasing);
+            layerPainter.translate(-m_boundingRect.topLeft());
+            paintStaticLayer(&layerPainter, layer);
+            layerPainter.end();
+            
+            RenderCache::insert(key, cache.pixmap);
+            
+            cost.staticRebuilds++;
+            cost.rebuildNs += timer.nsecsElapsed();
+        }
+        
+        cache.scale = scale;
+        cache.state = state;
+        cache.detail = m_detailLevel;
+    }
+    
+    painter->drawPixmap(m_boundingRect.topLeft(), cache.pixmap);
 }
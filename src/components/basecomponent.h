@@ -3,6 +3,8 @@
 
 #include <QGraphicsItem>
 #include <QPainter>
+#include <QPixmap>
+#include <QHash>
 #include <QObject>
 
 class BaseComponent : public QObject, public QGraphicsItem
@@ -11,21 +13,136 @@ class BaseComponent : public QObject, public QGraphicsItem
     Q_INTERFACES(QGraphicsItem)
 
 public:
+    // Artwork that only changes with the component state is rendered once
+    // into a pixmap per layer and blitted; paintComponent() draws the
+    // animated overlay between the two layers. Layer pixmaps come from the
+    // process-wide RenderCache, so components of one type in one state
+    // share them.
+    enum StaticLayer {
+        BackgroundLayer = 0x1,
+        ForegroundLayer = 0x2
+    };
+    
+    // Detail tiers chosen from the zoom: a flat status-coloured symbol,
+    // the artwork without text and arrows, or everything
+    enum DetailLevel {
+        SymbolDetail,
+        ReducedDetail,
+        FullDetail
+    };
+    
+    // Round status indicator, in item coordinates
+    struct StatusLed {
+        QPointF center;
+        qreal radius;
+        QColor color;
+    };
+    
+    // Accumulated paint cost per component type
+    struct RenderCost {
+        quint64 paints;
+        quint64 staticRebuilds;
+        qint64 paintNs;
+        qint64 rebuildNs;
+    };
+    
     explicit BaseComponent(QObject *parent = nullptr);
     virtual ~BaseComponent() = default;
     
     virtual void updateAnimation(double deltaTime);
     virtual void updateState();
     
+    // True while updateAnimation() has something to move
+    bool isAnimating() const { return m_isActive; }
+    
+    // False if the component has no status LED
+    virtual bool statusLed(StatusLed *led) const;
+    
+    // While batched, a StatusLedBatch draws the LED instead of the component
+    void setStatusLedBatched(bool batched);
+    bool isStatusLedBatched() const { return m_statusLedBatched; }
+    
     QRectF boundingRect() const override;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+    
+    // Keyed by class name; collected per meta-object so painting never
+    // builds names
+    static QHash<QString, RenderCost> renderCosts();
+    static void resetRenderCosts() { s_renderCosts.clear(); }
+    
+    // Monotonic count of component paints, for per-frame repaint statistics
+    static quint64 totalPaints() { return s_totalPaints; }
+    
+    // Resolution for pixmap caches drawn through this painter
+    static qreal cacheScale(const QPainter *painter);
+    
+    // Tier for a level of detail from QStyleOptionGraphicsItem
+    static DetailLevel detailLevelFor(qreal levelOfDetail);
+    
+    // Off paints every component at full detail (for comparisons)
+    static void setLevelOfDetailEnabled(bool enabled) { s_levelOfDetailEnabled = enabled; }
+    static bool isLevelOfDetailEnabled() { return s_levelOfDetailEnabled; }
 
 protected:
     virtual void paintComponent(QPainter *painter) = 0;
     
+    // Static artwork; only called when a cached layer is rebuilt
+    virtual void paintStaticLayer(QPainter *painter, StaticLayer layer);
+    
+    // Anything the artwork of a layer depends on, e.g. running/stopped or
+    // a quantized level; the layer is redrawn (or looked up) when it changes
+    virtual int staticLayerState(StaticLayer layer) const;
+    
+    // Per-instance artwork, e.g. a numbered label; layers are only shared
+    // between components of one type with the same variant
+    virtual QString staticLayerVariant() const { return QString(); }
+    
+    // Drawn instead of everything else at SymbolDetail
+    virtual void paintSymbol(QPainter *painter);
+    virtual QColor symbolColor() const;
+    
+    // Tier of the paint in progress, or of the last paint in between; the
+    // animations use it to skip repaints the tier would not show
+    DetailLevel detailLevel() const { return m_detailLevel; }
+    
+    void setStaticLayers(int layers) { m_staticLayers = layers; }
+    void invalidateStaticLayers();
+    
+    // Draws statusLed() unless it is batched
+    void drawStatusLed(QPainter *painter) const;
+    
+    // Repaints only when the drawn (quantized) value differs from the last one
+    template<typename T>
+    void updateIfChanged(T &drawn, const T &value)
+    {
+        if (drawn != value) {
+            drawn = value;
+            update();
+        }
+    }
+    
     QRectF m_boundingRect;
     bool m_isActive;
     double m_animationPhase;
+
+private:
+    struct LayerCache {
+        QPixmap pixmap;
+        qreal scale;
+        int state;
+        DetailLevel detail;
+    };
+    
+    void drawStaticLayer(QPainter *painter, StaticLayer layer, qreal scale, RenderCost &cost);
+    
+    int m_staticLayers;
+    bool m_statusLedBatched;
+    DetailLevel m_detailLevel;
+    LayerCache m_layerCache[2];
+    
+    static QHash<const QMetaObject *, RenderCost> s_renderCosts;
+    static quint64 s_totalPaints;
+    static bool s_levelOfDetailEnabled;
 };
 
 #endif // BASECOMPONENT_H
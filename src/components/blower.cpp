@@ -1,29 +1,71 @@
 #include "blower.h"
+#include "rotationatlas.h"
 #include <QPen>
 #include <QBrush>
+#include <QPainterPath>
 #include <QtMath>
 
+namespace {
+    void drawBlades(QPainter *painter, const QColor &bladeColor)
+    {
+        QPen bladePen(bladeColor, 3);
+        painter->setPen(bladePen);
+        
+        int numBlades = 6;
+        for (int i = 0; i < numBlades; ++i) {
+            double angle = (i * 360.0 / numBlades);
+            double rad = qDegreesToRadians(angle);
+            
+            QPainterPath bladePath;
+            bladePath.moveTo(QPointF(0, 0));
+            
+            double x1 = 18 * qCos(rad);
+            double y1 = 18 * qSin(rad);
+            double x2 = 15 * qCos(rad + 0.3);
+            double y2 = 15 * qSin(rad + 0.3);
+            
+            bladePath.lineTo(QPointF(x1, y1));
+            bladePath.quadTo(QPointF(x2, y2), QPointF(0, 0));
+            
+            painter->fillPath(bladePath, QBrush(bladeColor));
+            painter->drawPath(bladePath);
+        }
+    }
+    
+    // Six blades repeat every 60 degrees; one frame per degree
+    const QRectF kBladeBounds(-21, -21, 42, 42);
+    const RotationAtlas::Style kRunningBlades = {
+        "blower.blades.running", kBladeBounds, 60.0, 60,
+        [](QPainter *painter) { drawBlades(painter, QColor(100, 150, 200)); }
+    };
+    const RotationAtlas::Style kStoppedBlades = {
+        "blower.blades.stopped", kBladeBounds, 60.0, 60,
+        [](QPainter *painter) { drawBlades(painter, QColor(120, 120, 120)); }
+    };
+}
+
 Blower::Blower(int id, QObject *parent)
     : BaseComponent(parent)
     , m_id(id)
     , m_running(false)
     , m_speed(0.0)
     , m_rotationAngle(0.0)
+    , m_drawnAngle(0)
 {
     m_boundingRect = QRectF(-25, -25, 50, 50);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void Blower::setRunning(bool running)
 {
-    m_running = running;
     m_isActive = running;
-    update();
+    updateIfChanged(m_running, running);
 }
 
 void Blower::setSpeed(double speed)
 {
+    // Speed only shows through the rotation rate
     m_speed = qBound(0.0, speed, 100.0);
-    update();
 }
 
 void Blower::updateAnimation(double deltaTime)
@@ -37,45 +79,37 @@ void Blower::updateAnimation(double deltaTime)
     }
     
     BaseComponent::updateAnimation(deltaTime);
+    
+    // Six blades repeat every 60 degrees; repaint per whole degree, and
+    // only at full detail, below which they are drawn at rest
+    bool turning = detailLevel() == FullDetail;
+    updateIfChanged(m_drawnAngle, turning ? qRound(m_rotationAngle) % 60 : 0);
 }
 
-void Blower::paintComponent(QPainter *painter)
+bool Blower::statusLed(StatusLed *led) const
 {
-    // Draw blower housing
-    painter->setPen(QPen(Qt::black, 2));
-    painter->setBrush(QBrush(QColor(150, 150, 170)));
-    painter->drawEllipse(QPointF(0, 0), 22, 22);
-    
-    // Draw fan blades (rotating when running)
-    painter->save();
-    painter->rotate(m_rotationAngle);
-    
-    QColor bladeColor = m_running ? QColor(100, 150, 200) : QColor(120, 120, 120);
-    QPen bladePen(bladeColor, 3);
-    painter->setPen(bladePen);
-    
-    int numBlades = 6;
-    for (int i = 0; i < numBlades; ++i) {
-        double angle = (i * 360.0 / numBlades);
-        double rad = qDegreesToRadians(angle);
-        
-        QPainterPath bladePath;
-        bladePath.moveTo(QPointF(0, 0));
-        
-        double x1 = 18 * qCos(rad);
-        double y1 = 18 * qSin(rad);
-        double x2 = 15 * qCos(rad + 0.3);
-        double y2 = 15 * qSin(rad + 0.3);
-        
-        bladePath.lineTo(QPointF(x1, y1));
-        bladePath.quadTo(QPointF(x2, y2), QPointF(0, 0));
-        
-        painter->fillPath(bladePath, QBrush(bladeColor));
-        painter->drawPath(bladePath);
+    led->center = QPointF(18, -18);
+    led->radius = 5;
+    led->color = m_running ? Qt::green : Qt::red;
+    return true;
+}
+
+int Blower::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return m_running ? 1 : 0;
+}
+
+void Blower::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    if (layer == BackgroundLayer) {
+        // Draw blower housing
+        painter->setPen(QPen(Qt::black, 2));
+        painter->setBrush(QBrush(QColor(150, 150, 170)));
+        painter->drawEllipse(QPointF(0, 0), 22, 22);
+        return;
     }
     
-    painter->restore();
-    
     // Draw center hub
     painter->setBrush(QBrush(Qt::darkGray));
     painter->setPen(QPen(Qt::black, 1));
@@ -87,8 +121,12 @@ void Blower::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(0, 0), 22, 22);
     
     // Draw status indicator
-    QColor statusColor = m_running ? Qt::green : Qt::red;
-    painter->setBrush(QBrush(statusColor));
-    painter->setPen(QPen(Qt::black, 1));
-    painter->drawEllipse(QPointF(18, -18), 5, 5);
+    drawStatusLed(painter);
+}
+
+void Blower::paintComponent(QPainter *painter)
+{
+    // Draw fan blades (rotating when running)
+    double angle = detailLevel() == FullDetail ? m_rotationAngle : 0.0;
+    RotationAtlas::draw(painter, m_running ? kRunningBlades : kStoppedBlades, angle);
 }
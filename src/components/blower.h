@@ -17,15 +17,19 @@ public:
     double getSpeed() const { return m_speed; }
     
     void updateAnimation(double deltaTime) override;
+    bool statusLed(StatusLed *led) const override;
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
 
 private:
     int m_id;
     bool m_running;
     double m_speed;
     double m_rotationAngle;
+    int m_drawnAngle;
 };
 
 #endif // BLOWER_H
@@ -9,20 +9,23 @@ Condenser::Condenser(int id, QObject *parent)
     , m_active(false)
     , m_temperature(25.0)
 {
+    m_label = QString("A/C\nCond.\n%1").arg(m_id);
+    m_labelFont.setPointSize(7);
+    m_labelFont.setBold(true);
     m_boundingRect = QRectF(-30, -40, 60, 80);
+    setStaticLayers(BackgroundLayer);
 }
 
 void Condenser::setActive(bool active)
 {
-    m_active = active;
     m_isActive = active;
-    update();
+    updateIfChanged(m_active, active);
 }
 
 void Condenser::setTemperature(double temp)
 {
+    // Not drawn
     m_temperature = temp;
-    update();
 }
 
 void Condenser::updateAnimation(double deltaTime)
@@ -30,8 +33,21 @@ void Condenser::updateAnimation(double deltaTime)
     BaseComponent::updateAnimation(deltaTime);
 }
 
-void Condenser::paintComponent(QPainter *painter)
+QColor Condenser::symbolColor() const
+{
+    return m_active ? QColor(100, 150, 200) : QColor(150, 150, 150);
+}
+
+int Condenser::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return m_active ? 1 : 0;
+}
+
+void Condenser::paintStaticLayer(QPainter *painter, StaticLayer layer)
 {
+    Q_UNUSED(layer);
+    
     // Draw condenser body (finned coil)
     QRectF bodyRect(-25, -35, 50, 70);
     
@@ -40,13 +56,15 @@ void Condenser::paintComponent(QPainter *painter)
     painter->setBrush(QBrush(bodyColor));
     painter->drawRect(bodyRect);
     
-    // Draw cooling fins
-    QPen finPen(Qt::darkGray, 1);
-    painter->setPen(finPen);
-    
-    for (int i = 0; i < 12; ++i) {
-        double y = -32 + (i * 6);
-        painter->drawLine(QPointF(-25, y), QPointF(25, y));
+    // Draw cooling fins; below full detail they are under a pixel apart
+    if (detailLevel() == FullDetail) {
+        QPen finPen(Qt::darkGray, 1);
+        painter->setPen(finPen);
+        
+        for (int i = 0; i < 12; ++i) {
+            double y = -32 + (i * 6);
+            painter->drawLine(QPointF(-25, y), QPointF(25, y));
+        }
     }
     
     // Draw refrigerant tubes
@@ -68,10 +86,15 @@ void Condenser::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(16, 40), 4, 4);
     
     // Draw label
-    painter->setPen(QPen(Qt::black));
-    QFont font = painter->font();
-    font.setPointSize(7);
-    font.setBold(true);
-    painter->setFont(font);
-    painter->drawText(bodyRect, Qt::AlignCenter, QString("A/C\nCond.\n%1").arg(m_id));
+    if (detailLevel() == FullDetail) {
+        painter->setPen(QPen(Qt::black));
+        painter->setFont(m_labelFont);
+        painter->drawText(bodyRect, Qt::AlignCenter, m_label);
+    }
+}
+
+void Condenser::paintComponent(QPainter *painter)
+{
+    // All of the condenser artwork is static
+    Q_UNUSED(painter);
 }
@@ -2,6 +2,7 @@
 #define CONDENSER_H
 
 #include "basecomponent.h"
+#include <QFont>
 
 class Condenser : public BaseComponent
 {
@@ -20,11 +21,19 @@ public:
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
+    QString staticLayerVariant() const override { return m_label; }
+    QColor symbolColor() const override;
 
 private:
     int m_id;
     bool m_active;
     double m_temperature;
+    
+    // Drawn into the cached static layer, so laid out only on rebuilds
+    QString m_label;
+    QFont m_labelFont;
 };
 
 #endif // CONDENSER_H
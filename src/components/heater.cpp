@@ -9,21 +9,24 @@ Heater::Heater(QObject *parent)
     , m_power(0.0)
     , m_active(false)
     , m_glowIntensity(0.0)
+    , m_drawnPowered(false)
+    , m_drawnGlowAlpha(0)
 {
     m_boundingRect = QRectF(-30, -30, 60, 60);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void Heater::setPower(double power)
 {
+    // Only whether there is any power shows (as the glow)
     m_power = power;
-    update();
+    updateIfChanged(m_drawnPowered, power > 0);
 }
 
 void Heater::setActive(bool active)
 {
-    m_active = active;
     m_isActive = active;
-    update();
+    updateIfChanged(m_active, active);
 }
 
 void Heater::updateAnimation(double deltaTime)
@@ -35,27 +38,32 @@ void Heater::updateAnimation(double deltaTime)
     }
     
     BaseComponent::updateAnimation(deltaTime);
+    
+    updateIfChanged(m_drawnGlowAlpha, (m_active && m_power > 0) ? int(m_glowIntensity * 200) : 0);
 }
 
-void Heater::paintComponent(QPainter *painter)
+bool Heater::statusLed(StatusLed *led) const
 {
-    // Draw heater body
-    painter->setPen(QPen(Qt::black, 3));
-    painter->setBrush(QBrush(QColor(150, 150, 150)));
-    painter->drawRect(QRectF(-25, -25, 50, 50));
-    
-    // Draw heating elements
-    if (m_active && m_power > 0) {
-        // Glow effect when active
-        QRadialGradient glowGradient(QPointF(0, 0), 20);
-        QColor glowColor = QColor(255, 100, 0);
-        glowColor.setAlpha(int(m_glowIntensity * 200));
-        glowGradient.setColorAt(0, glowColor);
-        glowGradient.setColorAt(1, Qt::transparent);
-        
-        painter->setBrush(QBrush(glowGradient));
-        painter->setPen(Qt::NoPen);
-        painter->drawEllipse(QPointF(0, 0), 20, 20);
+    led->center = QPointF(20, -20);
+    led->radius = 5;
+    led->color = m_active ? Qt::red : Qt::darkGray;
+    return true;
+}
+
+int Heater::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return m_active ? 1 : 0;
+}
+
+void Heater::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    if (layer == BackgroundLayer) {
+        // Draw heater body
+        painter->setPen(QPen(Qt::black, 3));
+        painter->setBrush(QBrush(QColor(150, 150, 150)));
+        painter->drawRect(QRectF(-25, -25, 50, 50));
+        return;
     }
     
     // Draw heating coils
@@ -82,8 +90,22 @@ void Heater::paintComponent(QPainter *painter)
     painter->drawRect(QRectF(-25, -25, 50, 50));
     
     // Draw power indicator
-    QColor indicatorColor = m_active ? Qt::red : Qt::darkGray;
-    painter->setBrush(QBrush(indicatorColor));
-    painter->setPen(QPen(Qt::black, 1));
-    painter->drawEllipse(QPointF(20, -20), 5, 5);
+    drawStatusLed(painter);
+}
+
+void Heater::paintComponent(QPainter *painter)
+{
+    // Draw heating elements
+    if (m_active && m_power > 0) {
+        // Glow effect when active
+        QRadialGradient glowGradient(QPointF(0, 0), 20);
+        QColor glowColor = QColor(255, 100, 0);
+        glowColor.setAlpha(int(m_glowIntensity * 200));
+        glowGradient.setColorAt(0, glowColor);
+        glowGradient.setColorAt(1, Qt::transparent);
+        
+        painter->setBrush(QBrush(glowGradient));
+        painter->setPen(Qt::NoPen);
+        painter->drawEllipse(QPointF(0, 0), 20, 20);
+    }
 }
@@ -17,14 +17,19 @@ public:
     bool isActive() const { return m_active; }
     
     void updateAnimation(double deltaTime) override;
+    bool statusLed(StatusLed *led) const override;
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
 
 private:
     double m_power;
     bool m_active;
     double m_glowIntensity;
+    bool m_drawnPowered;
+    int m_drawnGlowAlpha;
 };
 
 #endif // HEATER_H
@@ -10,26 +10,29 @@ HeatExchanger::HeatExchanger(int id, QObject *parent)
     , m_hotSideTemp(25.0)
     , m_coldSideTemp(15.0)
 {
+    m_label = QString("PHE %1").arg(m_id);
+    m_labelFont.setPointSize(8);
+    m_labelFont.setBold(true);
     m_boundingRect = QRectF(-25, -35, 50, 70);
+    setStaticLayers(BackgroundLayer);
 }
 
 void HeatExchanger::setActive(bool active)
 {
-    m_active = active;
     m_isActive = active;
-    update();
+    updateIfChanged(m_active, active);
 }
 
 void HeatExchanger::setHotSideTemp(double temp)
 {
+    // Not drawn
     m_hotSideTemp = temp;
-    update();
 }
 
 void HeatExchanger::setColdSideTemp(double temp)
 {
+    // Not drawn
     m_coldSideTemp = temp;
-    update();
 }
 
 void HeatExchanger::updateAnimation(double deltaTime)
@@ -37,8 +40,21 @@ void HeatExchanger::updateAnimation(double deltaTime)
     BaseComponent::updateAnimation(deltaTime);
 }
 
-void HeatExchanger::paintComponent(QPainter *painter)
+QColor HeatExchanger::symbolColor() const
+{
+    return m_active ? QColor(200, 120, 100) : QColor(150, 150, 150);
+}
+
+int HeatExchanger::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return m_active ? 1 : 0;
+}
+
+void HeatExchanger::paintStaticLayer(QPainter *painter, StaticLayer layer)
 {
+    Q_UNUSED(layer);
+    
     // Draw PHE body (Plate Heat Exchanger)
     QRectF bodyRect(-20, -30, 40, 60);
     painter->setPen(QPen(Qt::black, 2));
@@ -73,10 +89,15 @@ void HeatExchanger::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(25, 0), 5, 5);
     
     // Draw label
-    painter->setPen(QPen(Qt::black));
-    QFont font = painter->font();
-    font.setPointSize(8);
-    font.setBold(true);
-    painter->setFont(font);
-    painter->drawText(bodyRect, Qt::AlignCenter, QString("PHE %1").arg(m_id));
+    if (detailLevel() == FullDetail) {
+        painter->setPen(QPen(Qt::black));
+        painter->setFont(m_labelFont);
+        painter->drawText(bodyRect, Qt::AlignCenter, m_label);
+    }
+}
+
+void HeatExchanger::paintComponent(QPainter *painter)
+{
+    // All of the heat exchanger artwork is static
+    Q_UNUSED(painter);
 }
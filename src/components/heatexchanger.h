@@ -2,6 +2,7 @@
 #define HEATEXCHANGER_H
 
 #include "basecomponent.h"
+#include <QFont>
 
 class HeatExchanger : public BaseComponent
 {
@@ -23,12 +24,20 @@ public:
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
+    QString staticLayerVariant() const override { return m_label; }
+    QColor symbolColor() const override;
 
 private:
     int m_id;
     bool m_active;
     double m_hotSideTemp;
     double m_coldSideTemp;
+    
+    // Drawn into the cached static layer, so laid out only on rebuilds
+    QString m_label;
+    QFont m_labelFont;
 };
 
 #endif // HEATEXCHANGER_H
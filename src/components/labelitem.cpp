@@ -0,0 +1,52 @@
+#include "labelitem.h"
+#include "textcache.h"
+#include <QPainter>
+
+namespace {
+    // Same inset as a QGraphicsTextItem's document margin, so labels keep
+    // their positions
+    const qreal kMargin = 4.0;
+}
+
+LabelItem::LabelItem(const QString &text, const QFont &font, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , m_font(font)
+    , m_color(Qt::black)
+{
+    setText(text);
+}
+
+void LabelItem::setText(const QString &text)
+{
+    if (text == m_text && !m_boundingRect.isNull()) {
+        return;
+    }
+    
+    prepareGeometryChange();
+    m_text = text;
+    QSizeF size = TextCache::size(text, m_font);
+    m_boundingRect = QRectF(0, 0, size.width() + 2 * kMargin, size.height() + 2 * kMargin);
+    update();
+}
+
+void LabelItem::setColor(const QColor &color)
+{
+    if (color != m_color) {
+        m_color = color;
+        update();
+    }
+}
+
+QRectF LabelItem::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+void LabelItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    
+    painter->setPen(m_color);
+    TextCache::draw(painter, QPointF(kMargin, kMargin), m_text, m_font);
+}
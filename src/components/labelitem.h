@@ -0,0 +1,30 @@
+#ifndef LABELITEM_H
+#define LABELITEM_H
+
+#include <QGraphicsItem>
+#include <QFont>
+#include <QColor>
+
+// Fixed scene text drawn through the shared TextCache; much lighter than
+// a QGraphicsTextItem, which owns a whole text document
+class LabelItem : public QGraphicsItem
+{
+public:
+    LabelItem(const QString &text, const QFont &font, QGraphicsItem *parent = nullptr);
+    
+    void setText(const QString &text);
+    QString text() const { return m_text; }
+    
+    void setColor(const QColor &color);
+    
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    QString m_text;
+    QFont m_font;
+    QColor m_color;
+    QRectF m_boundingRect;
+};
+
+#endif // LABELITEM_H
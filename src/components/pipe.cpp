@@ -1,9 +1,59 @@
 #include "pipe.h"
+#include "rendercache.h"
 #include <QPen>
 #include <QBrush>
 #include <QPainterPath>
+#include <QPainterPathStroker>
+#include <QImage>
+#include <QPixmap>
 #include <QtMath>
 
+namespace {
+    // Dash pattern along the pipe, in multiples of the stripe width (as a
+    // dashed QPen would measure it)
+    const double kDashLength = 10.0;
+    const double kDashPeriod = 20.0;
+    const double kStripeWidth = 0.4;        // of the pipe width
+    
+    // Texture pixels per pattern unit, so dashes stay crisp when zoomed in
+    const int kTextureScale = 4;
+    
+    // Longest piece of a stripe covered by one dirty rect, so diagonal
+    // runs invalidate a thin band rather than their whole bounding box
+    const double kDirtyChunk = 24.0;
+    
+    // One tiled dash texture per dash colour, shared by all pipes through
+    // the bounded render cache; pipes keep their brush, so eviction only
+    // costs a rebuild on the next colour change
+    QBrush dashBrush(const QColor &color)
+    {
+        RenderCache::Key key{ &Pipe::staticMetaObject, QStringLiteral("dash"), 0,
+                              int(color.rgba()), 0, qreal(kTextureScale) };
+        QPixmap texture;
+        if (!RenderCache::find(key, &texture)) {
+            QImage image(int(kDashPeriod) * kTextureScale, kTextureScale, QImage::Format_ARGB32_Premultiplied);
+            image.fill(Qt::transparent);
+            for (int y = 0; y < image.height(); ++y) {
+                for (int x = 0; x < int(kDashLength) * kTextureScale; ++x) {
+                    image.setPixelColor(x, y, color);
+                }
+            }
+            texture = QPixmap::fromImage(image);
+            RenderCache::insert(key, texture);
+        }
+        return QBrush(texture);
+    }
+    
+    QPainterPath strokeOf(const QPainterPath &path, double width, Qt::PenCapStyle cap, Qt::PenJoinStyle join)
+    {
+        QPainterPathStroker stroker;
+        stroker.setWidth(width);
+        stroker.setCapStyle(cap);
+        stroker.setJoinStyle(join);
+        return stroker.createStroke(path);
+    }
+}
+
 Pipe::Pipe(QObject *parent)
     : BaseComponent(parent)
     , m_flowing(false)
@@ -11,60 +61,143 @@ Pipe::Pipe(QObject *parent)
     , m_width(6.0)
     , m_fluidColor(QColor(100, 150, 200))
     , m_flowOffset(0.0)
+    , m_drawnOffset(0)
 {
     m_boundingRect = QRectF(-100, -100, 200, 200);
+    m_dashBrush = dashBrush(m_fluidColor.darker(120));
 }
 
 void Pipe::setPath(const QVector<QPointF> &points)
 {
     m_points = points;
-    
-    if (m_points.size() >= 2) {
-        // Calculate bounding rect from points
-        double minX = m_points[0].x();
-        double maxX = m_points[0].x();
-        double minY = m_points[0].y();
-        double maxY = m_points[0].y();
-        
-        for (const QPointF &point : m_points) {
-            minX = qMin(minX, point.x());
-            maxX = qMax(maxX, point.x());
-            minY = qMin(minY, point.y());
-            maxY = qMax(maxY, point.y());
-        }
-        
-        double margin = m_width + 5;
-        m_boundingRect = QRectF(minX - margin, minY - margin, 
-                                maxX - minX + 2 * margin, 
-                                maxY - minY + 2 * margin);
-    }
-    
+    rebuildGeometry();
     update();
 }
 
 void Pipe::setFlowing(bool flowing)
 {
-    m_flowing = flowing;
     m_isActive = flowing;
-    update();
+    updateIfChanged(m_flowing, flowing);
 }
 
 void Pipe::setFlowDirection(bool forward)
 {
-    m_flowForward = forward;
-    update();
+    if (m_flowForward != forward) {
+        m_flowForward = forward;
+        rebuildGeometry();
+        update();
+    }
 }
 
 void Pipe::setWidth(double width)
 {
-    m_width = width;
-    update();
+    if (m_width != width) {
+        m_width = width;
+        rebuildGeometry();
+        update();
+    }
 }
 
 void Pipe::setFluidColor(const QColor &color)
 {
-    m_fluidColor = color;
-    update();
+    if (m_fluidColor != color) {
+        m_fluidColor = color;
+        m_dashBrush = dashBrush(color.darker(120));
+        update();
+    }
+}
+
+void Pipe::rebuildGeometry()
+{
+    prepareGeometryChange();
+    m_path = QPainterPath();
+    m_outline = QPainterPath();
+    m_inner = QPainterPath();
+    m_arrows = QPainterPath();
+    m_segments.clear();
+    m_dirtyRects.clear();
+    
+    if (m_points.size() < 2) {
+        return;
+    }
+    
+    // Calculate bounding rect from points
+    double minX = m_points[0].x();
+    double maxX = m_points[0].x();
+    double minY = m_points[0].y();
+    double maxY = m_points[0].y();
+    
+    for (const QPointF &point : m_points) {
+        minX = qMin(minX, point.x());
+        maxX = qMax(maxX, point.x());
+        minY = qMin(minY, point.y());
+        maxY = qMax(maxY, point.y());
+    }
+    
+    double margin = m_width + 5;
+    m_boundingRect = QRectF(minX - margin, minY - margin, 
+                            maxX - minX + 2 * margin, 
+                            maxY - minY + 2 * margin);
+    
+    QPainterPath path;
+    path.moveTo(m_points[0]);
+    for (int i = 1; i < m_points.size(); ++i) {
+        path.lineTo(m_points[i]);
+    }
+    m_path = path;
+    m_outline = strokeOf(path, m_width + 2, Qt::RoundCap, Qt::RoundJoin);
+    m_inner = strokeOf(path, m_width, Qt::RoundCap, Qt::RoundJoin);
+    
+    QPainterPath arrows;
+    double halfStripe = m_width * kStripeWidth / 2.0;
+    double distance = 0.0;
+    m_segments.reserve(m_points.size() - 1);
+    
+    for (int i = 0; i < m_points.size() - 1; ++i) {
+        QPointF p1 = m_points[i];
+        QPointF p2 = m_points[i + 1];
+        
+        QPointF dir = p2 - p1;
+        double length = qSqrt(dir.x() * dir.x() + dir.y() * dir.y());
+        if (length <= 0.0) {
+            continue;
+        }
+        dir /= length;
+        QPointF perp(-dir.y(), dir.x());
+        
+        Segment segment;
+        segment.stripe << p1 + perp * halfStripe << p2 + perp * halfStripe
+                       << p2 - perp * halfStripe << p1 - perp * halfStripe;
+        segment.textureBase.translate(p1.x(), p1.y());
+        segment.textureBase.rotateRadians(qAtan2(dir.y(), dir.x()));
+        segment.textureBase.translate(-distance, -halfStripe);
+        m_segments.append(segment);
+        distance += length;
+        
+        // One pixel of antialiasing around the stripe
+        double margin = halfStripe + 1.0;
+        int chunks = qMax(1, int(qCeil(length / kDirtyChunk)));
+        for (int c = 0; c < chunks; ++c) {
+            QPointF a = p1 + dir * (length * c / chunks);
+            QPointF b = p1 + dir * (length * (c + 1) / chunks);
+            m_dirtyRects.append(QRectF(a, b).normalized().adjusted(-margin, -margin, margin, margin));
+        }
+        
+        // Flow direction arrow at the midpoint of long runs
+        if (length > 30) {
+            QPointF arrowDir = m_flowForward ? dir : -dir;
+            QPointF arrowPerp(-arrowDir.y(), arrowDir.x());
+            
+            QPointF mid = (p1 + p2) / 2.0;
+            QPointF arrowTip = mid + arrowDir * 8;
+            arrows.moveTo(arrowTip);
+            arrows.lineTo(mid + arrowPerp * 4);
+            arrows.moveTo(arrowTip);
+            arrows.lineTo(mid - arrowPerp * 4);
+        }
+    }
+    
+    m_arrows = strokeOf(arrows, 2, Qt::SquareCap, Qt::BevelJoin);
 }
 
 void Pipe::updateAnimation(double deltaTime)
@@ -78,88 +211,77 @@ void Pipe::updateAnimation(double deltaTime)
         }
         
         // Keep offset in reasonable range
-        double dashLength = 20.0;
-        while (m_flowOffset > dashLength) {
-            m_flowOffset -= dashLength;
-        }
-        while (m_flowOffset < 0) {
-            m_flowOffset += dashLength;
+        m_flowOffset = std::fmod(m_flowOffset, kDashPeriod);
+        if (m_flowOffset < 0) {
+            m_flowOffset += kDashPeriod;
         }
     }
     
     BaseComponent::updateAnimation(deltaTime);
+    
+    // Dashes move in quarter-unit steps; only the stripes need repainting,
+    // and nothing does while the pipe is drawn as a symbol
+    int drawnOffset = qRound(m_flowOffset * 4.0);
+    if (m_flowing && detailLevel() != SymbolDetail && drawnOffset != m_drawnOffset) {
+        m_drawnOffset = drawnOffset;
+        for (const QRectF &rect : m_dirtyRects) {
+            update(rect);
+        }
+    }
+}
+
+QPainterPath Pipe::shape() const
+{
+    return m_outline.isEmpty() ? BaseComponent::shape() : m_outline;
 }
 
 void Pipe::paintComponent(QPainter *painter)
 {
-    if (m_points.size() < 2) {
+    if (m_segments.isEmpty()) {
         return;
     }
     
-    // Draw pipe outline
-    QPen outlinePen(Qt::black, m_width + 2);
-    outlinePen.setCapStyle(Qt::RoundCap);
-    outlinePen.setJoinStyle(Qt::RoundJoin);
-    painter->setPen(outlinePen);
+    painter->setPen(Qt::NoPen);
     
-    QPainterPath path;
-    path.moveTo(m_points[0]);
-    for (int i = 1; i < m_points.size(); ++i) {
-        path.lineTo(m_points[i]);
+    // Pipe outline and inner
+    painter->setBrush(Qt::black);
+    painter->drawPath(m_outline);
+    painter->setBrush(m_flowing ? m_fluidColor.lighter(150) : QColor(200, 200, 200));
+    painter->drawPath(m_inner);
+    
+    if (!m_flowing) {
+        return;
     }
-    painter->drawPath(path);
     
-    // Draw pipe inner
-    QColor pipeColor = m_flowing ? m_fluidColor.lighter(150) : QColor(200, 200, 200);
-    QPen innerPen(pipeColor, m_width);
-    innerPen.setCapStyle(Qt::RoundCap);
-    innerPen.setJoinStyle(Qt::RoundJoin);
-    painter->setPen(innerPen);
-    painter->drawPath(path);
+    // Flow animation: scroll the dash texture along each run
+    double patternUnit = m_width * kStripeWidth;
+    QBrush dashes = m_dashBrush;
+    for (const Segment &segment : m_segments) {
+        QTransform transform = segment.textureBase;
+        transform.scale(patternUnit, patternUnit);
+        transform.translate(m_flowOffset, 0);
+        transform.scale(1.0 / kTextureScale, 1.0 / kTextureScale);
+        dashes.setTransform(transform);
+        painter->setBrush(dashes);
+        painter->drawPolygon(segment.stripe);
+    }
     
-    // Draw flow animation
-    if (m_flowing) {
-        QPen flowPen(m_fluidColor.darker(120), m_width * 0.4);
-        flowPen.setCapStyle(Qt::RoundCap);
-        flowPen.setJoinStyle(Qt::RoundJoin);
-        flowPen.setDashPattern({10, 10});
-        flowPen.setDashOffset(m_flowOffset);
-        
-        painter->setPen(flowPen);
-        painter->drawPath(path);
-        
-        // Draw flow direction arrows
-        for (int i = 0; i < m_points.size() - 1; ++i) {
-            QPointF p1 = m_points[i];
-            QPointF p2 = m_points[i + 1];
-            
-            QPointF mid = (p1 + p2) / 2.0;
-            QPointF dir = p2 - p1;
-            double length = qSqrt(dir.x() * dir.x() + dir.y() * dir.y());
-            
-            if (length > 30) {
-                dir /= length;
-                
-                if (!m_flowForward) {
-                    dir = -dir;
-                }
-                
-                QPointF perp(-dir.y(), dir.x());
-                
-                QPointF arrowTip = mid + dir * 8;
-                QPointF arrowLeft = arrowTip - dir * 8 + perp * 4;
-                QPointF arrowRight = arrowTip - dir * 8 - perp * 4;
-                
-                QPainterPath arrow;
-                arrow.moveTo(arrowTip);
-                arrow.lineTo(arrowLeft);
-                arrow.moveTo(arrowTip);
-                arrow.lineTo(arrowRight);
-                
-                QPen arrowPen(m_fluidColor.darker(150), 2);
-                painter->setPen(arrowPen);
-                painter->drawPath(arrow);
-            }
-        }
+    // Flow direction arrows
+    if (detailLevel() == FullDetail) {
+        painter->setBrush(m_fluidColor.darker(150));
+        painter->drawPath(m_arrows);
     }
 }
+
+void Pipe::paintSymbol(QPainter *painter)
+{
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(symbolColor());
+    painter->drawPath(m_outline);
+}
+
+QColor Pipe::symbolColor() const
+{
+    return m_flowing ? m_fluidColor : QColor(150, 150, 150);
+}
@@ -4,6 +4,10 @@
 #include "basecomponent.h"
 #include <QPointF>
 #include <QVector>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QTransform>
+#include <QBrush>
 
 class Pipe : public BaseComponent
 {
@@ -19,22 +23,49 @@ public:
     bool isFlowing() const { return m_flowing; }
     
     void setFlowDirection(bool forward); // true = forward, false = reverse
+    bool isFlowForward() const { return m_flowForward; }
+    
     void setWidth(double width);
+    double getWidth() const { return m_width; }
     
     void setFluidColor(const QColor &color);
+    QColor getFluidColor() const { return m_fluidColor; }
     
     void updateAnimation(double deltaTime) override;
+    
+    // The stroked pipe, not its bounding box
+    QPainterPath shape() const override;
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintSymbol(QPainter *painter) override;
+    QColor symbolColor() const override;
 
 private:
+    // Flow stripe of one straight run; the dash texture is mapped along it
+    struct Segment {
+        QPolygonF stripe;
+        QTransform textureBase;     // texture x = distance along the whole pipe
+    };
+    
+    // Geometry only changes with the path, width or direction
+    void rebuildGeometry();
+    
     QVector<QPointF> m_points;
     bool m_flowing;
     bool m_flowForward;
     double m_width;
     QColor m_fluidColor;
     double m_flowOffset;
+    int m_drawnOffset;
+    
+    QPainterPath m_path;
+    QPainterPath m_outline;         // filled strokes, so painting needs no stroker
+    QPainterPath m_inner;
+    QPainterPath m_arrows;
+    QVector<Segment> m_segments;
+    QVector<QRectF> m_dirtyRects;   // small rects covering the flow stripes
+    QBrush m_dashBrush;
 };
 
 #endif // PIPE_H
@@ -0,0 +1,228 @@
+#include "pipebatch.h"
+#include <QPen>
+#include <QtMath>
+
+namespace {
+    // Same dash pattern and speed as Pipe, in multiples of the stripe width
+    const double kDashPeriod = 20.0;
+    const double kStripeWidth = 0.4;
+    const double kFlowSpeed = 50.0;
+    
+    // Arrows only on runs long enough to show them
+    const double kMinArrowLength = 30.0;
+    
+    // Longest piece of a stripe covered by one dirty rect, as in Pipe
+    const double kDirtyChunk = 24.0;
+}
+
+PipeBatch::PipeBatch(QObject *parent)
+    : BaseComponent(parent)
+    , m_flowingCount(0)
+    , m_flowOffset(0.0)
+    , m_drawnOffset(0)
+{
+    m_boundingRect = QRectF();
+}
+
+int PipeBatch::addPipe(const QVector<QPointF> &points, const QColor &fluidColor, double width)
+{
+    int styleIndex = -1;
+    for (int i = 0; i < m_styles.size(); ++i) {
+        if (m_styles[i].fluidColor == fluidColor && m_styles[i].width == width) {
+            styleIndex = i;
+            break;
+        }
+    }
+    if (styleIndex < 0) {
+        Style style;
+        style.fluidColor = fluidColor;
+        style.width = width;
+        style.dirty = true;
+        m_styles.append(style);
+        styleIndex = m_styles.size() - 1;
+    }
+    
+    Style &style = m_styles[styleIndex];
+    Entry entry;
+    entry.style = styleIndex;
+    entry.firstLine = style.lines.size();
+    entry.lineCount = 0;
+    entry.flowing = false;
+    entry.forward = true;
+    
+    QRectF bounds;
+    for (int i = 0; i + 1 < points.size(); ++i) {
+        style.lines.append(QLineF(points[i], points[i + 1]));
+        entry.lineCount++;
+        bounds |= QRectF(points[i], points[i + 1]).normalized();
+    }
+    
+    double margin = width + 5;
+    prepareGeometryChange();
+    m_boundingRect |= bounds.adjusted(-margin, -margin, margin, margin);
+    
+    style.pipes.append(m_pipes.size());
+    style.dirty = true;
+    m_pipes.append(entry);
+    update();
+    return m_pipes.size() - 1;
+}
+
+void PipeBatch::markDirty(int pipe)
+{
+    m_styles[m_pipes[pipe].style].dirty = true;
+    update();
+}
+
+void PipeBatch::setFlowing(int pipe, bool flowing)
+{
+    if (pipe >= 0 && pipe < m_pipes.size() && m_pipes[pipe].flowing != flowing) {
+        m_pipes[pipe].flowing = flowing;
+        m_flowingCount += flowing ? 1 : -1;
+        m_isActive = m_flowingCount > 0;
+        markDirty(pipe);
+    }
+}
+
+void PipeBatch::setFlowDirection(int pipe, bool forward)
+{
+    if (pipe >= 0 && pipe < m_pipes.size() && m_pipes[pipe].forward != forward) {
+        m_pipes[pipe].forward = forward;
+        markDirty(pipe);
+    }
+}
+
+void PipeBatch::rebuildStyle(Style &style)
+{
+    style.flowingLines.clear();
+    style.idleLines.clear();
+    style.arrowLines.clear();
+    style.stripeRects.clear();
+    
+    // One pixel of antialiasing around the stripe
+    const double margin = style.width * kStripeWidth / 2.0 + 1.0;
+    
+    for (int index : style.pipes) {
+        const Entry &entry = m_pipes[index];
+        for (int i = entry.firstLine; i < entry.firstLine + entry.lineCount; ++i) {
+            QLineF line = style.lines[i];
+            if (!entry.flowing) {
+                style.idleLines.append(line);
+                continue;
+            }
+            if (!entry.forward) {
+                line = QLineF(line.p2(), line.p1());
+            }
+            style.flowingLines.append(line);
+            
+            double length = line.length();
+            int chunks = qMax(1, int(qCeil(length / kDirtyChunk)));
+            for (int c = 0; c < chunks; ++c) {
+                QRectF chunk(line.pointAt(double(c) / chunks), line.pointAt(double(c + 1) / chunks));
+                style.stripeRects.append(chunk.normalized().adjusted(-margin, -margin, margin, margin));
+            }
+            
+            if (length > kMinArrowLength) {
+                QPointF dir = (line.p2() - line.p1()) / length;
+                QPointF perp(-dir.y(), dir.x());
+                QPointF mid = line.center();
+                QPointF tip = mid + dir * 8;
+                style.arrowLines.append(QLineF(tip, mid + perp * 4));
+                style.arrowLines.append(QLineF(tip, mid - perp * 4));
+            }
+        }
+    }
+    style.dirty = false;
+}
+
+void PipeBatch::updateAnimation(double deltaTime)
+{
+    if (m_flowingCount > 0) {
+        m_flowOffset = std::fmod(m_flowOffset + kFlowSpeed * deltaTime, kDashPeriod);
+        
+        // Dashes move in quarter-unit steps; only the flowing stripes need
+        // repainting, not the bounds of every pipe of the batch, and none
+        // while the batch is drawn as a symbol
+        int drawnOffset = qRound(m_flowOffset * 4.0);
+        if (detailLevel() != SymbolDetail && drawnOffset != m_drawnOffset) {
+            m_drawnOffset = drawnOffset;
+            for (Style &style : m_styles) {
+                if (style.dirty) {
+                    rebuildStyle(style);
+                }
+                for (const QRectF &rect : style.stripeRects) {
+                    update(rect);
+                }
+            }
+        }
+    }
+    
+    BaseComponent::updateAnimation(deltaTime);
+}
+
+void PipeBatch::paintComponent(QPainter *painter)
+{
+    painter->setBrush(Qt::NoBrush);
+    
+    for (Style &style : m_styles) {
+        if (style.dirty) {
+            rebuildStyle(style);
+        }
+        
+        // Round caps on every segment also round the joints
+        QPen pen(Qt::black, style.width + 2);
+        pen.setCapStyle(Qt::RoundCap);
+        painter->setPen(pen);
+        painter->drawLines(style.lines);
+        
+        pen.setWidthF(style.width);
+        pen.setColor(QColor(200, 200, 200));
+        painter->setPen(pen);
+        painter->drawLines(style.idleLines);
+        
+        if (style.flowingLines.isEmpty()) {
+            continue;
+        }
+        
+        pen.setColor(style.fluidColor.lighter(150));
+        painter->setPen(pen);
+        painter->drawLines(style.flowingLines);
+        
+        // A dashed pen's offset runs against the line direction
+        QPen flowPen(style.fluidColor.darker(120), style.width * kStripeWidth);
+        flowPen.setCapStyle(Qt::RoundCap);
+        flowPen.setDashPattern({10, 10});
+        flowPen.setDashOffset(kDashPeriod - m_flowOffset);
+        painter->setPen(flowPen);
+        painter->drawLines(style.flowingLines);
+        
+        // Flow direction arrows
+        if (detailLevel() == FullDetail) {
+            painter->setPen(QPen(style.fluidColor.darker(150), 2));
+            painter->drawLines(style.arrowLines);
+        }
+    }
+}
+
+void PipeBatch::paintSymbol(QPainter *painter)
+{
+    // Flat runs in the fluid colour while flowing, like a single pipe's
+    // symbol; the default would fill the whole batch's bounds
+    painter->setRenderHint(QPainter::Antialiasing, false);
+    painter->setBrush(Qt::NoBrush);
+    
+    for (Style &style : m_styles) {
+        if (style.dirty) {
+            rebuildStyle(style);
+        }
+        
+        QPen pen(QColor(150, 150, 150), style.width + 2);
+        pen.setCapStyle(Qt::RoundCap);
+        painter->setPen(pen);
+        painter->drawLines(style.idleLines);
+        
+        pen.setColor(style.fluidColor);
+        painter->setPen(pen);
+        painter->drawLines(style.flowingLines);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef PIPEBATCH_H
+#define PIPEBATCH_H
+
+#include "basecomponent.h"
+#include <QLineF>
+#include <QVector>
+
+// Draws many pipes as one scene item. Pipes that share a fluid colour and
+// width are stroked together from packed line arrays, so a large plant
+// costs a few draw calls per style instead of one item paint per pipe.
+class PipeBatch : public BaseComponent
+{
+    Q_OBJECT
+
+public:
+    explicit PipeBatch(QObject *parent = nullptr);
+    
+    // Returns the pipe index used by the setters
+    int addPipe(const QVector<QPointF> &points, const QColor &fluidColor, double width = 6.0);
+    int pipeCount() const { return m_pipes.size(); }
+    int styleCount() const { return m_styles.size(); }
+    
+    void setFlowing(int pipe, bool flowing);
+    void setFlowDirection(int pipe, bool forward);
+    
+    void updateAnimation(double deltaTime) override;
+
+protected:
+    void paintComponent(QPainter *painter) override;
+    void paintSymbol(QPainter *painter) override;
+
+private:
+    struct Style {
+        QColor fluidColor;
+        double width;
+        QVector<int> pipes;
+        QVector<QLineF> lines;          // every segment of the style's pipes
+        
+        // Rebuilt when flow states change. Reversed pipes are stored end to
+        // start, so one dash offset moves every pipe its own way.
+        QVector<QLineF> flowingLines;
+        QVector<QLineF> idleLines;
+        QVector<QLineF> arrowLines;
+        QVector<QRectF> stripeRects;    // repainted as the dashes move
+        bool dirty;
+    };
+    
+    struct Entry {
+        int style;
+        int firstLine;
+        int lineCount;
+        bool flowing;
+        bool forward;
+    };
+    
+    void rebuildStyle(Style &style);
+    void markDirty(int pipe);
+    
+    QVector<Style> m_styles;
+    QVector<Entry> m_pipes;
+    int m_flowingCount;
+    double m_flowOffset;
+    int m_drawnOffset;
+};
+
+#endif // PIPEBATCH_H
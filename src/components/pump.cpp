@@ -1,29 +1,49 @@
 #include "pump.h"
+#include "rotationatlas.h"
 #include <QPen>
 #include <QBrush>
 #include <QtMath>
 
+namespace {
+    void drawImpeller(QPainter *painter)
+    {
+        QPen bladePen(Qt::white, 3);
+        painter->setPen(bladePen);
+        
+        for (int i = 0; i < 4; ++i) {
+            double angle = i * 90.0;
+            double rad = qDegreesToRadians(angle);
+            painter->drawLine(QPointF(0, 0), 
+                            QPointF(15 * qCos(rad), 15 * qSin(rad)));
+        }
+    }
+    
+    // Four blades repeat every 90 degrees; one frame per degree
+    const RotationAtlas::Style kImpeller = { "pump.impeller", QRectF(-17, -17, 34, 34), 90.0, 90, drawImpeller };
+}
+
 Pump::Pump(int pumpId, QObject *parent)
     : BaseComponent(parent)
     , m_pumpId(pumpId)
     , m_running(false)
     , m_flowRate(0.0)
     , m_rotationAngle(0.0)
+    , m_drawnAngle(0)
 {
     m_boundingRect = QRectF(-25, -25, 50, 50);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void Pump::setRunning(bool running)
 {
-    m_running = running;
     m_isActive = running;
-    update();
+    updateIfChanged(m_running, running);
 }
 
 void Pump::setFlowRate(double flowRate)
 {
+    // Not drawn
     m_flowRate = flowRate;
-    update();
 }
 
 void Pump::updateAnimation(double deltaTime)
@@ -39,32 +59,36 @@ void Pump::updateAnimation(double deltaTime)
         }
     }
     BaseComponent::updateAnimation(deltaTime);
+    
+    // The impeller repeats every 90 degrees; repaint per whole degree, and
+    // only at full detail, below which it is drawn at rest
+    bool turning = m_running && detailLevel() == FullDetail;
+    updateIfChanged(m_drawnAngle, turning ? qRound(m_rotationAngle) % 90 : 0);
 }
 
-void Pump::paintComponent(QPainter *painter)
+bool Pump::statusLed(StatusLed *led) const
 {
-    // Draw pump body
-    QColor pumpColor = m_running ? QColor(50, 150, 50) : QColor(150, 150, 150);
-    painter->setBrush(QBrush(pumpColor));
-    painter->setPen(QPen(Qt::black, 2));
-    painter->drawEllipse(QPointF(0, 0), 20, 20);
-    
-    // Draw pump impeller (rotating when running)
-    if (m_running) {
-        painter->save();
-        painter->rotate(m_rotationAngle);
-        
-        QPen bladePen(Qt::white, 3);
-        painter->setPen(bladePen);
-        
-        for (int i = 0; i < 4; ++i) {
-            double angle = i * 90.0;
-            double rad = qDegreesToRadians(angle);
-            painter->drawLine(QPointF(0, 0), 
-                            QPointF(15 * qCos(rad), 15 * qSin(rad)));
-        }
-        
-        painter->restore();
+    led->center = QPointF(15, -15);
+    led->radius = 5;
+    led->color = m_running ? Qt::green : Qt::red;
+    return true;
+}
+
+int Pump::staticLayerState(StaticLayer layer) const
+{
+    Q_UNUSED(layer);
+    return m_running ? 1 : 0;
+}
+
+void Pump::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    if (layer == BackgroundLayer) {
+        // Draw pump body
+        QColor pumpColor = m_running ? QColor(50, 150, 50) : QColor(150, 150, 150);
+        painter->setBrush(QBrush(pumpColor));
+        painter->setPen(QPen(Qt::black, 2));
+        painter->drawEllipse(QPointF(0, 0), 20, 20);
+        return;
     }
     
     // Draw center dot
@@ -73,8 +97,13 @@ void Pump::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(0, 0), 3, 3);
     
     // Draw status indicator
-    QColor statusColor = m_running ? Qt::green : Qt::red;
-    painter->setBrush(QBrush(statusColor));
-    painter->setPen(QPen(Qt::black, 1));
-    painter->drawEllipse(QPointF(15, -15), 5, 5);
+    drawStatusLed(painter);
+}
+
+void Pump::paintComponent(QPainter *painter)
+{
+    // Draw pump impeller (rotating when running)
+    if (m_running) {
+        RotationAtlas::draw(painter, kImpeller, detailLevel() == FullDetail ? m_rotationAngle : 0.0);
+    }
 }
@@ -17,15 +17,19 @@ public:
     double getFlowRate() const { return m_flowRate; }
     
     void updateAnimation(double deltaTime) override;
+    bool statusLed(StatusLed *led) const override;
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
 
 private:
     int m_pumpId;
     bool m_running;
     double m_flowRate;
     double m_rotationAngle;
+    int m_drawnAngle;
 };
 
 #endif // PUMP_H
@@ -0,0 +1,69 @@
+#include "rendercache.h"
+
+namespace {
+    // Enough for every look of the stock unit at several zooms
+    const qint64 kDefaultBudget = 64 * 1024 * 1024;
+    
+    qint64 pixmapBytes(const QPixmap &pixmap)
+    {
+        return qint64(pixmap.width()) * pixmap.height() * qMax(1, pixmap.depth()) / 8;
+    }
+}
+
+QCache<RenderCache::Key, QPixmap> RenderCache::s_cache(kDefaultBudget);
+quint64 RenderCache::s_hits = 0;
+quint64 RenderCache::s_misses = 0;
+bool RenderCache::s_enabled = true;
+
+bool RenderCache::find(const Key &key, QPixmap *pixmap)
+{
+    const QPixmap *cached = s_enabled ? s_cache.object(key) : nullptr;
+    if (!cached) {
+        s_misses++;
+        return false;
+    }
+    
+    s_hits++;
+    *pixmap = *cached;
+    return true;
+}
+
+void RenderCache::insert(const Key &key, const QPixmap &pixmap)
+{
+    if (s_enabled && !pixmap.isNull()) {
+        s_cache.insert(key, new QPixmap(pixmap), pixmapBytes(pixmap));
+    }
+}
+
+void RenderCache::setBudget(qint64 bytes)
+{
+    s_cache.setMaxCost(qMax<qint64>(0, bytes));
+}
+
+qint64 RenderCache::budget()
+{
+    return s_cache.maxCost();
+}
+
+RenderCache::Statistics RenderCache::statistics()
+{
+    Statistics statistics;
+    statistics.hits = s_hits;
+    statistics.misses = s_misses;
+    statistics.entries = int(s_cache.count());
+    statistics.bytes = s_cache.totalCost();
+    statistics.budget = s_cache.maxCost();
+    return statistics;
+}
+
+void RenderCache::resetStatistics()
+{
+    s_hits = 0;
+    s_misses = 0;
+}
+
+void RenderCache::clear()
+{
+    s_cache.clear();
+    resetStatistics();
+}
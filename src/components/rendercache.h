@@ -0,0 +1,72 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QPixmap>
+#include <QString>
+
+// Rasterized static layers shared by every component in the process.
+// A layer is keyed by component type, per-instance variant (e.g. a
+// label), layer, quantized state, detail tier and cache scale, so
+// identical components across units (fleet tiles, recycled renderers,
+// several scenes) rasterize each look once. Entries are evicted least
+// recently used once the memory budget is reached; pixmaps still held by
+// a component stay alive until it redraws.
+class RenderCache
+{
+public:
+    struct Key {
+        const QMetaObject *type;
+        QString variant;
+        int layer;
+        int state;
+        int detail;
+        qreal scale;
+        
+        bool operator==(const Key &other) const
+        {
+            return type == other.type && layer == other.layer && state == other.state
+                && detail == other.detail && scale == other.scale && variant == other.variant;
+        }
+    };
+    
+    struct Statistics {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        int entries = 0;
+        qint64 bytes = 0;
+        qint64 budget = 0;
+        
+        double hitRate() const { return hits + misses ? double(hits) / (hits + misses) : 0.0; }
+    };
+    
+    // False on a miss; the caller renders the layer and inserts it
+    static bool find(const Key &key, QPixmap *pixmap);
+    static void insert(const Key &key, const QPixmap &pixmap);
+    
+    // Off makes every lookup miss (for comparisons)
+    static void setEnabled(bool enabled) { s_enabled = enabled; }
+    static bool isEnabled() { return s_enabled; }
+    
+    // Memory budget in bytes of pixel data
+    static void setBudget(qint64 bytes);
+    static qint64 budget();
+    
+    static Statistics statistics();
+    static void resetStatistics();
+    static void clear();
+
+private:
+    static QCache<Key, QPixmap> s_cache;
+    static quint64 s_hits;
+    static quint64 s_misses;
+    static bool s_enabled;
+};
+
+inline size_t qHash(const RenderCache::Key &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.type, key.variant, key.layer, key.state, key.detail, key.scale);
+}
+
+#endif // RENDERCACHE_H
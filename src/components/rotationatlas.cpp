@@ -0,0 +1,96 @@
+#include "rotationatlas.h"
+#include "basecomponent.h"
+#include <QtMath>
+
+namespace {
+    // Past this many device pixels per unit the frames get too large
+    const qreal kMaxAtlasScale = 3.0;
+    
+    // Pixel bytes of all atlases; a few styles at a few zooms fit, and the
+    // largest atlas (a 90-frame impeller at kMaxAtlasScale) is ~4 MiB
+    const int kAtlasBudget = 32 * 1024 * 1024;
+}
+
+QCache<RotationAtlas::Key, RotationAtlas::Atlas> RotationAtlas::s_atlases(kAtlasBudget);
+bool RotationAtlas::s_enabled = true;
+
+void RotationAtlas::draw(QPainter *painter, const Style &style, double angle)
+{
+    qreal scale = BaseComponent::cacheScale(painter);
+    
+    if (!s_enabled || scale > kMaxAtlasScale) {
+        painter->save();
+        painter->rotate(angle);
+        style.draw(painter);
+        painter->restore();
+        return;
+    }
+    
+    const Atlas &frames = atlas(style, scale);
+    
+    double phase = std::fmod(angle, style.period);
+    if (phase < 0) {
+        phase += style.period;
+    }
+    int frame = qRound(phase / style.period * style.frames) % style.frames;
+    
+    QRectF source(QPointF((frame % frames.columns) * frames.frameSize.width(),
+                          (frame / frames.columns) * frames.frameSize.height()),
+                  frames.frameSize);
+    painter->drawPixmap(style.bounds, frames.pixmap, source);
+}
+
+const RotationAtlas::Atlas &RotationAtlas::atlas(const Style &style, qreal scale)
+{
+    Key key{ style.key, scale };
+    if (const Atlas *cached = s_atlases.object(key)) {
+        return *cached;
+    }
+    
+    Atlas *entry = new Atlas;
+    Atlas &atlas = *entry;
+    atlas.frameSize = QSize(qCeil(style.bounds.width() * scale), qCeil(style.bounds.height() * scale));
+    atlas.columns = qMax(1, int(qCeil(qSqrt(style.frames))));
+    int rows = (style.frames + atlas.columns - 1) / atlas.columns;
+    
+    atlas.pixmap = QPixmap(atlas.columns * atlas.frameSize.width(), rows * atlas.frameSize.height());
+    atlas.pixmap.fill(Qt::transparent);
+    
+    QPainter painter(&atlas.pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (int frame = 0; frame < style.frames; ++frame) {
+        QRect cell(QPoint((frame % atlas.columns) * atlas.frameSize.width(),
+                          (frame / atlas.columns) * atlas.frameSize.height()),
+                   atlas.frameSize);
+        
+        painter.save();
+        painter.setClipRect(cell);
+        painter.translate(cell.topLeft());
+        painter.scale(scale, scale);
+        painter.translate(-style.bounds.topLeft());
+        painter.rotate(frame * style.period / style.frames);
+        style.draw(&painter);
+        painter.restore();
+    }
+    painter.end();
+    
+    // Costed in pixel bytes; only older atlases are evicted to make room
+    s_atlases.insert(key, entry, qMin<qint64>(qint64(atlas.pixmap.width()) * atlas.pixmap.height() * 4,
+                                              s_atlases.maxCost()));
+    return atlas;
+}
+
+int RotationAtlas::atlasCount()
+{
+    return s_atlases.size();
+}
+
+qint64 RotationAtlas::memoryBytes()
+{
+    return s_atlases.totalCost();
+}
+
+void RotationAtlas::clear()
+{
+    s_atlases.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef ROTATIONATLAS_H
+#define ROTATIONATLAS_H
+
+#include <QPainter>
+#include <QPixmap>
+#include <QRectF>
+#include <QString>
+#include <QCache>
+#include <QHash>
+#include <functional>
+
+// Pre-rendered rotation frames of rotating parts (impellers, fan blades).
+// One atlas per style and (quantized) cache scale is shared by every
+// component of that style; painting blits the frame nearest to the current
+// angle. Views at different zooms each keep their atlas, and the least
+// recently used atlases are dropped past a small memory budget.
+class RotationAtlas
+{
+public:
+    struct Style {
+        QString key;                            // unique per artwork and state
+        QRectF bounds;                          // around the rotation centre
+        double period;                          // rotational symmetry, degrees
+        int frames;                             // frames per period
+        std::function<void(QPainter*)> draw;    // artwork at angle 0
+    };
+    
+    // One atlas per style key and cache scale
+    struct Key {
+        QString style;
+        qreal scale;
+        
+        bool operator==(const Key &other) const { return scale == other.scale && style == other.style; }
+    };
+    
+    // Blits the nearest frame, or draws the artwork directly when the atlas
+    // is disabled or zoomed in too far to be worth caching
+    static void draw(QPainter *painter, const Style &style, double angle);
+    
+    static void setEnabled(bool enabled) { s_enabled = enabled; }
+    static bool isEnabled() { return s_enabled; }
+    
+    static int atlasCount();
+    static qint64 memoryBytes();
+    static void clear();
+
+private:
+    struct Atlas {
+        QPixmap pixmap;
+        int columns;
+        QSize frameSize;
+    };
+    
+    static const Atlas &atlas(const Style &style, qreal scale);
+    
+    static QCache<Key, Atlas> s_atlases;
+    static bool s_enabled;
+};
+
+inline size_t qHash(const RotationAtlas::Key &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.style, key.scale);
+}
+
+#endif // ROTATIONATLAS_H
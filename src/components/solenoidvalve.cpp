@@ -9,21 +9,24 @@ SolenoidValve::SolenoidValve(int id, QObject *parent)
     , m_open(false)
     , m_energized(false)
     , m_pulsePhase(0.0)
+    , m_drawnCoil(0)
 {
+    m_label = QString("SV%1").arg(m_id);
+    m_labelFont.setPointSize(6);
+    m_labelFont.setBold(true);
     m_boundingRect = QRectF(-15, -25, 30, 50);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void SolenoidValve::setOpen(bool open)
 {
-    m_open = open;
-    update();
+    updateIfChanged(m_open, open);
 }
 
 void SolenoidValve::setEnergized(bool energized)
 {
-    m_energized = energized;
     m_isActive = energized;
-    update();
+    updateIfChanged(m_energized, energized);
 }
 
 void SolenoidValve::updateAnimation(double deltaTime)
@@ -36,29 +39,62 @@ void SolenoidValve::updateAnimation(double deltaTime)
     }
     
     BaseComponent::updateAnimation(deltaTime);
+    
+    // The pulse shows as a change of coil colour
+    updateIfChanged(m_drawnCoil, coilShade());
 }
 
-void SolenoidValve::paintComponent(QPainter *painter)
+int SolenoidValve::coilShade() const
 {
-    // Draw valve body
-    QRectF bodyRect(-12, -5, 24, 20);
-    QColor bodyColor = m_open ? QColor(100, 200, 100) : QColor(200, 100, 100);
-    painter->setPen(QPen(Qt::black, 2));
-    painter->setBrush(QBrush(bodyColor));
-    painter->drawRect(bodyRect);
-    
-    // Draw solenoid coil
-    QRectF coilRect(-10, -20, 20, 15);
-    QColor coilColor = m_energized ? QColor(255, 200, 0) : QColor(150, 150, 150);
-    
-    if (m_energized) {
+    // 0 when de-energized, else one of 16 pulse shades, each cached once
+    if (!m_energized) {
+        return 0;
+    }
+    return 1 + qRound((qSin(m_pulsePhase) + 1.0) * 7.5);
+}
+
+QColor SolenoidValve::coilColor() const
+{
+    int shade = coilShade();
+    if (shade > 0) {
         // Add pulse effect when energized
-        double intensity = 0.7 + 0.3 * qSin(m_pulsePhase);
-        coilColor = QColor(int(255 * intensity), int(200 * intensity), 0);
+        double intensity = 0.7 + 0.3 * ((shade - 1) / 7.5 - 1.0);
+        return QColor(int(255 * intensity), int(200 * intensity), 0);
     }
+    return QColor(150, 150, 150);
+}
+
+QColor SolenoidValve::symbolColor() const
+{
+    return m_energized ? QColor(255, 200, 0) : QColor(150, 150, 150);
+}
+
+int SolenoidValve::staticLayerState(StaticLayer layer) const
+{
+    // The coil is part of the background
+    if (layer == BackgroundLayer) {
+        return (coilShade() << 1) | (m_open ? 1 : 0);
+    }
+    return m_open ? 1 : 0;
+}
+
+void SolenoidValve::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    QRectF bodyRect(-12, -5, 24, 20);
     
-    painter->setBrush(QBrush(coilColor));
-    painter->drawRect(coilRect);
+    if (layer == BackgroundLayer) {
+        // Draw valve body
+        QColor bodyColor = m_open ? QColor(100, 200, 100) : QColor(200, 100, 100);
+        painter->setPen(QPen(Qt::black, 2));
+        painter->setBrush(QBrush(bodyColor));
+        painter->drawRect(bodyRect);
+        
+        // Draw solenoid coil
+        QRectF coilRect(-10, -20, 20, 15);
+        painter->setBrush(QBrush(coilColor()));
+        painter->drawRect(coilRect);
+        return;
+    }
     
     // Draw coil windings
     QPen windingPen(Qt::black, 1);
@@ -84,10 +120,15 @@ void SolenoidValve::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(12, 5), 3, 3);
     
     // Draw label
-    painter->setPen(QPen(Qt::white));
-    QFont font = painter->font();
-    font.setPointSize(6);
-    font.setBold(true);
-    painter->setFont(font);
-    painter->drawText(bodyRect, Qt::AlignCenter, QString("SV%1").arg(m_id));
+    if (detailLevel() == FullDetail) {
+        painter->setPen(QPen(Qt::white));
+        painter->setFont(m_labelFont);
+        painter->drawText(bodyRect, Qt::AlignCenter, m_label);
+    }
+}
+
+void SolenoidValve::paintComponent(QPainter *painter)
+{
+    // The coil is part of the background layer
+    Q_UNUSED(painter);
 }
@@ -2,6 +2,7 @@
 #define SOLENOIDVALVE_H
 
 #include "basecomponent.h"
+#include <QFont>
 
 class SolenoidValve : public BaseComponent
 {
@@ -20,12 +21,24 @@ public:
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
+    QString staticLayerVariant() const override { return m_label; }
+    QColor symbolColor() const override;
 
 private:
     int m_id;
     bool m_open;
     bool m_energized;
+    int coilShade() const;
+    QColor coilColor() const;
+    
     double m_pulsePhase;
+    int m_drawnCoil;
+    
+    // Drawn into the cached static layer, so laid out only on rebuilds
+    QString m_label;
+    QFont m_labelFont;
 };
 
 #endif // SOLENOIDVALVE_H
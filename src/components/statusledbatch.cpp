@@ -0,0 +1,97 @@
+#include "statusledbatch.h"
+#include <QPen>
+
+StatusLedBatch::StatusLedBatch(QObject *parent)
+    : BaseComponent(parent)
+    , m_groupsDirty(true)
+{
+    m_boundingRect = QRectF();
+    
+    // Above the components whose LEDs it draws
+    setZValue(1);
+}
+
+void StatusLedBatch::addComponent(BaseComponent *component)
+{
+    StatusLed led;
+    if (!component || !component->statusLed(&led)) {
+        return;
+    }
+    
+    Entry entry;
+    entry.component = component;
+    entry.center = component->mapToScene(led.center);
+    entry.radius = led.radius;
+    entry.color = led.color.rgba();
+    m_leds.append(entry);
+    component->setStatusLedBatched(true);
+    
+    qreal margin = led.radius + 1;
+    prepareGeometryChange();
+    m_boundingRect |= QRectF(entry.center, entry.center).adjusted(-margin, -margin, margin, margin);
+    m_groupsDirty = true;
+    update();
+}
+
+void StatusLedBatch::clear()
+{
+    for (const Entry &entry : m_leds) {
+        entry.component->setStatusLedBatched(false);
+    }
+    m_leds.clear();
+    m_groups.clear();
+    
+    prepareGeometryChange();
+    m_boundingRect = QRectF();
+}
+
+void StatusLedBatch::updateAnimation(double deltaTime)
+{
+    for (Entry &entry : m_leds) {
+        StatusLed led;
+        if (entry.component->statusLed(&led) && led.color.rgba() != entry.color) {
+            entry.color = led.color.rgba();
+            m_groupsDirty = true;
+            
+            qreal margin = entry.radius + 1;
+            update(QRectF(entry.center, entry.center).adjusted(-margin, -margin, margin, margin));
+        }
+    }
+    
+    BaseComponent::updateAnimation(deltaTime);
+}
+
+void StatusLedBatch::paintComponent(QPainter *painter)
+{
+    if (m_groupsDirty) {
+        m_groups.clear();
+        for (const Entry &entry : m_leds) {
+            Group *group = nullptr;
+            for (Group &candidate : m_groups) {
+                if (candidate.color == entry.color && candidate.radius == entry.radius) {
+                    group = &candidate;
+                    break;
+                }
+            }
+            if (!group) {
+                m_groups.append(Group{entry.color, entry.radius, {}});
+                group = &m_groups.last();
+            }
+            group->centers.append(entry.center);
+        }
+        m_groupsDirty = false;
+    }
+    
+    // Round points: a black disc one pixel larger, then the colour
+    for (const Group &group : m_groups) {
+        QPen pen(Qt::black, group.radius * 2 + 1);
+        pen.setCapStyle(Qt::RoundCap);
+        painter->setPen(pen);
+        painter->drawPoints(group.centers.constData(), group.centers.size());
+        
+        pen.setColor(QColor::fromRgba(group.color));
+        pen.setWidthF(group.radius * 2 - 1);
+        painter->setPen(pen);
+        painter->drawPoints(group.centers.constData(), group.centers.size());
+    }
+}
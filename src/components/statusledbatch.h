@@ -0,0 +1,50 @@
+#ifndef STATUSLEDBATCH_H
+#define STATUSLEDBATCH_H
+
+#include "basecomponent.h"
+#include <QVector>
+
+// Draws the status LEDs of many components as one scene item, one pass
+// per LED colour and size. Batched components leave their LED out.
+class StatusLedBatch : public BaseComponent
+{
+    Q_OBJECT
+
+public:
+    explicit StatusLedBatch(QObject *parent = nullptr);
+    
+    // Ignored for components without a status LED
+    void addComponent(BaseComponent *component);
+    
+    // Hands the LEDs back to their components; call before deleting the
+    // batch while they are still alive
+    void clear();
+    
+    int ledCount() const { return m_leds.size(); }
+    
+    // Polls the components and repaints the LEDs that changed
+    void updateAnimation(double deltaTime) override;
+
+protected:
+    void paintComponent(QPainter *painter) override;
+
+private:
+    struct Entry {
+        BaseComponent *component;
+        QPointF center;     // scene coordinates
+        qreal radius;
+        QRgb color;
+    };
+    
+    struct Group {
+        QRgb color;
+        qreal radius;
+        QVector<QPointF> centers;
+    };
+    
+    QVector<Entry> m_leds;
+    QVector<Group> m_groups;
+    bool m_groupsDirty;
+};
+
+#endif // STATUSLEDBATCH_H
@@ -3,62 +3,75 @@
 #include <QBrush>
 #include <QLinearGradient>
 
+namespace {
+    // Liquid colour band: cold, normal, hot
+    int temperatureBand(double temp)
+    {
+        if (temp < 20.0) {
+            return 0;
+        } else if (temp < 30.0) {
+            return 1;
+        }
+        return 2;
+    }
+    
+    QColor bandColor(int band)
+    {
+        if (band == 0) {
+            return QColor(100, 150, 255); // Cold - blue
+        } else if (band == 1) {
+            return QColor(100, 200, 200); // Normal - cyan
+        }
+        return QColor(255, 150, 100); // Hot - orange
+    }
+}
+
 Tank::Tank(QObject *parent)
     : BaseComponent(parent)
     , m_level(75.0)
     , m_temperature(25.0)
+    , m_drawnLevel(75)
+    , m_drawnColorBand(1)
 {
     m_boundingRect = QRectF(-40, -60, 80, 120);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void Tank::setLevel(double level)
 {
+    // Drawn in whole percent, one cached look per percent and colour band
     m_level = qBound(0.0, level, 100.0);
-    update();
+    updateIfChanged(m_drawnLevel, qRound(m_level));
 }
 
 void Tank::setTemperature(double temp)
 {
+    // Only the colour band is drawn
     m_temperature = temp;
-    update();
+    updateIfChanged(m_drawnColorBand, temperatureBand(temp));
 }
 
-void Tank::paintComponent(QPainter *painter)
+void Tank::paintStaticLayer(QPainter *painter, StaticLayer layer)
 {
-    // Draw tank body
     QRectF tankRect(-35, -55, 70, 110);
-    painter->setPen(QPen(Qt::black, 3));
-    painter->setBrush(QBrush(QColor(180, 200, 220)));
-    painter->drawRect(tankRect);
-    
-    // Draw liquid level
-    double liquidHeight = (m_level / 100.0) * 100.0;
-    QRectF liquidRect(-35, 55 - liquidHeight, 70, liquidHeight);
     
-    // Color based on temperature
-    QColor liquidColor;
-    if (m_temperature < 20.0) {
-        liquidColor = QColor(100, 150, 255); // Cold - blue
-    } else if (m_temperature < 30.0) {
-        liquidColor = QColor(100, 200, 200); // Normal - cyan
-    } else {
-        liquidColor = QColor(255, 150, 100); // Hot - orange
+    if (layer == BackgroundLayer) {
+        // Draw tank body
+        painter->setPen(QPen(Qt::black, 3));
+        painter->setBrush(QBrush(QColor(180, 200, 220)));
+        painter->drawRect(tankRect);
+        paintLiquid(painter);
+        return;
     }
     
-    QLinearGradient gradient(liquidRect.topLeft(), liquidRect.bottomLeft());
-    gradient.setColorAt(0, liquidColor.lighter(120));
-    gradient.setColorAt(1, liquidColor);
-    
-    painter->setBrush(QBrush(gradient));
-    painter->setPen(Qt::NoPen);
-    painter->drawRect(liquidRect);
-    
-    // Draw level markers
-    painter->setPen(QPen(Qt::black, 1));
-    for (int i = 0; i <= 4; ++i) {
-        double y = -55 + (i * 25);
-        painter->drawLine(QPointF(-35, y), QPointF(-30, y));
-        painter->drawLine(QPointF(30, y), QPointF(35, y));
+    // Draw level markers; too short to read below full detail
+    if (detailLevel() == FullDetail) {
+        painter->setPen(QPen(Qt::black, 1));
+        for (int i = 0; i <= 4; ++i) {
+            double y = -55 + (i * 25);
+            painter->drawLine(QPointF(-35, y), QPointF(-30, y));
+            painter->drawLine(QPointF(30, y), QPointF(35, y));
+        }
     }
     
     // Draw tank outline again to cover edges
@@ -80,3 +93,44 @@ void Tank::paintComponent(QPainter *painter)
     painter->drawEllipse(QPointF(-40, 0), 5, 5);
     painter->drawEllipse(QPointF(40, 0), 5, 5);
 }
+
+int Tank::staticLayerState(StaticLayer layer) const
+{
+    // The liquid is part of the background
+    if (layer == BackgroundLayer) {
+        return (m_drawnLevel << 2) | m_drawnColorBand;
+    }
+    return 0;
+}
+
+void Tank::paintComponent(QPainter *painter)
+{
+    // The liquid is part of the background layer
+    Q_UNUSED(painter);
+}
+
+void Tank::paintLiquid(QPainter *painter)
+{
+    // Draw liquid level; the liquid is one unit tall per percent
+    double liquidHeight = m_drawnLevel;
+    QRectF liquidRect(-35, 55 - liquidHeight, 70, liquidHeight);
+    
+    // Color based on temperature; the gradient only shows at full detail
+    QColor color = bandColor(m_drawnColorBand);
+    if (detailLevel() == FullDetail) {
+        QLinearGradient gradient(liquidRect.topLeft(), liquidRect.bottomLeft());
+        gradient.setColorAt(0, color.lighter(120));
+        gradient.setColorAt(1, color);
+        painter->setBrush(QBrush(gradient));
+    } else {
+        painter->setBrush(QBrush(color));
+    }
+    
+    painter->setPen(Qt::NoPen);
+    painter->drawRect(liquidRect);
+}
+
+QColor Tank::symbolColor() const
+{
+    return bandColor(m_drawnColorBand);
+}
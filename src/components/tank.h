@@ -18,10 +18,17 @@ public:
 
 protected:
     void paintComponent(QPainter *painter) override;
+    QColor symbolColor() const override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
 
 private:
+    void paintLiquid(QPainter *painter);
+    
     double m_level;
     double m_temperature;
+    int m_drawnLevel;
+    int m_drawnColorBand;
 };
 
 #endif // TANK_H
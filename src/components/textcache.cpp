@@ -0,0 +1,106 @@
+#include "textcache.h"
+#include <QFontMetricsF>
+#include <QtMath>
+
+namespace {
+    // Entries are dropped wholesale past this; fixed labels never get close
+    const int kMaxEntries = 4096;
+    
+    // Painter scale, rounded so small zoom steps reuse the layout
+    qreal painterScale(const QPainter *painter)
+    {
+        const QTransform &transform = painter->worldTransform();
+        qreal scale = qSqrt(qAbs(transform.determinant()));
+        return qMax(0.01, qRound(scale * 8.0) / 8.0);
+    }
+}
+
+QHash<QString, QStaticText> TextCache::s_entries;
+
+const QStaticText &TextCache::line(const QString &text, const QFont &font, qreal scale)
+{
+    const QString key = font.key() + QLatin1Char('|') + QString::number(scale) + QLatin1Char('|') + text;
+    
+    auto it = s_entries.find(key);
+    if (it == s_entries.end()) {
+        if (s_entries.size() >= kMaxEntries) {
+            s_entries.clear();
+        }
+        
+        QStaticText staticText(text);
+        staticText.setTextFormat(Qt::PlainText);
+        staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+        staticText.prepare(QTransform::fromScale(scale, scale), font);
+        it = s_entries.insert(key, staticText);
+    }
+    return it.value();
+}
+
+QSizeF TextCache::size(const QString &text, const QFont &font)
+{
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    QFontMetricsF metrics(font);
+    
+    qreal width = 0.0;
+    for (const QString &lineText : lines) {
+        width = qMax(width, line(lineText, font, 1.0).size().width());
+    }
+    return QSizeF(width, metrics.lineSpacing() * lines.size());
+}
+
+void TextCache::draw(QPainter *painter, const QRectF &rect, Qt::Alignment alignment,
+                     const QString &text, const QFont &font)
+{
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    const qreal scale = painterScale(painter);
+    const qreal lineSpacing = QFontMetricsF(font).lineSpacing();
+    
+    qreal y = rect.top();
+    if (alignment & Qt::AlignVCenter) {
+        y = rect.center().y() - lineSpacing * lines.size() / 2.0;
+    } else if (alignment & Qt::AlignBottom) {
+        y = rect.bottom() - lineSpacing * lines.size();
+    }
+    
+    painter->setFont(font);
+    for (const QString &lineText : lines) {
+        const QStaticText &staticText = line(lineText, font, scale);
+        qreal width = staticText.size().width();
+        
+        qreal x = rect.left();
+        if (alignment & Qt::AlignHCenter) {
+            x = rect.center().x() - width / 2.0;
+        } else if (alignment & Qt::AlignRight) {
+            x = rect.right() - width;
+        }
+        
+        painter->drawStaticText(QPointF(x, y), staticText);
+        y += lineSpacing;
+    }
+}
+
+void TextCache::draw(QPainter *painter, const QPointF &position, const QString &text, const QFont &font)
+{
+    draw(painter, QRectF(position, QSizeF(0, 0)), Qt::AlignLeft | Qt::AlignTop, text, font);
+}
+
+qreal TextCache::drawNumber(QPainter *painter, const QPointF &position, double value, int decimals,
+                            const QString &suffix, const QFont &font)
+{
+    const qreal scale = painterScale(painter);
+    const QString digits = QString::number(value, 'f', decimals);
+    
+    painter->setFont(font);
+    QPointF pen = position;
+    for (const QChar &character : digits) {
+        const QStaticText &glyph = line(QString(character), font, scale);
+        painter->drawStaticText(pen, glyph);
+        pen.rx() += glyph.size().width();
+    }
+    if (!suffix.isEmpty()) {
+        const QStaticText &unit = line(suffix, font, scale);
+        painter->drawStaticText(pen, unit);
+        pen.rx() += unit.size().width();
+    }
+    return pen.x() - position.x();
+}
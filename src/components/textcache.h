@@ -0,0 +1,42 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <QFont>
+#include <QHash>
+#include <QPainter>
+#include <QStaticText>
+#include <QString>
+
+// Laid-out text shared by the labels and readouts painted every frame.
+// Each line is shaped once into a QStaticText keyed by string, font and
+// painter scale and drawn from the glyph cache afterwards. Numbers are
+// composed from cached single characters so live values never add
+// entries. Text inside a static layer does not use it, as the layer
+// cache already holds its pixels.
+class TextCache
+{
+public:
+    // Draws text (lines separated by '\n') aligned within rect
+    static void draw(QPainter *painter, const QRectF &rect, Qt::Alignment alignment,
+                     const QString &text, const QFont &font);
+    
+    // Draws text with its top-left corner at position
+    static void draw(QPainter *painter, const QPointF &position, const QString &text, const QFont &font);
+    
+    // Draws value with a fixed number of decimals followed by suffix,
+    // with its top-left corner at position; returns the width drawn
+    static qreal drawNumber(QPainter *painter, const QPointF &position, double value, int decimals,
+                            const QString &suffix, const QFont &font);
+    
+    static QSizeF size(const QString &text, const QFont &font);
+    
+    static int entryCount() { return s_entries.size(); }
+    static void clear() { s_entries.clear(); }
+
+private:
+    static const QStaticText &line(const QString &text, const QFont &font, qreal scale);
+    
+    static QHash<QString, QStaticText> s_entries;
+};
+
+#endif // TEXTCACHE_H
@@ -0,0 +1,55 @@
+#include "valuelabel.h"
+#include "textcache.h"
+#include <QPainter>
+#include <QtMath>
+#include <limits>
+
+namespace {
+    // Room for "-000.0 °C" style values; readouts never reflow
+    const QString kWidestValue = QStringLiteral("-0000.00");
+}
+
+ValueLabel::ValueLabel(const QString &unit, int decimals, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , m_suffix(QLatin1Char(' ') + unit)
+    , m_decimals(decimals)
+    , m_value(0.0)
+    , m_drawnValue(std::numeric_limits<qint64>::min())
+    , m_font("Arial", 7)
+{
+    QSizeF size = TextCache::size(kWidestValue + m_suffix, m_font);
+    m_boundingRect = QRectF(-2, -1, size.width() + 4, size.height() + 2);
+    setZValue(2);
+}
+
+void ValueLabel::setValue(double value)
+{
+    m_value = value;
+    
+    // NaN (a dropped-out sensor) gets its own state
+    qint64 drawn = std::isfinite(value) ? qint64(qRound64(value * qPow(10.0, m_decimals)))
+                                        : std::numeric_limits<qint64>::max();
+    if (drawn != m_drawnValue) {
+        m_drawnValue = drawn;
+        update();
+    }
+}
+
+QRectF ValueLabel::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+void ValueLabel::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    
+    painter->fillRect(m_boundingRect, QColor(255, 255, 255, 200));
+    painter->setPen(Qt::black);
+    if (std::isfinite(m_value)) {
+        TextCache::drawNumber(painter, QPointF(0, 0), m_value, m_decimals, m_suffix, m_font);
+    } else {
+        TextCache::draw(painter, QPointF(0, 0), QStringLiteral("--") + m_suffix, m_font);
+    }
+}
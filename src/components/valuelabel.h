@@ -0,0 +1,29 @@
+#ifndef VALUELABEL_H
+#define VALUELABEL_H
+
+#include <QGraphicsItem>
+#include <QFont>
+
+// Live numeric readout (e.g. "24.3 °C") composed from cached glyphs; only
+// repaints when the value as displayed changes
+class ValueLabel : public QGraphicsItem
+{
+public:
+    ValueLabel(const QString &unit, int decimals, QGraphicsItem *parent = nullptr);
+    
+    void setValue(double value);
+    double value() const { return m_value; }
+    
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    QString m_suffix;
+    int m_decimals;
+    double m_value;
+    qint64 m_drawnValue;    // value in units of the last decimal shown
+    QFont m_font;
+    QRectF m_boundingRect;
+};
+
+#endif // VALUELABEL_H
@@ -3,6 +3,11 @@
 #include <QBrush>
 #include <QtMath>
 
+namespace {
+    // Travel is drawn in 64 steps, each cached once per valve type
+    const double kPositionSteps = 64.0;
+}
+
 Valve::Valve(int valveId, ValveType type, QObject *parent)
     : BaseComponent(parent)
     , m_valveId(valveId)
@@ -10,22 +15,23 @@ Valve::Valve(int valveId, ValveType type, QObject *parent)
     , m_open(false)
     , m_position(0.0)
     , m_targetPosition(0.0)
+    , m_drawnPosition(0)
 {
     m_boundingRect = QRectF(-20, -20, 40, 40);
+    setStaticLayers(BackgroundLayer | ForegroundLayer);
 }
 
 void Valve::setOpen(bool open)
 {
-    m_open = open;
     m_targetPosition = open ? 1.0 : 0.0;
     m_isActive = true;
-    update();
+    updateIfChanged(m_open, open);
 }
 
 void Valve::setPosition(double position)
 {
     m_position = qBound(0.0, position, 1.0);
-    update();
+    updateIfChanged(m_drawnPosition, qRound(m_position * kPositionSteps));
 }
 
 void Valve::updateAnimation(double deltaTime)
@@ -38,38 +44,80 @@ void Valve::updateAnimation(double deltaTime)
         } else {
             m_position = qMax(m_position - step, m_targetPosition);
         }
-        update();
     } else {
         m_position = m_targetPosition;
         m_isActive = false;
     }
     
     BaseComponent::updateAnimation(deltaTime);
+    
+    updateIfChanged(m_drawnPosition, qRound(m_position * kPositionSteps));
 }
 
-void Valve::paintComponent(QPainter *painter)
+bool Valve::statusLed(StatusLed *led) const
 {
-    // Draw valve body (diamond shape)
-    QPolygonF valveBody;
-    valveBody << QPointF(0, -15) << QPointF(15, 0) << QPointF(0, 15) << QPointF(-15, 0);
+    led->center = QPointF(0, -18);
+    led->radius = 4;
+    led->color = m_open ? Qt::green : Qt::red;
+    return true;
+}
+
+int Valve::staticLayerState(StaticLayer layer) const
+{
+    // The gate is part of the background; a check valve's does not move
+    if (layer == BackgroundLayer) {
+        int position = m_type == CheckValve ? 0 : m_drawnPosition;
+        return (position << 3) | (m_type << 1) | (m_open ? 1 : 0);
+    }
+    return m_open ? 1 : 0;
+}
+
+void Valve::paintStaticLayer(QPainter *painter, StaticLayer layer)
+{
+    if (layer == BackgroundLayer) {
+        // Draw valve body (diamond shape)
+        QPolygonF valveBody;
+        valveBody << QPointF(0, -15) << QPointF(15, 0) << QPointF(0, 15) << QPointF(-15, 0);
+        
+        QColor bodyColor = m_open ? QColor(100, 200, 100) : QColor(200, 100, 100);
+        painter->setBrush(QBrush(bodyColor));
+        painter->setPen(QPen(Qt::black, 2));
+        painter->drawPolygon(valveBody);
+        paintGate(painter);
+        return;
+    }
     
-    QColor bodyColor = m_open ? QColor(100, 200, 100) : QColor(200, 100, 100);
-    painter->setBrush(QBrush(bodyColor));
-    painter->setPen(QPen(Qt::black, 2));
-    painter->drawPolygon(valveBody);
+    // Draw connection points
+    painter->setBrush(QBrush(Qt::darkGray));
+    painter->setPen(Qt::NoPen);
+    painter->drawEllipse(QPointF(-15, 0), 3, 3);
+    painter->drawEllipse(QPointF(15, 0), 3, 3);
     
-    // Draw valve gate/disc based on position
+    // Draw status indicator
+    drawStatusLed(painter);
+}
+
+void Valve::paintComponent(QPainter *painter)
+{
+    // The gate is part of the background layer
+    Q_UNUSED(painter);
+}
+
+void Valve::paintGate(QPainter *painter)
+{
+    // Draw valve gate/disc based on the drawn position
+    double position = m_drawnPosition / kPositionSteps;
     painter->save();
     
     if (m_type == BallValve) {
         // Ball valve - rotate indicator
-        double angle = m_position * 90.0; // 0 to 90 degrees
+        double angle = position * 90.0; // 0 to 90 degrees
         painter->rotate(angle);
         painter->setPen(QPen(Qt::black, 3));
         painter->drawLine(QPointF(-10, 0), QPointF(10, 0));
     } else if (m_type == GateValve) {
         // Gate valve - vertical movement
-        double yPos = -10.0 + (m_position * 20.0);
+        double yPos = -10.0 + (position * 20.0);
         painter->setPen(QPen(Qt::black, 4));
         painter->drawLine(QPointF(-8, yPos), QPointF(8, yPos));
     } else {
@@ -82,16 +130,4 @@ void Valve::paintComponent(QPainter *painter)
     }
     
     painter->restore();
-    
-    // Draw connection points
-    painter->setBrush(QBrush(Qt::darkGray));
-    painter->setPen(Qt::NoPen);
-    painter->drawEllipse(QPointF(-15, 0), 3, 3);
-    painter->drawEllipse(QPointF(15, 0), 3, 3);
-    
-    // Draw status indicator
-    QColor statusColor = m_open ? Qt::green : Qt::red;
-    painter->setBrush(QBrush(statusColor));
-    painter->setPen(QPen(Qt::black, 1));
-    painter->drawEllipse(QPointF(0, -18), 4, 4);
 }
@@ -13,7 +13,7 @@ public:
         GateValve,
         CheckValve
     };
-
+    
     explicit Valve(int valveId, ValveType type = BallValve, QObject *parent = nullptr);
     
     void setOpen(bool open);
@@ -23,16 +23,22 @@ public:
     double getPosition() const { return m_position; }
     
     void updateAnimation(double deltaTime) override;
+    bool statusLed(StatusLed *led) const override;
 
 protected:
     void paintComponent(QPainter *painter) override;
+    void paintStaticLayer(QPainter *painter, StaticLayer layer) override;
+    int staticLayerState(StaticLayer layer) const override;
 
 private:
+    void paintGate(QPainter *painter);
+    
     int m_valveId;
     ValveType m_type;
     bool m_open;
     double m_position;
     double m_targetPosition;
+    int m_drawnPosition;
 };
 
 #endif // VALVE_H
@@ -0,0 +1,83 @@
+#include "controlinterface.h"
+
+ModelSnapshot::ModelSnapshot()
+    : sequence(0)
+    , simulationTime(0.0)
+    , systemRunning(false)
+    , supplyTemp(0.0)
+    , supplyTempValid(true)
+    , returnTemp(0.0)
+    , flowRate(0.0)
+    , heaterPower(0.0)
+{
+    for (int i = 0; i < PumpCount; ++i) {
+        pumpStates[i] = false;
+    }
+    for (int i = 0; i < LoopCount; ++i) {
+        compressorStates[i] = false;
+        solenoidValveStates[i] = false;
+        blowerStates[i] = false;
+        blowerSpeeds[i] = 0.0;
+    }
+}
+
+ControlInterface::ControlInterface()
+    : m_middleSnapshot(2)
+    , m_backSnapshot(1)
+    , m_frontSnapshot(0)
+    , m_commandHead(0)
+    , m_commandTail(0)
+    , m_droppedCommands(0)
+{
+}
+
+void ControlInterface::publishSnapshot(const ModelSnapshot &snapshot)
+{
+    m_snapshots[m_backSnapshot] = snapshot;
+    int previous = m_middleSnapshot.exchange(m_backSnapshot | SnapshotDirty, std::memory_order_acq_rel);
+    m_backSnapshot = previous & SnapshotIndexMask;
+}
+
+bool ControlInterface::readSnapshot(ModelSnapshot *snapshot)
+{
+    bool fresh = false;
+    if (m_middleSnapshot.load(std::memory_order_acquire) & SnapshotDirty) {
+        int previous = m_middleSnapshot.exchange(m_frontSnapshot, std::memory_order_acq_rel);
+        m_frontSnapshot = previous & SnapshotIndexMask;
+        fresh = true;
+    }
+    *snapshot = m_snapshots[m_frontSnapshot];
+    return fresh;
+}
+
+bool ControlInterface::pushCommand(const ControlCommand &command)
+{
+    quint32 tail = m_commandTail.load(std::memory_order_relaxed);
+    quint32 head = m_commandHead.load(std::memory_order_acquire);
+    if (tail - head >= quint32(CommandCapacity)) {
+        m_droppedCommands.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    m_commands[tail & (CommandCapacity - 1)] = command;
+    m_commandTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool ControlInterface::popCommand(ControlCommand *command)
+{
+    quint32 head = m_commandHead.load(std::memory_order_relaxed);
+    quint32 tail = m_commandTail.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    
+    *command = m_commands[head & (CommandCapacity - 1)];
+    m_commandHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void ControlInterface::discardCommands()
+{
+    m_commandHead.store(m_commandTail.load(std::memory_order_acquire), std::memory_order_release);
+}
@@ -0,0 +1,94 @@
+#ifndef CONTROLINTERFACE_H
+#define CONTROLINTERFACE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Plain-value copy of the model state that the controller works from
+struct ModelSnapshot
+{
+    enum {
+        PumpCount = 2,
+        LoopCount = 3
+    };
+    
+    ModelSnapshot();
+    
+    quint64 sequence;
+    double simulationTime;
+    bool systemRunning;
+    
+    double supplyTemp;
+    bool supplyTempValid;       // false while the sensor has dropped out
+    double returnTemp;
+    double flowRate;
+    double heaterPower;
+    
+    bool pumpStates[PumpCount];
+    bool compressorStates[LoopCount];
+    bool solenoidValveStates[LoopCount];
+    bool blowerStates[LoopCount];
+    double blowerSpeeds[LoopCount];
+};
+
+// Actuator command sent from the controller to the model
+struct ControlCommand
+{
+    enum Type {
+        SetPump,
+        SetCompressor,
+        SetSolenoidValve,
+        SetBlower,
+        SetBlowerSpeed
+    };
+    
+    Type type;
+    int index;
+    double value;
+};
+
+// Lock-free exchange between the simulation (model side) and the
+// controller thread. Snapshots flow model -> controller through a triple
+// buffer, commands flow controller -> model through a single-producer,
+// single-consumer ring. Neither side ever blocks the other.
+class ControlInterface
+{
+public:
+    ControlInterface();
+    
+    // Model side
+    void publishSnapshot(const ModelSnapshot &snapshot);
+    bool popCommand(ControlCommand *command);
+    
+    // Drops every queued command; model side, once the controller stopped
+    void discardCommands();
+    
+    // Controller side; readSnapshot() returns true when the snapshot is new
+    bool readSnapshot(ModelSnapshot *snapshot);
+    bool pushCommand(const ControlCommand &command);
+    
+    quint64 getDroppedCommands() const { return m_droppedCommands.load(std::memory_order_relaxed); }
+
+private:
+    Q_DISABLE_COPY(ControlInterface)
+    
+    enum {
+        CommandCapacity = 256,     // power of two
+        SnapshotIndexMask = 0x3,
+        SnapshotDirty = 0x4
+    };
+    
+    // Triple buffer - the middle slot is swapped atomically
+    ModelSnapshot m_snapshots[3];
+    std::atomic<int> m_middleSnapshot;
+    int m_backSnapshot;     // owned by the model side
+    int m_frontSnapshot;    // owned by the controller side
+    
+    // Command ring
+    ControlCommand m_commands[CommandCapacity];
+    std::atomic<quint32> m_commandHead;    // next slot to read
+    std::atomic<quint32> m_commandTail;    // next slot to write
+    std::atomic<quint64> m_droppedCommands;
+};
+
+#endif // CONTROLINTERFACE_H
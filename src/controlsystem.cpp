@@ -0,0 +1,358 @@
+#include "controlsystem.h"
+#include "wakeupmonitor.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtMath>
+
+namespace {
+    const double kDefaultSetpoint = 20.0;           // °C
+    const double kDefaultRotationInterval = 86400.0; // one day of lead runtime
+    
+    // Compressor staging
+    const double kStageUpMargin = 5.0;              // % above the stage boundary
+    const double kStageDownMargin = 3.0;            // % above the lower boundary
+    const double kMinStageInterval = 30.0;          // anti short-cycle, seconds
+    
+    // Blower speed range while a loop is staged on
+    const double kMinBlowerSpeed = 30.0;
+    const double kBlowerSpeedDeadband = 1.0;
+    
+    // Lag pump assist when the cooling demand stays saturated
+    const double kLagAssistOutput = 95.0;
+    const double kLagReleaseOutput = 80.0;
+    const double kLagAssistDelay = 60.0;
+}
+
+ControlSystem::ControlSystem(ControlInterface *controlInterface, QObject *parent)
+    : QThread(parent)
+    , m_controlInterface(controlInterface)
+    , m_pid(8.0, 0.4, 0.0)
+    , m_loopRate(100)
+    , m_supplySetpoint(kDefaultSetpoint)
+    , m_rotationInterval(kDefaultRotationInterval)
+    , m_suspended(false)
+    , m_initialized(false)
+    , m_lastSimulationTime(0.0)
+    , m_lastStageChangeTime(0.0)
+    , m_leadRuntime(0.0)
+    , m_saturatedTime(0.0)
+    , m_controlOutput(0.0)
+    , m_activeStages(0)
+    , m_leadPump(0)
+{
+    m_pid.setOutputLimits(0.0, 100.0);
+    m_pid.setReverseActing(true);
+    
+    for (int i = 0; i < ModelSnapshot::PumpCount; ++i) {
+        m_commandedPumps[i] = false;
+    }
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        m_commandedLoops[i] = false;
+        m_commandedBlowerSpeeds[i] = 0.0;
+    }
+    
+    resetStatistics();
+}
+
+ControlSystem::~ControlSystem()
+{
+    stopControl();
+}
+
+void ControlSystem::startControl()
+{
+    if (!isRunning()) {
+        m_initialized = false;
+        start(QThread::HighPriority);
+    }
+}
+
+void ControlSystem::stopControl()
+{
+    if (isRunning()) {
+        requestInterruption();
+        {
+            QMutexLocker locker(&m_suspendMutex);
+            m_resumed.wakeAll();
+        }
+        wait();
+        
+        // Commands still queued must not act after control is off
+        m_controlInterface->discardCommands();
+    }
+}
+
+void ControlSystem::setSuspended(bool suspended)
+{
+    QMutexLocker locker(&m_suspendMutex);
+    m_suspended.store(suspended, std::memory_order_relaxed);
+    if (!suspended) {
+        m_resumed.wakeAll();
+    }
+}
+
+bool ControlSystem::waitWhileSuspended()
+{
+    if (!m_suspended.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    QMutexLocker locker(&m_suspendMutex);
+    while (m_suspended.load(std::memory_order_relaxed) && !isInterruptionRequested()) {
+        m_resumed.wait(&m_suspendMutex);
+    }
+    return true;
+}
+
+void ControlSystem::setLoopRate(int rate)
+{
+    m_loopRate.store(qBound(1, rate, 1000), std::memory_order_relaxed);
+}
+
+void ControlSystem::setSupplySetpoint(double temp)
+{
+    m_supplySetpoint.store(temp, std::memory_order_relaxed);
+}
+
+void ControlSystem::setLeadLagRotationInterval(double seconds)
+{
+    m_rotationInterval.store(qMax(1.0, seconds), std::memory_order_relaxed);
+}
+
+ControlSystem::LoopStatistics ControlSystem::getStatistics() const
+{
+    LoopStatistics stats;
+    stats.cycles = m_cycles.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    
+    double cycles = stats.cycles > 0 ? double(stats.cycles) : 1.0;
+    stats.jitterLastUs = m_jitterLastNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.jitterMeanUs = m_jitterTotalNs.load(std::memory_order_relaxed) / cycles / 1000.0;
+    stats.jitterMaxUs = m_jitterMaxNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.executionLastUs = m_executionLastNs.load(std::memory_order_relaxed) / 1000.0;
+    stats.executionMeanUs = m_executionTotalNs.load(std::memory_order_relaxed) / cycles / 1000.0;
+    stats.executionMaxUs = m_executionMaxNs.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void ControlSystem::resetStatistics()
+{
+    m_cycles.store(0, std::memory_order_relaxed);
+    m_overruns.store(0, std::memory_order_relaxed);
+    m_jitterLastNs.store(0, std::memory_order_relaxed);
+    m_jitterTotalNs.store(0, std::memory_order_relaxed);
+    m_jitterMaxNs.store(0, std::memory_order_relaxed);
+    m_executionLastNs.store(0, std::memory_order_relaxed);
+    m_executionTotalNs.store(0, std::memory_order_relaxed);
+    m_executionMaxNs.store(0, std::memory_order_relaxed);
+}
+
+void ControlSystem::run()
+{
+    const qint64 period = 1000000000LL / m_loopRate.load(std::memory_order_relaxed);
+    
+    QElapsedTimer clock;
+    clock.start();
+    qint64 deadline = clock.nsecsElapsed();
+    
+    ModelSnapshot snapshot;
+    const QString wakeupSource = QString::fromLatin1(metaObject()->className());
+    
+    while (!isInterruptionRequested()) {
+        if (waitWhileSuspended()) {
+            // The model may have been fast-forwarded meanwhile; start over
+            // from wherever it is rather than integrate across the gap
+            m_initialized = false;
+            deadline = clock.nsecsElapsed();
+            continue;
+        }
+        
+        qint64 wakeTime = clock.nsecsElapsed();
+        WakeupMonitor::recordWakeup(wakeupSource);
+        
+        // The model publishes at its own rate; only act on fresh snapshots
+        if (m_controlInterface->readSnapshot(&snapshot)) {
+            controlStep(snapshot);
+        }
+        
+        qint64 finishTime = clock.nsecsElapsed();
+        recordTiming(wakeTime - deadline, finishTime - wakeTime);
+        
+        deadline += period;
+        if (finishTime >= deadline) {
+            // Missed the next deadline - skip ahead instead of bursting
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            deadline = finishTime;
+            continue;
+        }
+        
+        QThread::usleep(static_cast<unsigned long>((deadline - finishTime) / 1000));
+    }
+}
+
+void ControlSystem::resetControlState(const ModelSnapshot &snapshot)
+{
+    m_pid.reset();
+    m_lastSimulationTime = snapshot.simulationTime;
+    m_lastStageChangeTime = snapshot.simulationTime - kMinStageInterval;
+    m_leadRuntime = 0.0;
+    m_saturatedTime = 0.0;
+    
+    // Start from whatever the model is currently doing
+    int stages = 0;
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        m_commandedLoops[i] = snapshot.compressorStates[i];
+        m_commandedBlowerSpeeds[i] = snapshot.blowerSpeeds[i];
+        if (snapshot.compressorStates[i]) {
+            stages++;
+        }
+    }
+    for (int i = 0; i < ModelSnapshot::PumpCount; ++i) {
+        m_commandedPumps[i] = snapshot.pumpStates[i];
+    }
+    
+    m_activeStages.store(stages, std::memory_order_relaxed);
+    m_controlOutput.store(0.0, std::memory_order_relaxed);
+    m_initialized = true;
+}
+
+void ControlSystem::controlStep(const ModelSnapshot &snapshot)
+{
+    if (!snapshot.systemRunning) {
+        m_initialized = false;
+        return;
+    }
+    
+    // A dropped-out sensor holds the outputs until readings return
+    if (!snapshot.supplyTempValid) {
+        return;
+    }
+    
+    if (!m_initialized) {
+        resetControlState(snapshot);
+        return;
+    }
+    
+    double deltaTime = snapshot.simulationTime - m_lastSimulationTime;
+    if (deltaTime <= 0.0) {
+        return;
+    }
+    m_lastSimulationTime = snapshot.simulationTime;
+    
+    double setpoint = m_supplySetpoint.load(std::memory_order_relaxed);
+    double output = m_pid.update(setpoint, snapshot.supplyTemp, deltaTime);
+    m_controlOutput.store(output, std::memory_order_relaxed);
+    
+    updateStaging(output, snapshot.simulationTime);
+    updateBlowerSpeeds(output);
+    updatePumps(output, deltaTime);
+}
+
+void ControlSystem::updateStaging(double output, double simulationTime)
+{
+    const double stageSize = 100.0 / ModelSnapshot::LoopCount;
+    int stages = m_activeStages.load(std::memory_order_relaxed);
+    int target = stages;
+    
+    if (stages < ModelSnapshot::LoopCount && output > stages * stageSize + kStageUpMargin) {
+        target = stages + 1;
+    } else if (stages > 0 && output < (stages - 1) * stageSize + kStageDownMargin) {
+        target = stages - 1;
+    }
+    
+    if (target != stages && simulationTime - m_lastStageChangeTime >= kMinStageInterval) {
+        stages = target;
+        m_lastStageChangeTime = simulationTime;
+        m_activeStages.store(stages, std::memory_order_relaxed);
+    }
+    
+    // Stage N runs refrigerant loops 0..N-1 (compressor, solenoid and blower)
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        bool on = i < stages;
+        // Latched only once all three are queued; a full queue retries
+        // the whole set on the next tick, repeats being harmless
+        if (m_commandedLoops[i] != on
+            && sendCommand(ControlCommand::SetSolenoidValve, i, on ? 1.0 : 0.0)
+            && sendCommand(ControlCommand::SetCompressor, i, on ? 1.0 : 0.0)
+            && sendCommand(ControlCommand::SetBlower, i, on ? 1.0 : 0.0)) {
+            m_commandedLoops[i] = on;
+        }
+    }
+}
+
+void ControlSystem::updateBlowerSpeeds(double output)
+{
+    const double stageSize = 100.0 / ModelSnapshot::LoopCount;
+    int stages = m_activeStages.load(std::memory_order_relaxed);
+    
+    // Blowers follow the demand within the highest active stage
+    double fraction = 0.0;
+    if (stages > 0) {
+        fraction = qBound(0.0, (output - (stages - 1) * stageSize) / stageSize, 1.0);
+    }
+    double speed = kMinBlowerSpeed + (100.0 - kMinBlowerSpeed) * fraction;
+    
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        if (m_commandedLoops[i] && qAbs(m_commandedBlowerSpeeds[i] - speed) > kBlowerSpeedDeadband
+            && sendCommand(ControlCommand::SetBlowerSpeed, i, speed)) {
+            m_commandedBlowerSpeeds[i] = speed;
+        }
+    }
+}
+
+void ControlSystem::updatePumps(double output, double deltaTime)
+{
+    int lead = m_leadPump.load(std::memory_order_relaxed);
+    int lag = (lead + 1) % ModelSnapshot::PumpCount;
+    
+    // Rotate lead and lag to even out pump wear
+    m_leadRuntime += deltaTime;
+    if (m_leadRuntime >= m_rotationInterval.load(std::memory_order_relaxed)) {
+        m_leadRuntime = 0.0;
+        qSwap(lead, lag);
+        m_leadPump.store(lead, std::memory_order_relaxed);
+    }
+    
+    // Lag assist while the cooling demand stays saturated
+    if (output >= kLagAssistOutput) {
+        m_saturatedTime += deltaTime;
+    } else if (output < kLagReleaseOutput) {
+        m_saturatedTime = 0.0;
+    }
+    bool lagOn = m_saturatedTime >= kLagAssistDelay;
+    
+    // Start before stopping so flow is never interrupted on a swap
+    if (!m_commandedPumps[lead] && sendCommand(ControlCommand::SetPump, lead, 1.0)) {
+        m_commandedPumps[lead] = true;
+    }
+    if (m_commandedPumps[lag] != lagOn && sendCommand(ControlCommand::SetPump, lag, lagOn ? 1.0 : 0.0)) {
+        m_commandedPumps[lag] = lagOn;
+    }
+}
+
+bool ControlSystem::sendCommand(ControlCommand::Type type, int index, double value)
+{
+    ControlCommand command;
+    command.type = type;
+    command.index = index;
+    command.value = value;
+    return m_controlInterface->pushCommand(command);
+}
+
+void ControlSystem::recordTiming(qint64 jitterNs, qint64 executionNs)
+{
+    jitterNs = qAbs(jitterNs);
+    
+    m_cycles.fetch_add(1, std::memory_order_relaxed);
+    m_jitterLastNs.store(jitterNs, std::memory_order_relaxed);
+    m_jitterTotalNs.fetch_add(jitterNs, std::memory_order_relaxed);
+    if (jitterNs > m_jitterMaxNs.load(std::memory_order_relaxed)) {
+        m_jitterMaxNs.store(jitterNs, std::memory_order_relaxed);
+    }
+    
+    m_executionLastNs.store(executionNs, std::memory_order_relaxed);
+    m_executionTotalNs.fetch_add(executionNs, std::memory_order_relaxed);
+    if (executionNs > m_executionMaxNs.load(std::memory_order_relaxed)) {
+        m_executionMaxNs.store(executionNs, std::memory_order_relaxed);
+    }
+}
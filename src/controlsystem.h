@@ -0,0 +1,113 @@
+#ifndef CONTROLSYSTEM_H
+#define CONTROLSYSTEM_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include "controlinterface.h"
+#include "pidcontroller.h"
+
+// Supervisory controller for the LCU. Runs a fixed-rate loop on its own
+// thread: PID on supply temperature drives compressor staging and blower
+// speed, and the coolant pumps are rotated lead/lag. All model access goes
+// through the lock-free ControlInterface.
+class ControlSystem : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct LoopStatistics {
+        quint64 cycles;
+        quint64 overruns;
+        double jitterLastUs;
+        double jitterMeanUs;
+        double jitterMaxUs;
+        double executionLastUs;
+        double executionMeanUs;
+        double executionMaxUs;
+    };
+    
+    explicit ControlSystem(ControlInterface *controlInterface, QObject *parent = nullptr);
+    ~ControlSystem();
+    
+    void startControl();
+    void stopControl();
+    
+    // While suspended the loop sleeps without waking; on resume it starts
+    // again from the model's current state. Set by the SimulationClock.
+    void setSuspended(bool suspended);
+    bool isSuspended() const { return m_suspended.load(std::memory_order_relaxed); }
+    
+    // Loop rate in Hz; takes effect on the next start
+    void setLoopRate(int rate);
+    int getLoopRate() const { return m_loopRate.load(std::memory_order_relaxed); }
+    
+    void setSupplySetpoint(double temp);
+    double getSupplySetpoint() const { return m_supplySetpoint.load(std::memory_order_relaxed); }
+    
+    // Lead pump runtime (simulation seconds) before lead and lag swap
+    void setLeadLagRotationInterval(double seconds);
+    
+    double getControlOutput() const { return m_controlOutput.load(std::memory_order_relaxed); }
+    int getActiveStages() const { return m_activeStages.load(std::memory_order_relaxed); }
+    int getLeadPump() const { return m_leadPump.load(std::memory_order_relaxed); }
+    
+    LoopStatistics getStatistics() const;
+    void resetStatistics();
+
+protected:
+    void run() override;
+
+private:
+    void resetControlState(const ModelSnapshot &snapshot);
+    void controlStep(const ModelSnapshot &snapshot);
+    void updateStaging(double output, double simulationTime);
+    void updateBlowerSpeeds(double output);
+    void updatePumps(double output, double deltaTime);
+    
+    // False when the command queue is full; the caller retries next tick
+    bool sendCommand(ControlCommand::Type type, int index, double value);
+    void recordTiming(qint64 jitterNs, qint64 executionNs);
+    
+    // Blocks while suspended; true if the loop was held
+    bool waitWhileSuspended();
+    
+    ControlInterface *m_controlInterface;
+    PidController m_pid;
+    
+    // Settings shared with the GUI thread
+    std::atomic<int> m_loopRate;
+    std::atomic<double> m_supplySetpoint;
+    std::atomic<double> m_rotationInterval;
+    std::atomic<bool> m_suspended;
+    QMutex m_suspendMutex;
+    QWaitCondition m_resumed;
+    
+    // Controller-thread state
+    bool m_initialized;
+    double m_lastSimulationTime;
+    double m_lastStageChangeTime;
+    double m_leadRuntime;
+    double m_saturatedTime;
+    bool m_commandedPumps[ModelSnapshot::PumpCount];
+    bool m_commandedLoops[ModelSnapshot::LoopCount];
+    double m_commandedBlowerSpeeds[ModelSnapshot::LoopCount];
+    
+    // Published status
+    std::atomic<double> m_controlOutput;
+    std::atomic<int> m_activeStages;
+    std::atomic<int> m_leadPump;
+    
+    // Loop timing (written by the control thread only)
+    std::atomic<quint64> m_cycles;
+    std::atomic<quint64> m_overruns;
+    std::atomic<qint64> m_jitterLastNs;
+    std::atomic<qint64> m_jitterTotalNs;
+    std::atomic<qint64> m_jitterMaxNs;
+    std::atomic<qint64> m_executionLastNs;
+    std::atomic<qint64> m_executionTotalNs;
+    std::atomic<qint64> m_executionMaxNs;
+};
+
+#endif // CONTROLSYSTEM_H
@@ -1,5 +1,47 @@
 #include "datamodel.h"
 #include <QtMath>
+#include <cmath>
+
+namespace {
+    // Default subsystem periods (seconds)
+    const double kHydraulicPeriod = 0.0;    // every tick
+    const double kThermalPeriod = 0.1;
+    const double kTankLevelPeriod = 1.0;
+    
+    // Lumped heat balance of the coolant loop
+    const double kAmbientTemp = 25.0;            // °C
+    const double kLoopHeatCapacity = 40.0;       // kJ/K
+    const double kAmbientConductance = 0.5;      // kW/K
+    const double kCoolantHeatCapacity = 4.18;    // kJ/(kg K), ~1 kg per litre
+    const double kCompressorStageCapacity = 12.0; // kW per refrigerant loop
+    
+    // Refrigerant side temperature lags
+    const double kCondenserTimeConstant = 20.0;  // seconds
+    const double kPHETimeConstant = 10.0;        // seconds
+    
+    // Coolant expansion seen at the tank
+    const double kTankReferenceTemp = 25.0;     // °C
+    const double kTankExpansionPerDegree = 0.15; // % level per °C
+    const double kTankTimeConstant = 1800.0;    // seconds
+    
+    // Closed-form response of x' = (target(t) - x) / tau over t, where the
+    // target decays as finalTarget + transient * exp(-t / transientTau)
+    double firstOrderResponse(double x0, double finalTarget, double transient,
+                              double transientTau, double tau, double t)
+    {
+        if (transient == 0.0) {
+            return finalTarget + (x0 - finalTarget) * qExp(-t / tau);
+        }
+        
+        if (qAbs(transientTau - tau) < 1e-9) {
+            return finalTarget + (x0 - finalTarget + transient * t / tau) * qExp(-t / tau);
+        }
+        
+        double forced = transientTau * transient / (transientTau - tau);
+        return finalTarget + forced * qExp(-t / transientTau)
+               + (x0 - finalTarget - forced) * qExp(-t / tau);
+    }
+}
 
 DataModel::DataModel(QObject *parent)
     : QObject(parent)
@@ -13,6 +55,11 @@ DataModel::DataModel(QObject *parent)
     , m_heaterPower(0.0)
     , m_coolingCapacity(30)
     , m_simulationTime(0.0)
+    , m_tankLevelPrevious(75.0)
+    , m_tankLevelCurrent(75.0)
+    , m_tankFillLevel(75.0)
+    , m_sensorsActive(false)
+    , m_snapshotSequence(0)
 {
     // Initialize 4 channels
     m_channelStates.resize(4);
@@ -46,6 +93,12 @@ DataModel::DataModel(QObject *parent)
         m_blowerStates[i] = false;
     }
     
+    // Blower speed applies while a blower is running
+    m_blowerSpeeds.resize(3);
+    for (int i = 0; i < 3; ++i) {
+        m_blowerSpeeds[i] = 75.0;
+    }
+    
     // Initialize 3 condensers
     m_condenserTemps.resize(3);
     for (int i = 0; i < 3; ++i) {
@@ -57,14 +110,127 @@ DataModel::DataModel(QObject *parent)
     for (int i = 0; i < 3; ++i) {
         m_pheTemps[i] = 28.0;
     }
+    
+    m_thermalCurrent.supplyTemp = m_supplyTemp;
+    m_thermalCurrent.returnTemp = m_returnTemp;
+    m_thermalCurrent.condenserTemps = m_condenserTemps;
+    m_thermalCurrent.pheTemps = m_pheTemps;
+    m_thermalPrevious = m_thermalCurrent;
+    
+    for (int i = 0; i < SensorFaultInjector::FieldCount; ++i) {
+        m_measured[i] = 0.0;
+        m_sensorValid[i] = true;
+    }
+    
+    setupScheduler();
+}
+
+void DataModel::setupScheduler()
+{
+    // Registration order is step order: the thermal and tank subsystems
+    // read the hydraulic results of the same tick.
+    m_scheduler.addSubsystem("Hydraulic", kHydraulicPeriod,
+                             [this](double time, double dt) { simulateHydraulics(time, dt); });
+    m_scheduler.addSubsystem("Thermal", kThermalPeriod,
+                             [this](double time, double dt) { simulateThermal(time, dt); });
+    m_scheduler.addSubsystem("Tank Level", kTankLevelPeriod,
+                             [this](double time, double dt) { simulateTankLevel(time, dt); });
+}
+
+double DataModel::getSubsystemPeriod(Subsystem subsystem) const
+{
+    return m_scheduler.period(subsystem);
 }
 
-void DataModel::setSystemRunning(bool running)
+void DataModel::setSubsystemPeriod(Subsystem subsystem, double period)
+{
+    m_scheduler.setPeriod(subsystem, period);
+}
+
+quint64 DataModel::getSubsystemStepCount(Subsystem subsystem) const
+{
+    return m_scheduler.stepCount(subsystem);
+}
+
+DataModel::LoopCoefficients DataModel::loopCoefficients()
+{
+    LoopCoefficients coefficients;
+    coefficients.ambientTemp = kAmbientTemp;
+    coefficients.heatCapacity = kLoopHeatCapacity;
+    coefficients.ambientConductance = kAmbientConductance;
+    coefficients.coolantHeatCapacity = kCoolantHeatCapacity;
+    return coefficients;
+}
+
+DataModelState DataModel::saveState() const
+{
+    DataModelState state;
+    state.systemRunning = m_systemRunning;
+    state.supplyTemp = m_supplyTemp;
+    state.returnTemp = m_returnTemp;
+    state.systemPressure = m_systemPressure;
+    state.returnPressure = m_returnPressure;
+    state.flowRate = m_flowRate;
+    state.tankLevel = m_tankLevel;
+    state.heaterPower = m_heaterPower;
+    state.coolingCapacity = m_coolingCapacity;
+    state.simulationTime = m_simulationTime;
+    state.channelStates = m_channelStates;
+    state.channelFlowRates = m_channelFlowRates;
+    state.pumpStates = m_pumpStates;
+    state.solenoidValves = m_solenoidValves;
+    state.compressorStates = m_compressorStates;
+    state.blowerStates = m_blowerStates;
+    state.blowerSpeeds = m_blowerSpeeds;
+    state.condenserTemps = m_condenserTemps;
+    state.pheTemps = m_pheTemps;
+    state.tankFillLevel = m_tankFillLevel;
+    return state;
+}
+
+void DataModel::restoreState(const DataModelState &state)
+{
+    m_systemRunning = state.systemRunning;
+    m_supplyTemp = state.supplyTemp;
+    m_returnTemp = state.returnTemp;
+    m_systemPressure = state.systemPressure;
+    m_returnPressure = state.returnPressure;
+    m_flowRate = state.flowRate;
+    m_tankLevel = state.tankLevel;
+    m_heaterPower = state.heaterPower;
+    m_coolingCapacity = state.coolingCapacity;
+    m_simulationTime = state.simulationTime;
+    m_channelStates = state.channelStates;
+    m_channelFlowRates = state.channelFlowRates;
+    m_pumpStates = state.pumpStates;
+    m_solenoidValves = state.solenoidValves;
+    m_compressorStates = state.compressorStates;
+    m_blowerStates = state.blowerStates;
+    m_blowerSpeeds = state.blowerSpeeds;
+    m_condenserTemps = state.condenserTemps;
+    m_pheTemps = state.pheTemps;
+    m_tankFillLevel = state.tankFillLevel;
+    
+    // Restart the multi-rate integration from the published values
+    m_thermalCurrent.supplyTemp = m_supplyTemp;
+    m_thermalCurrent.returnTemp = m_returnTemp;
+    m_thermalCurrent.condenserTemps = m_condenserTemps;
+    m_thermalCurrent.pheTemps = m_pheTemps;
+    m_thermalPrevious = m_thermalCurrent;
+    m_tankLevelPrevious = m_tankLevel;
+    m_tankLevelCurrent = m_tankLevel;
+    m_scheduler.reset(m_simulationTime);
+    
+    publishSnapshot();
+    emit dataChanged();
+}
+
+void DataModel::setSystemRunning(bool running, bool startEquipment)
 {
     if (m_systemRunning != running) {
         m_systemRunning = running;
         
-        if (running) {
+        if (running && startEquipment) {
             // Start system - turn on pumps and open some channels
             setPumpState(0, true);
             setChannelState(0, true);
@@ -72,7 +238,7 @@ void DataModel::setSystemRunning(bool running)
             setCompressorState(0, true);
             setBlowerState(0, true);
             setSolenoidValveState(0, true);
-        } else {
+        } else if (!running) {
             // Stop system
             for (int i = 0; i < m_pumpStates.size(); ++i) {
                 setPumpState(i, false);
@@ -88,6 +254,8 @@ void DataModel::setSystemRunning(bool running)
             }
         }
         
+        publishSnapshot();
+        
         emit systemStateChanged(running);
         emit dataChanged();
     }
@@ -126,6 +294,9 @@ void DataModel::setFlowRate(double rate)
 void DataModel::setTankLevel(double level)
 {
     m_tankLevel = level;
+    m_tankLevelPrevious = level;
+    m_tankLevelCurrent = level;
+    m_tankFillLevel = level;
     emit dataChanged();
 }
 
@@ -154,7 +325,7 @@ void DataModel::setChannelState(int channel, bool open)
 double DataModel::getChannelFlowRate(int channel) const
 {
     if (channel >= 0 && channel < m_channelFlowRates.size()) {
-        return m_channelFlowRates[channel];
+        return sensorValue(SensorFaultInjector::ChannelFlow + channel, m_channelFlowRates[channel]);
     }
     return 0.0;
 }
@@ -231,10 +402,26 @@ void DataModel::setBlowerState(int blower, bool running)
     }
 }
 
+double DataModel::getBlowerSpeed(int blower) const
+{
+    if (blower >= 0 && blower < m_blowerSpeeds.size()) {
+        return m_blowerSpeeds[blower];
+    }
+    return 0.0;
+}
+
+void DataModel::setBlowerSpeed(int blower, double speed)
+{
+    if (blower >= 0 && blower < m_blowerSpeeds.size()) {
+        m_blowerSpeeds[blower] = qBound(0.0, speed, 100.0);
+        emit dataChanged();
+    }
+}
+
 double DataModel::getCondenserTemp(int condenser) const
 {
     if (condenser >= 0 && condenser < m_condenserTemps.size()) {
-        return m_condenserTemps[condenser];
+        return sensorValue(SensorFaultInjector::CondenserTemp + condenser, m_condenserTemps[condenser]);
     }
     return 0.0;
 }
@@ -250,7 +437,7 @@ void DataModel::setCondenserTemp(int condenser, double temp)
 double DataModel::getPHETemp(int phe) const
 {
     if (phe >= 0 && phe < m_pheTemps.size()) {
-        return m_pheTemps[phe];
+        return sensorValue(SensorFaultInjector::PHETemp + phe, m_pheTemps[phe]);
     }
     return 0.0;
 }
@@ -281,17 +468,86 @@ void DataModel::updateSimulation(double deltaTime)
         return;
     }
     
+    applyControlCommands();
+    
     m_simulationTime += deltaTime;
     
-    simulateCoolantSystem(deltaTime);
-    simulateRefrigerantSystem(deltaTime);
-    simulateChannels(deltaTime);
+    // Each subsystem is only stepped when its own period has elapsed
+    m_scheduler.advanceTo(m_simulationTime);
+    publishInterpolatedState();
+    sampleSensors(deltaTime);
+    publishSnapshot();
+    
+    emit dataChanged();
+}
+
+void DataModel::advanceAnalytically(double deltaTime)
+{
+    if (!m_systemRunning || deltaTime <= 0.0) {
+        return;
+    }
+    
+    applyControlCommands();
+    
+    double t = deltaTime;
+    m_simulationTime += deltaTime;
+    
+    // Hydraulics are algebraic - evaluate them at the end of the interval
+    simulateHydraulics(m_simulationTime, deltaTime);
+    
+    // Coolant loop: T' = (Teq - T) / tau
+    double supplyStart = m_supplyTemp;
+    double supplyTarget = kAmbientTemp;
+    double supplyTau = kLoopHeatCapacity / kAmbientConductance;
+    double loopDelta = 0.0;
+    if (m_flowRate > 0) {
+        supplyTarget += (m_heaterPower - refrigerationCapacity()) / kAmbientConductance;
+        loopDelta = m_heaterPower / ((m_flowRate / 60.0) * kCoolantHeatCapacity);
+    }
+    double supplyTransient = supplyStart - supplyTarget;
+    
+    ThermalSample &sample = m_thermalCurrent;
+    sample.supplyTemp = firstOrderResponse(supplyStart, supplyTarget, 0.0, 1.0, supplyTau, t);
+    sample.returnTemp = sample.supplyTemp + loopDelta;
+    
+    // Refrigerant side; the PHE follows the decaying supply temperature
+    for (int i = 0; i < m_compressorStates.size(); ++i) {
+        double condenserTarget = kAmbientTemp;
+        if (m_compressorStates[i]) {
+            double airflow = m_blowerStates[i] ? m_blowerSpeeds[i] / 100.0 : 0.0;
+            condenserTarget = kAmbientTemp + 8.0 + 12.0 * (1.0 - airflow);
+            sample.pheTemps[i] = firstOrderResponse(m_pheTemps[i], supplyTarget - 5.0, supplyTransient,
+                                                    supplyTau, kPHETimeConstant, t);
+        } else {
+            sample.pheTemps[i] = firstOrderResponse(m_pheTemps[i], kAmbientTemp, 0.0, 1.0,
+                                                    kPHETimeConstant, t);
+        }
+        sample.condenserTemps[i] = firstOrderResponse(m_condenserTemps[i], condenserTarget, 0.0, 1.0,
+                                                      kCondenserTimeConstant, t);
+    }
+    
+    // Tank level tracks the mean coolant temperature through its own lag
+    double tankTarget = m_tankFillLevel
+                        + kTankExpansionPerDegree * (supplyTarget + loopDelta / 2.0 - kTankReferenceTemp);
+    double tankTransient = kTankExpansionPerDegree * supplyTransient;
+    m_tankLevelCurrent = qBound(0.0, firstOrderResponse(m_tankLevel, tankTarget, tankTransient,
+                                                        supplyTau, kTankTimeConstant, t), 100.0);
+    
+    // Restart the multi-rate integration from the new state
+    m_thermalPrevious = m_thermalCurrent;
+    m_tankLevelPrevious = m_tankLevelCurrent;
+    m_scheduler.reset(m_simulationTime);
+    publishInterpolatedState();
+    sampleSensors(deltaTime);
+    publishSnapshot();
     
     emit dataChanged();
 }
 
-void DataModel::simulateCoolantSystem(double deltaTime)
+void DataModel::simulateHydraulics(double time, double deltaTime)
 {
+    Q_UNUSED(deltaTime);
+    
     // Simulate coolant flow based on pump states
     double totalFlow = 0.0;
     for (int i = 0; i < m_pumpStates.size(); ++i) {
@@ -301,43 +557,92 @@ void DataModel::simulateCoolantSystem(double deltaTime)
     }
     m_flowRate = totalFlow;
     
-    // Simulate temperature changes with some oscillation
-    if (totalFlow > 0) {
-        m_supplyTemp = 20.0 + 3.0 * qSin(m_simulationTime * 0.5);
-        m_returnTemp = m_supplyTemp + 5.0 + 2.0 * qSin(m_simulationTime * 0.3);
-    } else {
-        m_supplyTemp = 25.0;
-        m_returnTemp = 25.0;
-    }
-    
     // Simulate pressure
-    m_systemPressure = totalFlow > 0 ? 2.5 + 0.3 * qSin(m_simulationTime * 0.7) : 0.0;
+    m_systemPressure = totalFlow > 0 ? 2.5 + 0.3 * qSin(time * 0.7) : 0.0;
     m_returnPressure = m_systemPressure * 0.8;
     
     // Heater power
     m_heaterPower = m_systemRunning ? m_coolingCapacity * 0.5 : 0.0;
+    
+    simulateChannels(time);
+}
+
+void DataModel::simulateThermal(double time, double deltaTime)
+{
+    Q_UNUSED(time);
+    
+    m_thermalPrevious = m_thermalCurrent;
+    simulateCoolantSystem(deltaTime, m_thermalCurrent);
+    simulateRefrigerantSystem(deltaTime, m_thermalCurrent);
+}
+
+void DataModel::simulateTankLevel(double time, double deltaTime)
+{
+    Q_UNUSED(time);
+    
+    // Level follows coolant expansion with a long first-order lag
+    double meanTemp = (m_supplyTemp + m_returnTemp) / 2.0;
+    double target = m_tankFillLevel + kTankExpansionPerDegree * (meanTemp - kTankReferenceTemp);
+    double blend = 1.0 - qExp(-deltaTime / kTankTimeConstant);
+    
+    m_tankLevelPrevious = m_tankLevelCurrent;
+    m_tankLevelCurrent += (qBound(0.0, target, 100.0) - m_tankLevelCurrent) * blend;
+}
+
+void DataModel::simulateCoolantSystem(double deltaTime, ThermalSample &sample)
+{
+    // Heater load against refrigeration, with some leakage to ambient
+    double ambientGain = kAmbientConductance * (kAmbientTemp - sample.supplyTemp);
+    double netPower = ambientGain;
+    if (m_flowRate > 0) {
+        netPower += m_heaterPower - refrigerationCapacity();
+    }
+    sample.supplyTemp += netPower / kLoopHeatCapacity * deltaTime;
+    
+    // Return side picks up the load across the channels
+    if (m_flowRate > 0) {
+        double capacityRate = (m_flowRate / 60.0) * kCoolantHeatCapacity; // kW/K
+        sample.returnTemp = sample.supplyTemp + m_heaterPower / capacityRate;
+    } else {
+        sample.returnTemp = sample.supplyTemp;
+    }
 }
 
-void DataModel::simulateRefrigerantSystem(double deltaTime)
+void DataModel::simulateRefrigerantSystem(double deltaTime, ThermalSample &sample)
 {
-    // Simulate condenser temperatures based on compressor states
+    double condenserBlend = 1.0 - qExp(-deltaTime / kCondenserTimeConstant);
+    double pheBlend = 1.0 - qExp(-deltaTime / kPHETimeConstant);
+    
+    // Condenser and PHE temperatures follow the compressor and blower states
     for (int i = 0; i < m_compressorStates.size(); ++i) {
+        double condenserTarget = kAmbientTemp;
+        double pheTarget = kAmbientTemp;
         if (m_compressorStates[i]) {
-            // Operating temperature
-            m_condenserTemps[i] = 35.0 + 5.0 * qSin(m_simulationTime * 0.4 + i);
-            m_pheTemps[i] = 15.0 + 3.0 * qSin(m_simulationTime * 0.6 + i);
-        } else {
-            // Ambient temperature
-            m_condenserTemps[i] = 25.0;
-            m_pheTemps[i] = 25.0;
+            double airflow = m_blowerStates[i] ? m_blowerSpeeds[i] / 100.0 : 0.0;
+            condenserTarget = kAmbientTemp + 8.0 + 12.0 * (1.0 - airflow);
+            pheTarget = sample.supplyTemp - 5.0;
         }
+        sample.condenserTemps[i] += (condenserTarget - sample.condenserTemps[i]) * condenserBlend;
+        sample.pheTemps[i] += (pheTarget - sample.pheTemps[i]) * pheBlend;
     }
 }
 
-void DataModel::simulateChannels(double deltaTime)
+double DataModel::refrigerationCapacity() const
+{
+    // Each running loop removes one stage of heat, derated by condenser airflow
+    double capacity = 0.0;
+    for (int i = 0; i < m_compressorStates.size(); ++i) {
+        if (m_compressorStates[i] && m_solenoidValves[i]) {
+            double airflow = m_blowerStates[i] ? 0.3 + 0.7 * m_blowerSpeeds[i] / 100.0 : 0.2;
+            capacity += kCompressorStageCapacity * airflow;
+        }
+    }
+    return capacity;
+}
+
+void DataModel::simulateChannels(double time)
 {
     // Simulate channel flow rates
-    double baseFlow = m_flowRate / 4.0; // Distribute flow among open channels
     int openChannels = 0;
     
     for (int i = 0; i < m_channelStates.size(); ++i) {
@@ -350,7 +655,7 @@ void DataModel::simulateChannels(double deltaTime)
         double flowPerChannel = m_flowRate / openChannels;
         for (int i = 0; i < m_channelStates.size(); ++i) {
             if (m_channelStates[i]) {
-                m_channelFlowRates[i] = flowPerChannel * (0.9 + 0.1 * qSin(m_simulationTime + i));
+                m_channelFlowRates[i] = flowPerChannel * (0.9 + 0.1 * qSin(time + i));
             } else {
                 m_channelFlowRates[i] = 0.0;
             }
@@ -361,3 +666,135 @@ void DataModel::simulateChannels(double deltaTime)
         }
     }
 }
+
+void DataModel::publishInterpolatedState()
+{
+    // Blend the slower subsystems between their last two samples so the
+    // coupling variables stay continuous at the fast tick rate
+    double thermalAlpha = m_scheduler.interpolationFactor(ThermalSubsystem);
+    const ThermalSample &a = m_thermalPrevious;
+    const ThermalSample &b = m_thermalCurrent;
+    
+    m_supplyTemp = a.supplyTemp + (b.supplyTemp - a.supplyTemp) * thermalAlpha;
+    m_returnTemp = a.returnTemp + (b.returnTemp - a.returnTemp) * thermalAlpha;
+    for (int i = 0; i < m_condenserTemps.size(); ++i) {
+        m_condenserTemps[i] = a.condenserTemps[i] + (b.condenserTemps[i] - a.condenserTemps[i]) * thermalAlpha;
+        m_pheTemps[i] = a.pheTemps[i] + (b.pheTemps[i] - a.pheTemps[i]) * thermalAlpha;
+    }
+    
+    double tankAlpha = m_scheduler.interpolationFactor(TankLevelSubsystem);
+    m_tankLevel = m_tankLevelPrevious + (m_tankLevelCurrent - m_tankLevelPrevious) * tankAlpha;
+}
+
+void DataModel::applyControlCommands()
+{
+    ControlCommand command;
+    while (m_controlInterface.popCommand(&command)) {
+        bool on = command.value > 0.5;
+        switch (command.type) {
+        case ControlCommand::SetPump:
+            setPumpState(command.index, on);
+            break;
+        case ControlCommand::SetCompressor:
+            setCompressorState(command.index, on);
+            break;
+        case ControlCommand::SetSolenoidValve:
+            setSolenoidValveState(command.index, on);
+            break;
+        case ControlCommand::SetBlower:
+            setBlowerState(command.index, on);
+            break;
+        case ControlCommand::SetBlowerSpeed:
+            setBlowerSpeed(command.index, command.value);
+            break;
+        }
+    }
+}
+
+double DataModel::getTrueValue(SensorFaultInjector::Field field) const
+{
+    double truth[SensorFaultInjector::FieldCount];
+    collectTruth(truth);
+    return (field >= 0 && field < SensorFaultInjector::FieldCount) ? truth[field] : 0.0;
+}
+
+void DataModel::collectTruth(double *truth) const
+{
+    truth[SensorFaultInjector::SupplyTemp] = m_supplyTemp;
+    truth[SensorFaultInjector::ReturnTemp] = m_returnTemp;
+    truth[SensorFaultInjector::SystemPressure] = m_systemPressure;
+    truth[SensorFaultInjector::ReturnPressure] = m_returnPressure;
+    truth[SensorFaultInjector::FlowRate] = m_flowRate;
+    truth[SensorFaultInjector::TankLevel] = m_tankLevel;
+    truth[SensorFaultInjector::HeaterPower] = m_heaterPower;
+    for (int i = 0; i < 4; ++i) {
+        truth[SensorFaultInjector::ChannelFlow + i] = m_channelFlowRates.value(i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        truth[SensorFaultInjector::CondenserTemp + i] = m_condenserTemps.value(i);
+        truth[SensorFaultInjector::PHETemp + i] = m_pheTemps.value(i);
+    }
+}
+
+bool DataModel::isSensorValid(int field) const
+{
+    if (field < 0 || field >= SensorFaultInjector::FieldCount) {
+        return false;
+    }
+    return !m_sensorsActive || m_sensorValid[field];
+}
+
+void DataModel::sampleSensors(double deltaTime)
+{
+    // Sensors are sampled once per tick, after the physics
+    bool wasActive = m_sensorsActive;
+    m_sensorsActive = m_sensorFaults.isActive();
+    if (!m_sensorsActive) {
+        return;
+    }
+    
+    double truth[SensorFaultInjector::FieldCount];
+    collectTruth(truth);
+    
+    // What the getters reported until now; the truth if the sensors just came on
+    double previous[SensorFaultInjector::FieldCount];
+    for (int i = 0; i < SensorFaultInjector::FieldCount; ++i) {
+        previous[i] = wasActive ? m_measured[i] : truth[i];
+    }
+    
+    m_sensorFaults.process(truth, m_measured, m_simulationTime, deltaTime);
+    
+    // Dropouts hold the last reading rather than leak NaN to the views
+    for (int i = 0; i < SensorFaultInjector::FieldCount; ++i) {
+        m_sensorValid[i] = !std::isnan(m_measured[i]);
+        if (!m_sensorValid[i]) {
+            m_measured[i] = previous[i];
+        }
+    }
+}
+
+void DataModel::publishSnapshot()
+{
+    ModelSnapshot snapshot;
+    snapshot.sequence = ++m_snapshotSequence;
+    snapshot.simulationTime = m_simulationTime;
+    snapshot.systemRunning = m_systemRunning;
+    // The controller sees what the sensors report
+    snapshot.supplyTemp = getSupplyTemp();
+    snapshot.supplyTempValid = isSensorValid(SensorFaultInjector::SupplyTemp);
+    snapshot.returnTemp = getReturnTemp();
+    snapshot.flowRate = getFlowRate();
+    snapshot.heaterPower = getHeaterPower();
+    
+    for (int i = 0; i < ModelSnapshot::PumpCount && i < m_pumpStates.size(); ++i) {
+        snapshot.pumpStates[i] = m_pumpStates[i];
+    }
+    for (int i = 0; i < ModelSnapshot::LoopCount && i < m_compressorStates.size(); ++i) {
+        snapshot.compressorStates[i] = m_compressorStates[i];
+        snapshot.solenoidValveStates[i] = m_solenoidValves[i];
+        snapshot.blowerStates[i] = m_blowerStates[i];
+        snapshot.blowerSpeeds[i] = m_blowerSpeeds[i];
+    }
+    
+    m_controlInterface.publishSnapshot(snapshot);
+}
@@ -3,6 +3,38 @@
 
 #include <QObject>
 #include <QVector>
+#include "multiratescheduler.h"
+#include "controlinterface.h"
+#include "sensorfaultinjector.h"
+
+// Complete plant state. The vectors are implicitly shared, so copying a
+// state is a handful of reference count bumps; the live model only pays
+// for a deep copy of a vector when it next writes to it.
+struct DataModelState
+{
+    bool systemRunning;
+    double supplyTemp;
+    double returnTemp;
+    double systemPressure;
+    double returnPressure;
+    double flowRate;
+    double tankLevel;
+    double heaterPower;
+    int coolingCapacity;
+    double simulationTime;
+    
+    QVector<bool> channelStates;
+    QVector<double> channelFlowRates;
+    QVector<bool> pumpStates;
+    QVector<bool> solenoidValves;
+    QVector<bool> compressorStates;
+    QVector<bool> blowerStates;
+    QVector<double> blowerSpeeds;
+    QVector<double> condenserTemps;
+    QVector<double> pheTemps;
+    
+    double tankFillLevel;
+};
 
 class DataModel : public QObject
 {
@@ -11,30 +43,31 @@ class DataModel : public QObject
 public:
     explicit DataModel(QObject *parent = nullptr);
     
-    // System state
+    // System state; starting brings up a default set of equipment unless
+    // told not to, for callers (scenarios) that sequence it themselves
     bool isSystemRunning() const { return m_systemRunning; }
-    void setSystemRunning(bool running);
+    void setSystemRunning(bool running, bool startEquipment = true);
     
-    // Coolant system parameters
-    double getSupplyTemp() const { return m_supplyTemp; }
+    // Coolant system parameters (as reported by the sensors)
+    double getSupplyTemp() const { return sensorValue(SensorFaultInjector::SupplyTemp, m_supplyTemp); }
     void setSupplyTemp(double temp);
     
-    double getReturnTemp() const { return m_returnTemp; }
+    double getReturnTemp() const { return sensorValue(SensorFaultInjector::ReturnTemp, m_returnTemp); }
     void setReturnTemp(double temp);
     
-    double getSystemPressure() const { return m_systemPressure; }
+    double getSystemPressure() const { return sensorValue(SensorFaultInjector::SystemPressure, m_systemPressure); }
     void setSystemPressure(double pressure);
     
-    double getReturnPressure() const { return m_returnPressure; }
+    double getReturnPressure() const { return sensorValue(SensorFaultInjector::ReturnPressure, m_returnPressure); }
     void setReturnPressure(double pressure);
     
-    double getFlowRate() const { return m_flowRate; }
+    double getFlowRate() const { return sensorValue(SensorFaultInjector::FlowRate, m_flowRate); }
     void setFlowRate(double rate);
     
-    double getTankLevel() const { return m_tankLevel; }
+    double getTankLevel() const { return sensorValue(SensorFaultInjector::TankLevel, m_tankLevel); }
     void setTankLevel(double level);
     
-    double getHeaterPower() const { return m_heaterPower; }
+    double getHeaterPower() const { return sensorValue(SensorFaultInjector::HeaterPower, m_heaterPower); }
     void setHeaterPower(double power);
     
     // Channel states (4 channels)
@@ -58,6 +91,9 @@ public:
     bool getBlowerState(int blower) const;
     void setBlowerState(int blower, bool running);
     
+    double getBlowerSpeed(int blower) const;
+    void setBlowerSpeed(int blower, double speed); // 0.0 to 100.0
+    
     double getCondenserTemp(int condenser) const;
     void setCondenserTemp(int condenser, double temp);
     
@@ -74,14 +110,76 @@ public:
     // Simulation update
     void updateSimulation(double deltaTime);
     
+    // Jumps forward in one step using the closed-form solution of the
+    // thermal and tank dynamics. Only valid while actuator states and
+    // loads stay constant over the interval.
+    void advanceAnalytically(double deltaTime);
+    double getSimulationTime() const { return m_simulationTime; }
+    
+    // Sensor layer between the simulation and its consumers. The getters
+    // above report measured values; getTrueValue() bypasses the sensors.
+    // A dropped-out sensor keeps reporting its last reading, so consumers
+    // never see NaN; isSensorValid() tells whether the reading is current.
+    SensorFaultInjector *sensorFaults() { return &m_sensorFaults; }
+    double getTrueValue(SensorFaultInjector::Field field) const;
+    bool isSensorValid(int field) const;
+    
+    // Lumped coolant loop coefficients, shared with batch simulations
+    struct LoopCoefficients {
+        double ambientTemp;           // °C
+        double heatCapacity;          // kJ/K
+        double ambientConductance;    // kW/K
+        double coolantHeatCapacity;   // kJ/(kg K)
+    };
+    static LoopCoefficients loopCoefficients();
+    double getRefrigerationCapacity() const { return refrigerationCapacity(); }
+    
+    // Copy-on-write state for forking the model (see LookAheadPredictor)
+    DataModelState saveState() const;
+    void restoreState(const DataModelState &state);
+    
+    // Multi-rate integration (subsystem step periods in seconds)
+    enum Subsystem {
+        HydraulicSubsystem = 0,
+        ThermalSubsystem,
+        TankLevelSubsystem
+    };
+    
+    double getSubsystemPeriod(Subsystem subsystem) const;
+    void setSubsystemPeriod(Subsystem subsystem, double period);
+    quint64 getSubsystemStepCount(Subsystem subsystem) const;
+    
+    // Lock-free exchange with the control thread
+    ControlInterface *controlInterface() { return &m_controlInterface; }
+
 signals:
     void dataChanged();
     void systemStateChanged(bool running);
 
 private:
-    void simulateCoolantSystem(double deltaTime);
-    void simulateRefrigerantSystem(double deltaTime);
-    void simulateChannels(double deltaTime);
+    // Sampled outputs of the thermal subsystem, interpolated between steps
+    struct ThermalSample {
+        double supplyTemp;
+        double returnTemp;
+        QVector<double> condenserTemps;
+        QVector<double> pheTemps;
+    };
+    
+    void setupScheduler();
+    void simulateHydraulics(double time, double deltaTime);
+    void simulateThermal(double time, double deltaTime);
+    void simulateTankLevel(double time, double deltaTime);
+    void simulateCoolantSystem(double deltaTime, ThermalSample &sample);
+    void simulateRefrigerantSystem(double deltaTime, ThermalSample &sample);
+    void simulateChannels(double time);
+    void publishInterpolatedState();
+    double refrigerationCapacity() const;
+    
+    void applyControlCommands();
+    void publishSnapshot();
+    void sampleSensors(double deltaTime);
+    void collectTruth(double *truth) const;
+    double sensorValue(int field, double truth) const { return m_sensorsActive ? m_measured[field] : truth; }
     
     // System state
     bool m_systemRunning;
@@ -106,6 +204,7 @@ private:
     QVector<bool> m_solenoidValves;
     QVector<bool> m_compressorStates;
     QVector<bool> m_blowerStates;
+    QVector<double> m_blowerSpeeds;
     QVector<double> m_condenserTemps;
     QVector<double> m_pheTemps;
     
@@ -114,6 +213,25 @@ private:
     
     // Simulation time
     double m_simulationTime;
+    
+    // Multi-rate integration state
+    MultiRateScheduler m_scheduler;
+    ThermalSample m_thermalPrevious;
+    ThermalSample m_thermalCurrent;
+    double m_tankLevelPrevious;
+    double m_tankLevelCurrent;
+    double m_tankFillLevel;
+    
+    // Sensor readings, valid while m_sensorsActive; dropouts hold the
+    // previous reading and clear the field's m_sensorValid
+    SensorFaultInjector m_sensorFaults;
+    double m_measured[SensorFaultInjector::FieldCount];
+    bool m_sensorValid[SensorFaultInjector::FieldCount];
+    bool m_sensorsActive;
+    
+    // Controller exchange
+    ControlInterface m_controlInterface;
+    quint64 m_snapshotSequence;
 };
 
 #endif // DATAMODEL_H
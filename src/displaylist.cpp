@@ -0,0 +1,369 @@
+#include "displaylist.h"
+#include <QPixmap>
+#include <algorithm>
+
+// Records into the owning DisplayList; every feature is claimed so that
+// QPainter hands over primitives untouched instead of emulating them
+class DisplayListEngine : public QPaintEngine
+{
+public:
+    explicit DisplayListEngine(DisplayList *list)
+        : QPaintEngine(AllFeatures)
+        , m_list(list)
+        , m_stateDirty(true)
+    {
+    }
+    
+    bool begin(QPaintDevice *) override
+    {
+        m_current = DisplayList::State();
+        m_stateDirty = true;
+        return true;
+    }
+    
+    bool end() override { return true; }
+    Type type() const override { return User; }
+    
+    void updateState(const QPaintEngineState &state) override;
+    
+    using QPaintEngine::drawEllipse;
+    using QPaintEngine::drawLines;
+    using QPaintEngine::drawPolygon;
+    using QPaintEngine::drawRects;
+    void drawPath(const QPainterPath &path) override;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) override;
+    void drawRects(const QRectF *rects, int rectCount) override;
+    void drawLines(const QLineF *lines, int lineCount) override;
+    void drawEllipse(const QRectF &rect) override;
+    void drawPixmap(const QRectF &rect, const QPixmap &pixmap, const QRectF &source) override;
+    void drawImage(const QRectF &rect, const QImage &image, const QRectF &source,
+                   Qt::ImageConversionFlags flags) override;
+    void drawTiledPixmap(const QRectF &rect, const QPixmap &pixmap, const QPointF &offset) override;
+
+private:
+    // Starts a command in the current state, or returns null when the clip
+    // hides it entirely
+    DisplayList::Command *addCommand(DisplayList::Command::Type type, const QRectF &logicalBounds, bool stroked);
+    
+    DisplayList *m_list;
+    DisplayList::State m_current;
+    bool m_stateDirty;
+};
+
+namespace {
+    // Device pixels of antialiasing around every command's bounds
+    constexpr qreal kBoundsMargin = 2.0;
+    
+    // Texture brushes convert their pixmap on first use; done while
+    // recording so replays on several threads only read it
+    void prepareTexture(const QBrush &brush)
+    {
+        if (brush.style() == Qt::TexturePattern) {
+            brush.textureImage();
+        }
+    }
+    
+    // Paths build rasterizer caches on first use, so each replay draws a
+    // private copy rather than the shared recording
+    QPainterPath detachedPath(const QPainterPath &path)
+    {
+        QPainterPath copy;
+        copy.addPath(path);
+        copy.setFillRule(path.fillRule());
+        return copy;
+    }
+}
+
+void DisplayListEngine::updateState(const QPaintEngineState &state)
+{
+    const QPaintEngine::DirtyFlags flags = state.state();
+    DisplayList::State &current = m_current;
+    
+    if (flags & DirtyTransform) {
+        current.transform = state.transform();
+    }
+    if (flags & DirtyPen) {
+        current.pen = state.pen();
+    }
+    if (flags & DirtyBrush) {
+        current.brush = state.brush();
+    }
+    if (flags & DirtyBrushOrigin) {
+        current.brushOrigin = state.brushOrigin();
+    }
+    if (flags & DirtyBackground) {
+        current.background = state.backgroundBrush();
+    }
+    if (flags & DirtyBackgroundMode) {
+        current.backgroundMode = state.backgroundMode();
+    }
+    if (flags & DirtyHints) {
+        current.hints = state.renderHints();
+    }
+    if (flags & DirtyOpacity) {
+        current.opacity = state.opacity();
+    }
+    if (flags & DirtyCompositionMode) {
+        current.compositionMode = state.compositionMode();
+    }
+    if (flags & (DirtyClipPath | DirtyClipRegion | DirtyClipEnabled)) {
+        current.clipEnabled = painter()->hasClipping();
+        current.clipPath = QPainterPath();
+        current.clipRect = QRectF();
+        current.clipBounds = QRectF();
+        if (current.clipEnabled) {
+            current.clipPath = painter()->combinedTransform().map(painter()->clipPath());
+            current.clipBounds = current.clipPath.boundingRect();
+            
+            QPainterPath rectangle;
+            rectangle.addRect(current.clipBounds);
+            if (current.clipPath == rectangle) {
+                current.clipRect = current.clipBounds;
+            }
+        }
+    }
+    m_stateDirty = true;
+}
+
+DisplayList::Command *DisplayListEngine::addCommand(DisplayList::Command::Type type, const QRectF &logicalBounds, bool stroked)
+{
+    QRectF bounds = logicalBounds;
+    qreal deviceMargin = kBoundsMargin;
+    if (stroked && m_current.pen.style() != Qt::NoPen) {
+        // Generous for miter joins and square caps
+        qreal reach = qMax<qreal>(1.0, m_current.pen.widthF()) * qMax<qreal>(1.0, m_current.pen.miterLimit());
+        if (m_current.pen.isCosmetic()) {
+            deviceMargin += reach;
+        } else {
+            bounds.adjust(-reach, -reach, reach, reach);
+        }
+    }
+    bounds = m_current.transform.mapRect(bounds).adjusted(-deviceMargin, -deviceMargin, deviceMargin, deviceMargin);
+    if (m_current.clipEnabled) {
+        bounds &= m_current.clipBounds;
+        if (bounds.isEmpty()) {
+            return nullptr;
+        }
+    }
+    
+    if (m_stateDirty) {
+        prepareTexture(m_current.brush);
+        prepareTexture(m_current.pen.brush());
+        m_list->m_states.append(m_current);
+        m_stateDirty = false;
+    }
+    
+    DisplayList::Command command;
+    command.type = type;
+    command.state = m_list->m_states.size() - 1;
+    command.bounds = bounds;
+    m_list->m_commands.append(command);
+    return &m_list->m_commands.last();
+}
+
+void DisplayListEngine::drawPath(const QPainterPath &path)
+{
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Path, path.controlPointRect(), true)) {
+        command->path = path;
+    }
+}
+
+void DisplayListEngine::drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode)
+{
+    QPolygonF polygon(pointCount);
+    std::copy(points, points + pointCount, polygon.begin());
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Polygon, polygon.boundingRect(), true)) {
+        command->polygon = polygon;
+        command->polygonMode = mode;
+    }
+}
+
+void DisplayListEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    QRectF bounds;
+    for (int i = 0; i < rectCount; ++i) {
+        bounds |= rects[i].normalized();
+    }
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Rects, bounds, true)) {
+        command->rects = QVector<QRectF>(rects, rects + rectCount);
+    }
+}
+
+void DisplayListEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    QRectF bounds;
+    for (int i = 0; i < lineCount; ++i) {
+        bounds |= QRectF(lines[i].p1(), lines[i].p2()).normalized().adjusted(0, 0, 0.001, 0.001);
+    }
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Lines, bounds, true)) {
+        command->lines = QVector<QLineF>(lines, lines + lineCount);
+    }
+}
+
+void DisplayListEngine::drawEllipse(const QRectF &rect)
+{
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Ellipse, rect.normalized(), true)) {
+        command->rect = rect;
+    }
+}
+
+void DisplayListEngine::drawPixmap(const QRectF &rect, const QPixmap &pixmap, const QRectF &source)
+{
+    // A shallow copy on raster platforms, where pixmaps are images
+    drawImage(rect, pixmap.toImage(), source, Qt::AutoColor);
+}
+
+void DisplayListEngine::drawImage(const QRectF &rect, const QImage &image, const QRectF &source,
+                                  Qt::ImageConversionFlags flags)
+{
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::Image, rect.normalized(), false)) {
+        command->rect = rect;
+        command->image = image;
+        command->source = source;
+        command->flags = flags;
+    }
+}
+
+void DisplayListEngine::drawTiledPixmap(const QRectF &rect, const QPixmap &pixmap, const QPointF &offset)
+{
+    if (DisplayList::Command *command = addCommand(DisplayList::Command::TiledImage, rect.normalized(), false)) {
+        command->rect = rect;
+        command->image = pixmap.toImage();
+        command->offset = offset;
+    }
+}
+
+DisplayList::DisplayList()
+    : m_pixelRatio(1.0)
+    , m_dpiX(96)
+    , m_dpiY(96)
+    , m_engine(new DisplayListEngine(this))
+{
+}
+
+DisplayList::~DisplayList()
+{
+    delete m_engine;
+}
+
+void DisplayList::reset(const QSize &size, const QPaintDevice *target)
+{
+    m_size = size;
+    m_pixelRatio = target->devicePixelRatioF();
+    m_dpiX = target->logicalDpiX();
+    m_dpiY = target->logicalDpiY();
+    m_states.clear();
+    m_commands.clear();
+}
+
+QPaintEngine *DisplayList::paintEngine() const
+{
+    return m_engine;
+}
+
+int DisplayList::metric(PaintDeviceMetric metric) const
+{
+    switch (metric) {
+    case PdmWidth:
+        return m_size.width();
+    case PdmHeight:
+        return m_size.height();
+    case PdmWidthMM:
+        return qRound(m_size.width() * 25.4 / m_dpiX);
+    case PdmHeightMM:
+        return qRound(m_size.height() * 25.4 / m_dpiY);
+    case PdmNumColors:
+        return 0;
+    case PdmDepth:
+        return 32;
+    case PdmDpiX:
+    case PdmPhysicalDpiX:
+        return m_dpiX;
+    case PdmDpiY:
+    case PdmPhysicalDpiY:
+        return m_dpiY;
+    case PdmDevicePixelRatio:
+        return qMax(1, qRound(m_pixelRatio));
+    case PdmDevicePixelRatioScaled:
+        return qRound(m_pixelRatio * devicePixelRatioFScale());
+    default:
+        return QPaintDevice::metric(metric);
+    }
+}
+
+void DisplayList::applyState(QPainter *painter, const State &state, const QTransform &base) const
+{
+    // The clip is in device coordinates, so it is set before the transform
+    painter->setTransform(base);
+    if (!state.clipEnabled) {
+        painter->setClipping(false);
+    } else if (!state.clipRect.isNull()) {
+        painter->setClipRect(state.clipRect);
+    } else {
+        painter->setClipPath(detachedPath(state.clipPath));
+    }
+    painter->setTransform(state.transform * base);
+    
+    painter->setPen(state.pen);
+    painter->setBrush(state.brush);
+    painter->setBrushOrigin(state.brushOrigin);
+    painter->setBackground(state.background);
+    painter->setBackgroundMode(state.backgroundMode);
+    painter->setRenderHints(painter->renderHints(), false);
+    painter->setRenderHints(state.hints);
+    painter->setOpacity(state.opacity);
+    painter->setCompositionMode(state.compositionMode);
+}
+
+void DisplayList::replay(QPainter *painter, const QVector<int> &commands) const
+{
+    painter->save();
+    const QTransform base = painter->transform();
+    int applied = -1;
+    
+    for (int index : commands) {
+        const Command &command = m_commands[index];
+        if (command.state != applied) {
+            applyState(painter, m_states[command.state], base);
+            applied = command.state;
+        }
+        
+        switch (command.type) {
+        case Command::Path:
+            painter->drawPath(detachedPath(command.path));
+            break;
+        case Command::Polygon:
+            if (command.polygonMode == QPaintEngine::PolylineMode) {
+                painter->drawPolyline(command.polygon);
+            } else {
+                painter->drawPolygon(command.polygon, command.polygonMode == QPaintEngine::WindingMode
+                                     ? Qt::WindingFill : Qt::OddEvenFill);
+            }
+            break;
+        case Command::Rects:
+            painter->drawRects(command.rects.constData(), command.rects.size());
+            break;
+        case Command::Lines:
+            painter->drawLines(command.lines.constData(), command.lines.size());
+            break;
+        case Command::Ellipse:
+            painter->drawEllipse(command.rect);
+            break;
+        case Command::Image:
+            painter->drawImage(command.rect, command.image, command.source, command.flags);
+            break;
+        case Command::TiledImage: {
+            // As a texture fill, which needs no pixmap on this thread
+            QBrush texture(command.image);
+            texture.setTransform(QTransform::fromTranslate(command.rect.x() - command.offset.x(),
+                                                           command.rect.y() - command.offset.y()));
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(texture);
+            painter->drawRect(command.rect);
+            applied = -1;
+            break;
+        }
+        }
+    }
+    painter->restore();
+}
@@ -0,0 +1,100 @@
+#ifndef DISPLAYLIST_H
+#define DISPLAYLIST_H
+
+#include <QBrush>
+#include <QImage>
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QTransform>
+#include <QVector>
+
+class DisplayListEngine;
+
+// Painter commands recorded once and replayed any number of times, from
+// any thread. Unlike a QPicture nothing is serialized: paths, brushes and
+// pixmaps (held as shallow QImage copies) are kept as they are, so pixmap
+// caches stay worth using while recording. Each command knows its device
+// bounds, so a replay can skip everything outside its target.
+class DisplayList : public QPaintDevice
+{
+public:
+    DisplayList();
+    ~DisplayList() override;
+    
+    // Drops the commands and takes the resolution of target, whose
+    // coordinates the next recording uses
+    void reset(const QSize &size, const QPaintDevice *target);
+    
+    int commandCount() const { return m_commands.size(); }
+    QRectF commandBounds(int command) const { return m_commands[command].bounds; }
+    
+    // Replays the given commands, in ascending order, through a painter
+    // whose transform maps this list's coordinates onto its target
+    void replay(QPainter *painter, const QVector<int> &commands) const;
+    
+    QPaintEngine *paintEngine() const override;
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    friend class DisplayListEngine;
+    
+    // Painter state shared by consecutive commands; the clip is kept in
+    // device coordinates, as a rectangle when it is one
+    struct State {
+        QTransform transform;
+        QPen pen;
+        QBrush brush;
+        QPointF brushOrigin;
+        QBrush background;
+        Qt::BGMode backgroundMode = Qt::TransparentMode;
+        QPainter::RenderHints hints;
+        qreal opacity = 1.0;
+        QPainter::CompositionMode compositionMode = QPainter::CompositionMode_SourceOver;
+        bool clipEnabled = false;
+        QPainterPath clipPath;
+        QRectF clipRect;
+        QRectF clipBounds;
+    };
+    
+    struct Command {
+        enum Type {
+            Path,
+            Polygon,
+            Rects,
+            Lines,
+            Ellipse,
+            Image,
+            TiledImage
+        };
+        Type type = Path;
+        int state = 0;
+        QRectF bounds;                  // device coordinates, clipped
+        QPainterPath path;
+        QPolygonF polygon;
+        QPaintEngine::PolygonDrawMode polygonMode = QPaintEngine::OddEvenMode;
+        QVector<QRectF> rects;
+        QVector<QLineF> lines;
+        QRectF rect;                    // ellipse or image target
+        QRectF source;
+        QPointF offset;                 // tiled image origin
+        QImage image;
+        Qt::ImageConversionFlags flags = Qt::AutoColor;
+    };
+    
+    void applyState(QPainter *painter, const State &state, const QTransform &base) const;
+    
+    QSize m_size;
+    qreal m_pixelRatio;
+    int m_dpiX;
+    int m_dpiY;
+    QVector<State> m_states;
+    QVector<Command> m_commands;
+    DisplayListEngine *m_engine;
+};
+
+#endif // DISPLAYLIST_H
@@ -0,0 +1,130 @@
+#include "fleetmodel.h"
+#include "datamodel.h"
+#include "xoshiro256.h"
+#include <QtMath>
+
+namespace {
+    // Background units refreshed per tick, like telemetry trickling in
+    const int kRefreshPerTick = 256;
+    
+    const int kChannelCount = 4;
+    
+    const float kWarningSupplyTemp = 24.0f;
+    const float kAlarmSupplyTemp = 28.0f;
+    const float kAlarmTankLevel = 20.0f;
+}
+
+FleetUnitStatus::Health FleetUnitStatus::health() const
+{
+    if (!running) {
+        return Stopped;
+    } else if (supplyTemp >= kAlarmSupplyTemp || tankLevel < kAlarmTankLevel) {
+        return Alarm;
+    } else if (supplyTemp >= kWarningSupplyTemp) {
+        return Warning;
+    }
+    return Normal;
+}
+
+FleetModel::FleetModel(DataModel *liveModel, QObject *parent)
+    : QObject(parent)
+    , m_liveModel(liveModel)
+    , m_time(0.0)
+    , m_nextRefresh(0)
+{
+}
+
+void FleetModel::setUnitCount(int count)
+{
+    count = qMax(1, count);
+    if (count == m_units.size()) {
+        return;
+    }
+    
+    int oldCount = m_units.size();
+    m_units.resize(count);
+    refresh(oldCount, count - oldCount);
+    m_nextRefresh = 0;
+    emit unitCountChanged(count);
+}
+
+QString FleetModel::unitName(int unit) const
+{
+    return QString("LCU %1").arg(unit + 1, 4, 10, QChar('0'));
+}
+
+void FleetModel::advance(double deltaTime)
+{
+    m_time += deltaTime;
+    
+    if (!m_units.isEmpty()) {
+        m_units[0] = liveStatus();
+    }
+    
+    // Round-robin over the rest of the fleet
+    int count = qMin(kRefreshPerTick, m_units.size() - 1);
+    for (int i = 0; i < count; ++i) {
+        m_nextRefresh = m_nextRefresh % (m_units.size() - 1) + 1;
+        m_units[m_nextRefresh] = simulatedStatus(m_nextRefresh);
+    }
+}
+
+void FleetModel::refresh(int firstUnit, int count)
+{
+    int last = qMin(firstUnit + count, m_units.size());
+    for (int unit = qMax(0, firstUnit); unit < last; ++unit) {
+        m_units[unit] = unit == 0 ? liveStatus() : simulatedStatus(unit);
+    }
+}
+
+FleetUnitStatus FleetModel::liveStatus() const
+{
+    FleetUnitStatus status;
+    status.running = m_liveModel->isSystemRunning();
+    status.pumps = 0;
+    status.channels = 0;
+    status.loops = 0;
+    for (int i = 0; i < ModelSnapshot::PumpCount; ++i) {
+        status.pumps |= m_liveModel->getPumpState(i) ? (1 << i) : 0;
+    }
+    for (int i = 0; i < kChannelCount; ++i) {
+        status.channels |= m_liveModel->getChannelState(i) ? (1 << i) : 0;
+    }
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        status.loops |= m_liveModel->getCompressorState(i) ? (1 << i) : 0;
+    }
+    status.supplyTemp = float(m_liveModel->getSupplyTemp());
+    status.returnTemp = float(m_liveModel->getReturnTemp());
+    status.tankLevel = float(m_liveModel->getTankLevel());
+    return status;
+}
+
+FleetUnitStatus FleetModel::simulatedStatus(int unit) const
+{
+    // Fixed per-unit character from the unit number, varying slowly in time
+    Xoshiro256 random(quint64(unit) * 0xD1B54A32D192ED03ULL);
+    double phase = random.uniform(0.0, 2.0 * M_PI);
+    double period = random.uniform(60.0, 300.0);
+    double load = 0.5 + 0.5 * qSin(phase + 2.0 * M_PI * m_time / period);
+    
+    FleetUnitStatus status;
+    status.running = random.uniform() > 0.05;
+    status.pumps = 0;
+    status.channels = 0;
+    status.loops = 0;
+    status.supplyTemp = 18.0f;
+    status.returnTemp = 18.0f;
+    status.tankLevel = float(random.uniform(15.0, 95.0));
+    if (!status.running) {
+        return status;
+    }
+    
+    // Lead pump always, lag pump at high load; stages follow the load
+    status.pumps = load > 0.8 ? 0x3 : (unit % 2 ? 0x2 : 0x1);
+    status.channels = quint8((1 << (1 + int(random.uniform() * kChannelCount))) - 1);
+    int stages = qMin(int(ModelSnapshot::LoopCount), 1 + int(load * ModelSnapshot::LoopCount));
+    status.loops = quint8((1 << stages) - 1);
+    status.supplyTemp = float(18.0 + random.uniform(0.0, 6.0) + 5.0 * load);
+    status.returnTemp = status.supplyTemp + float(4.0 + 2.0 * load);
+    return status;
+}
@@ -0,0 +1,64 @@
+#ifndef FLEETMODEL_H
+#define FLEETMODEL_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+
+class DataModel;
+
+// Compact status of one unit; a few bytes so 10,000 units stay cheap
+struct FleetUnitStatus
+{
+    enum Health {
+        Stopped,
+        Normal,
+        Warning,
+        Alarm
+    };
+    
+    bool running;
+    quint8 pumps;           // bit per running pump
+    quint8 channels;        // bit per open channel
+    quint8 loops;           // bit per active refrigerant loop
+    float supplyTemp;       // °C
+    float returnTemp;       // °C
+    float tankLevel;        // %
+    
+    Health health() const;
+};
+
+// Status of every unit in a fleet. Unit 0 mirrors the live DataModel; the
+// others stand in for unit telemetry and are refreshed a slice per tick,
+// so a tick costs the same for 10 units as for 10,000. Views refresh the
+// units they show through refresh().
+class FleetModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FleetModel(DataModel *liveModel, QObject *parent = nullptr);
+    
+    void setUnitCount(int count);
+    int unitCount() const { return m_units.size(); }
+    
+    const FleetUnitStatus &status(int unit) const { return m_units[unit]; }
+    QString unitName(int unit) const;
+    
+    void advance(double deltaTime);
+    void refresh(int firstUnit, int count);
+
+signals:
+    void unitCountChanged(int count);
+
+private:
+    FleetUnitStatus liveStatus() const;
+    FleetUnitStatus simulatedStatus(int unit) const;
+    
+    DataModel *m_liveModel;
+    QVector<FleetUnitStatus> m_units;
+    double m_time;
+    int m_nextRefresh;
+};
+
+#endif // FLEETMODEL_H
@@ -0,0 +1,450 @@
+#include "fleetview.h"
+#include "fleetmodel.h"
+#include "datamodel.h"
+#include "lcuscene.h"
+#include "simulationclock.h"
+#include "components/textcache.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QTimer>
+#include <QWheelEvent>
+
+namespace {
+    const int kFrameInterval = 33;          // ms
+    const int kSpacing = 6;
+    const int kHeaderHeight = 16;
+    const int kMinTileWidth = 60;
+    const int kMaxTileWidth = 480;
+    const int kMinLiveTileWidth = 160;      // narrower schematics are unreadable
+    const int kOverviewWidth = 12;
+    const int kOverviewColumns = 4;
+    const double kOverviewRefresh = 1.0;    // seconds
+    
+    // Stock schematic aspect ratio (1200 x 700)
+    const double kSchematicAspect = 700.0 / 1200.0;
+    
+    QColor healthColor(FleetUnitStatus::Health health)
+    {
+        switch (health) {
+        case FleetUnitStatus::Normal:
+            return QColor(120, 200, 120);
+        case FleetUnitStatus::Warning:
+            return QColor(240, 190, 80);
+        case FleetUnitStatus::Alarm:
+            return QColor(230, 90, 80);
+        case FleetUnitStatus::Stopped:
+            break;
+        }
+        return QColor(170, 170, 170);
+    }
+}
+
+FleetView::FleetView(FleetModel *fleet, SimulationClock *clock, QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , m_fleet(fleet)
+    , m_clock(clock)
+    , m_timer(new QTimer(this))
+    , m_lastFrameTime(0)
+    , m_tileWidth(240)
+    , m_maxLiveTiles(64)
+    , m_overviewAge(kOverviewRefresh)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    
+    m_timer->setInterval(kFrameInterval);
+    connect(m_timer, &QTimer::timeout, this, &FleetView::onTimer);
+    m_clock->attach(this);
+    connect(m_fleet, &FleetModel::unitCountChanged, this, [this]() {
+        m_overviewAge = kOverviewRefresh;
+        updateLayout();
+    });
+    
+    updateLayout();
+}
+
+FleetView::~FleetView()
+{
+    for (LiveTile *tile : m_liveTiles) {
+        m_freeTiles.append(tile);
+    }
+    for (LiveTile *tile : m_freeTiles) {
+        delete tile->scene;
+        delete tile->model;
+        delete tile;
+    }
+}
+
+void FleetView::setTileWidth(int width)
+{
+    width = qBound(kMinTileWidth, width, kMaxTileWidth);
+    if (width != m_tileWidth) {
+        // Keep the unit at the top of the view in place
+        int first = 0;
+        int last = 0;
+        visibleUnits(&first, &last);
+        
+        m_tileWidth = width;
+        m_summaryCache.clear();
+        updateLayout();
+        verticalScrollBar()->setValue((first / columnCount()) * (tileHeight() + kSpacing));
+        viewport()->update();
+    }
+}
+
+void FleetView::setMaxLiveTiles(int count)
+{
+    m_maxLiveTiles = qMax(0, count);
+    bindVisibleTiles();
+    viewport()->update();
+}
+
+FleetView::Statistics FleetView::statistics() const
+{
+    Statistics statistics = m_statistics;
+    statistics.liveTiles = m_liveTiles.size();
+    statistics.renderers = m_liveTiles.size() + m_freeTiles.size();
+    statistics.summaryPixmaps = m_summaryCache.size();
+    return statistics;
+}
+
+void FleetView::resetStatistics()
+{
+    m_statistics = Statistics();
+}
+
+void FleetView::onTimer()
+{
+    // Long stalls (dragging the window) resume without a jump, and the
+    // fleet holds still while the simulation is paused
+    qint64 currentTime = m_clock->now();
+    double deltaTime = qMin((currentTime - m_lastFrameTime) / 1000.0, 0.1);
+    m_lastFrameTime = currentTime;
+    if (!m_clock->isPaused()) {
+        advance(deltaTime);
+    }
+}
+
+void FleetView::advance(double deltaTime)
+{
+    m_fleet->advance(deltaTime);
+    
+    // Shown units are always current
+    int first = 0;
+    int last = 0;
+    visibleUnits(&first, &last);
+    m_fleet->refresh(first, last - first);
+    
+    for (LiveTile *tile : m_liveTiles) {
+        pushStatus(tile);
+        tile->scene->updateAnimations(deltaTime);
+    }
+    
+    m_overviewAge += deltaTime;
+    if (m_overviewAge >= kOverviewRefresh) {
+        rebuildOverview();
+    }
+    
+    viewport()->update();
+}
+
+int FleetView::columnCount() const
+{
+    int width = viewport()->width() - kOverviewWidth - kSpacing;
+    return qMax(1, width / (m_tileWidth + kSpacing));
+}
+
+int FleetView::tileHeight() const
+{
+    return kHeaderHeight + qRound(m_tileWidth * kSchematicAspect);
+}
+
+QRect FleetView::tileRect(int unit) const
+{
+    int columns = columnCount();
+    int x = kSpacing + (unit % columns) * (m_tileWidth + kSpacing);
+    int y = kSpacing + (unit / columns) * (tileHeight() + kSpacing) - verticalScrollBar()->value();
+    return QRect(x, y, m_tileWidth, tileHeight());
+}
+
+QRect FleetView::overviewRect() const
+{
+    return QRect(viewport()->width() - kOverviewWidth, 0, kOverviewWidth, viewport()->height());
+}
+
+void FleetView::visibleUnits(int *first, int *last) const
+{
+    int columns = columnCount();
+    int rowHeight = tileHeight() + kSpacing;
+    int top = verticalScrollBar()->value();
+    int firstRow = qMax(0, (top - kSpacing) / rowHeight);
+    int lastRow = (top + viewport()->height()) / rowHeight;
+    
+    *first = qMin(firstRow * columns, m_fleet->unitCount());
+    *last = qMin((lastRow + 1) * columns, m_fleet->unitCount());
+}
+
+void FleetView::updateLayout()
+{
+    int rows = (m_fleet->unitCount() + columnCount() - 1) / columnCount();
+    int contentHeight = kSpacing + rows * (tileHeight() + kSpacing);
+    
+    QScrollBar *scrollBar = verticalScrollBar();
+    scrollBar->setRange(0, qMax(0, contentHeight - viewport()->height()));
+    scrollBar->setPageStep(viewport()->height());
+    scrollBar->setSingleStep(tileHeight() + kSpacing);
+    
+    bindVisibleTiles();
+}
+
+void FleetView::bindVisibleTiles()
+{
+    // Live renderers for the first visible tiles, within the budget
+    int first = 0;
+    int last = 0;
+    visibleUnits(&first, &last);
+    if (m_tileWidth < kMinLiveTileWidth) {
+        last = first;
+    }
+    last = qMin(last, first + m_maxLiveTiles);
+    
+    // Release renderers of units that left the live range...
+    for (auto it = m_liveTiles.begin(); it != m_liveTiles.end();) {
+        if (it.key() < first || it.key() >= last) {
+            m_freeTiles.append(it.value());
+            it = m_liveTiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    // ...and rebind them to the units that entered it
+    for (int unit = first; unit < last; ++unit) {
+        if (m_liveTiles.contains(unit)) {
+            continue;
+        }
+        
+        LiveTile *tile = nullptr;
+        if (!m_freeTiles.isEmpty()) {
+            tile = m_freeTiles.takeLast();
+        } else {
+            tile = new LiveTile;
+            tile->model = new DataModel();
+            tile->scene = new LCUScene(tile->model);
+        }
+        tile->unit = unit;
+        m_fleet->refresh(unit, 1);
+        pushStatus(tile);
+        tile->scene->updateAnimations(0.0);
+        m_liveTiles.insert(unit, tile);
+    }
+}
+
+void FleetView::pushStatus(LiveTile *tile)
+{
+    const FleetUnitStatus &status = m_fleet->status(tile->unit);
+    DataModel *model = tile->model;
+    
+    model->setSystemRunning(status.running);
+    for (int i = 0; i < ModelSnapshot::PumpCount; ++i) {
+        model->setPumpState(i, status.pumps & (1 << i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        model->setChannelState(i, status.channels & (1 << i));
+    }
+    for (int i = 0; i < ModelSnapshot::LoopCount; ++i) {
+        bool active = status.loops & (1 << i);
+        model->setCompressorState(i, active);
+        model->setSolenoidValveState(i, active);
+        model->setBlowerState(i, active);
+        model->setBlowerSpeed(i, active ? 80.0 : 0.0);
+    }
+    model->setSupplyTemp(status.supplyTemp);
+    model->setReturnTemp(status.returnTemp);
+    model->setTankLevel(status.tankLevel);
+}
+
+void FleetView::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+    
+    QPainter painter(viewport());
+    painter.fillRect(event->rect(), palette().window());
+    
+    int first = 0;
+    int last = 0;
+    visibleUnits(&first, &last);
+    for (int unit = first; unit < last; ++unit) {
+        QRect rect = tileRect(unit);
+        if (!rect.intersects(event->rect())) {
+            continue;
+        }
+        
+        drawHeader(&painter, unit, rect);
+        LiveTile *tile = m_liveTiles.value(unit);
+        if (tile) {
+            drawLiveTile(&painter, tile, rect.adjusted(0, kHeaderHeight, 0, 0));
+        } else {
+            drawSummary(&painter, unit, rect.adjusted(0, kHeaderHeight, 0, 0));
+        }
+    }
+    
+    drawOverview(&painter);
+    
+    m_statistics.frames++;
+    m_statistics.paintNs += timer.nsecsElapsed();
+}
+
+void FleetView::drawHeader(QPainter *painter, int unit, const QRect &rect)
+{
+    static const QFont font("Arial", 7, QFont::Bold);
+    const FleetUnitStatus &status = m_fleet->status(unit);
+    
+    QRect header(rect.left(), rect.top(), rect.width(), kHeaderHeight);
+    painter->fillRect(header, healthColor(status.health()));
+    painter->setPen(Qt::black);
+    
+    // Names and values come from cached glyphs, never one entry per unit
+    QPointF position(header.left() + 4, header.top() + 2);
+    TextCache::draw(painter, position, "LCU ", font);
+    position.rx() += TextCache::size("LCU ", font).width();
+    TextCache::drawNumber(painter, position, unit + 1, 0, QString(), font);
+    if (status.running) {
+        TextCache::drawNumber(painter, QPointF(header.right() - 44, header.top() + 2),
+                              status.supplyTemp, 1, QStringLiteral(" °C"), font);
+    }
+}
+
+void FleetView::drawLiveTile(QPainter *painter, LiveTile *tile, const QRect &rect)
+{
+    painter->fillRect(rect, Qt::white);
+    painter->save();
+    painter->setClipRect(rect);
+    painter->setRenderHint(QPainter::Antialiasing);
+    tile->scene->render(painter, rect, tile->scene->sceneRect());
+    painter->restore();
+}
+
+void FleetView::drawSummary(QPainter *painter, int unit, const QRect &rect)
+{
+    const FleetUnitStatus &status = m_fleet->status(unit);
+    FleetUnitStatus::Health health = status.health();
+    
+    // The background only depends on the health, so four pixmaps serve
+    // any number of units; the indicators are a few rects on top
+    QPixmap &background = m_summaryCache[int(health)];
+    if (background.isNull()) {
+        background = QPixmap(rect.size());
+        background.fill(healthColor(health).lighter(150));
+        QPainter backgroundPainter(&background);
+        backgroundPainter.setPen(healthColor(health).darker(120));
+        backgroundPainter.drawRect(background.rect().adjusted(0, 0, -1, -1));
+    }
+    painter->drawPixmap(rect.topLeft(), background);
+    
+    // Pumps, channels and refrigerant loops as rows of indicators
+    const int size = qMax(4, rect.width() / 24);
+    auto drawRow = [&](int row, int count, quint8 bits, const QColor &on) {
+        for (int i = 0; i < count; ++i) {
+            QRect indicator(rect.left() + size + i * 2 * size, rect.top() + size + row * 2 * size, size, size);
+            painter->fillRect(indicator, (bits & (1 << i)) ? on : QColor(120, 120, 120));
+        }
+    };
+    drawRow(0, ModelSnapshot::PumpCount, status.pumps, QColor(40, 120, 220));
+    drawRow(1, 4, status.channels, QColor(40, 170, 60));
+    drawRow(2, ModelSnapshot::LoopCount, status.loops, QColor(40, 190, 220));
+}
+
+void FleetView::drawOverview(QPainter *painter)
+{
+    QRect rect = overviewRect();
+    painter->fillRect(rect, Qt::darkGray);
+    if (m_overview.isNull()) {
+        return;
+    }
+    
+    // Whole fleet squeezed into the strip, the visible window outlined
+    painter->drawImage(rect, m_overview);
+    
+    int first = 0;
+    int last = 0;
+    visibleUnits(&first, &last);
+    double scale = double(rect.height()) / qMax(1, m_fleet->unitCount());
+    painter->setPen(QPen(Qt::white, 1));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(QRectF(rect.left() + 0.5, first * scale, rect.width() - 1.0, qMax(2.0, (last - first) * scale)));
+}
+
+void FleetView::rebuildOverview()
+{
+    m_overviewAge = 0.0;
+    
+    int units = m_fleet->unitCount();
+    int rows = (units + kOverviewColumns - 1) / kOverviewColumns;
+    if (m_overview.width() != kOverviewColumns || m_overview.height() != rows) {
+        m_overview = QImage(kOverviewColumns, qMax(1, rows), QImage::Format_RGB32);
+        m_overview.fill(Qt::darkGray);
+    }
+    
+    for (int unit = 0; unit < units; ++unit) {
+        m_overview.setPixel(unit % kOverviewColumns, unit / kOverviewColumns,
+                            healthColor(m_fleet->status(unit).health()).rgb());
+    }
+}
+
+void FleetView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateLayout();
+}
+
+void FleetView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    bindVisibleTiles();
+    viewport()->update();
+}
+
+void FleetView::wheelEvent(QWheelEvent *event)
+{
+    if (event->modifiers() & Qt::ControlModifier) {
+        setTileWidth(event->angleDelta().y() > 0 ? m_tileWidth * 5 / 4 : m_tileWidth * 4 / 5);
+        event->accept();
+        return;
+    }
+    QAbstractScrollArea::wheelEvent(event);
+}
+
+void FleetView::mousePressEvent(QMouseEvent *event)
+{
+    // Clicking the overview strip jumps to that part of the fleet
+    QRect rect = overviewRect();
+    QPoint position = event->position().toPoint();
+    if (rect.contains(position)) {
+        int unit = int(double(position.y()) / qMax(1, rect.height()) * m_fleet->unitCount());
+        int row = unit / columnCount();
+        verticalScrollBar()->setValue(row * (tileHeight() + kSpacing) - viewport()->height() / 2);
+        event->accept();
+        return;
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void FleetView::showEvent(QShowEvent *event)
+{
+    QAbstractScrollArea::showEvent(event);
+    m_lastFrameTime = m_clock->now();
+    m_timer->start();
+    m_clock->setViewActive(this, true);
+}
+
+void FleetView::hideEvent(QHideEvent *event)
+{
+    QAbstractScrollArea::hideEvent(event);
+    m_timer->stop();
+    m_clock->setViewActive(this, false);
+}
@@ -0,0 +1,107 @@
+#ifndef FLEETVIEW_H
+#define FLEETVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+
+class DataModel;
+class FleetModel;
+class LCUScene;
+class SimulationClock;
+class QTimer;
+
+// Scrolling grid of small live tiles, one per unit of a FleetModel. Only
+// the visible tiles get a mini-schematic renderer (a DataModel and an
+// LCUScene); renderers scrolled out of view go back to a pool and are
+// rebound to the units scrolled in. Tiles beyond the renderer budget, or
+// too small for a schematic, draw a status summary from cached health
+// backgrounds, and a strip along the right edge shows the whole fleet
+// from an image refreshed once a second. Memory and per-frame work
+// depend on the viewport size, not on the fleet size. Frames are timed
+// on the SimulationClock, which keeps the mirrored unit's model stepping
+// while the view is shown.
+class FleetView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    struct Statistics {
+        int liveTiles = 0;          // renderers bound to visible units
+        int renderers = 0;          // renderers allocated, bound or pooled
+        int summaryPixmaps = 0;
+        quint64 frames = 0;
+        qint64 paintNs = 0;
+    };
+    
+    FleetView(FleetModel *fleet, SimulationClock *clock, QWidget *parent = nullptr);
+    ~FleetView();
+    
+    // Tile width in pixels; Ctrl+wheel zooms
+    void setTileWidth(int width);
+    int tileWidth() const { return m_tileWidth; }
+    
+    // Visible tiles rendered as live mini-schematics at most
+    void setMaxLiveTiles(int count);
+    int maxLiveTiles() const { return m_maxLiveTiles; }
+    
+    // Advances the fleet and the live tiles and schedules a repaint; called
+    // each frame while the view is shown and the clock is not paused
+    void advance(double deltaTime);
+    
+    Statistics statistics() const;
+    void resetStatistics();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    struct LiveTile {
+        DataModel *model;
+        LCUScene *scene;
+        int unit;
+    };
+    
+    void onTimer();
+    void updateLayout();
+    void bindVisibleTiles();
+    void pushStatus(LiveTile *tile);
+    
+    int columnCount() const;
+    int tileHeight() const;
+    QRect tileRect(int unit) const;
+    QRect overviewRect() const;
+    void visibleUnits(int *first, int *last) const;
+    
+    void drawHeader(QPainter *painter, int unit, const QRect &rect);
+    void drawLiveTile(QPainter *painter, LiveTile *tile, const QRect &rect);
+    void drawSummary(QPainter *painter, int unit, const QRect &rect);
+    void drawOverview(QPainter *painter);
+    void rebuildOverview();
+    
+    FleetModel *m_fleet;
+    SimulationClock *m_clock;
+    QTimer *m_timer;
+    qint64 m_lastFrameTime;
+    int m_tileWidth;
+    int m_maxLiveTiles;
+    
+    QHash<int, LiveTile*> m_liveTiles;  // by unit
+    QVector<LiveTile*> m_freeTiles;
+    
+    QHash<int, QPixmap> m_summaryCache; // by health, at the current tile size
+    QImage m_overview;                  // one pixel per unit
+    double m_overviewAge;
+    
+    Statistics m_statistics;
+};
+
+#endif // FLEETVIEW_H
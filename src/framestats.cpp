@@ -0,0 +1,110 @@
+#include "framestats.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace {
+    // One ring per stage; writers claim a slot with fetch_add, so stages
+    // recorded from more than one thread need no lock either
+    struct Ring {
+        std::atomic<quint64> written{0};
+        std::atomic<quint32> samples[FrameStats::kCapacity];
+    };
+    
+    Ring s_rings[FrameStats::StageCount];
+    std::atomic<quint64> s_counters[FrameStats::CounterCount];
+}
+
+const QVector<double> &FrameStats::histogramBounds()
+{
+    static const QVector<double> bounds = { 0.5, 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7 };
+    return bounds;
+}
+
+void FrameStats::record(Stage stage, qint64 nanoseconds)
+{
+    // Microseconds in 32 bits; an hour-long stall still fits
+    quint32 us = quint32(qBound<qint64>(0, nanoseconds / 1000, std::numeric_limits<quint32>::max()));
+    
+    Ring &ring = s_rings[stage];
+    quint64 slot = ring.written.fetch_add(1, std::memory_order_relaxed);
+    ring.samples[slot % kCapacity].store(us, std::memory_order_relaxed);
+}
+
+void FrameStats::count(Counter counter, quint64 amount)
+{
+    s_counters[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+FrameStats::Summary FrameStats::summary(Stage stage)
+{
+    const Ring &ring = s_rings[stage];
+    quint64 written = ring.written.load(std::memory_order_relaxed);
+    int count = int(qMin<quint64>(written, kCapacity));
+    
+    QVector<quint32> samples;
+    samples.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        samples.append(ring.samples[(written - 1 - i) % kCapacity].load(std::memory_order_relaxed));
+    }
+    
+    Summary summary;
+    summary.histogram.fill(0, histogramBounds().size() + 1);
+    summary.samples = count;
+    if (count == 0) {
+        return summary;
+    }
+    
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (quint32 us : samples) {
+        double ms = us / 1000.0;
+        total += ms;
+        int bucket = int(std::lower_bound(histogramBounds().begin(), histogramBounds().end(), ms)
+                         - histogramBounds().begin());
+        summary.histogram[bucket]++;
+    }
+    
+    summary.meanMs = total / count;
+    summary.p50Ms = samples[(count - 1) / 2] / 1000.0;
+    summary.p99Ms = samples[qMin(count - 1, int(count * 0.99))] / 1000.0;
+    summary.maxMs = samples.last() / 1000.0;
+    return summary;
+}
+
+quint64 FrameStats::counter(Counter counter)
+{
+    return s_counters[counter].load(std::memory_order_relaxed);
+}
+
+quint64 FrameStats::frames(Stage stage)
+{
+    return s_rings[stage].written.load(std::memory_order_relaxed);
+}
+
+QString FrameStats::stageName(Stage stage)
+{
+    switch (stage) {
+    case SimulationStep:
+        return QString("Sim step");
+    case SceneUpdate:
+        return QString("Scene update");
+    case Paint:
+        return QString("Paint");
+    case Update3D:
+        return QString("3D update");
+    case StageCount:
+        break;
+    }
+    return QString();
+}
+
+void FrameStats::reset()
+{
+    for (Ring &ring : s_rings) {
+        ring.written.store(0, std::memory_order_relaxed);
+    }
+    for (std::atomic<quint64> &counter : s_counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Per-frame durations of each stage of a frame, kept in fixed lock-free
+// rings of the latest samples. Recording is a clock read, an atomic
+// increment and a store, cheap enough to stay on all the time; sorting
+// the samples into percentiles and histograms only happens when asked.
+class FrameStats
+{
+public:
+    enum Stage {
+        SimulationStep,
+        SceneUpdate,        // LCUScene::updateAnimations
+        Paint,              // LCUView paint events
+        Update3D,           // LCUScene3D::updateAnimations
+        StageCount
+    };
+    
+    enum Counter {
+        RepaintedItems,
+        PropertyChanges3D,  // notify signals, only while someone is looking;
+                            // see LCUScene3D::setPropertyChangeCounting
+        MaterialUpdates3D,  // part recolours or look swaps
+        CounterCount
+    };
+    
+    // Samples kept per stage
+    static const int kCapacity = 1024;
+    
+    // Upper bounds of the histogram buckets in ms; the last bucket is open
+    static const QVector<double> &histogramBounds();
+    
+    struct Summary {
+        int samples = 0;
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        QVector<int> histogram;     // histogramBounds().size() + 1 buckets
+    };
+    
+    // Times the enclosing block as one sample of a stage
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage) : m_stage(stage) { m_timer.start(); }
+        ~Scope() { record(m_stage, m_timer.nsecsElapsed()); }
+    
+    private:
+        Stage m_stage;
+        QElapsedTimer m_timer;
+    };
+    
+    static void record(Stage stage, qint64 nanoseconds);
+    static void count(Counter counter, quint64 amount = 1);
+    
+    // Latest samples of a stage, and running counter totals
+    static Summary summary(Stage stage);
+    static quint64 counter(Counter counter);
+    static quint64 frames(Stage stage);
+    
+    static QString stageName(Stage stage);
+    static void reset();
+};
+
+#endif // FRAMESTATS_H
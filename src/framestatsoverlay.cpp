@@ -0,0 +1,132 @@
+#include "framestatsoverlay.h"
+#include <QPainter>
+#include <QTimer>
+
+namespace {
+    const int kRefreshInterval = 500;   // ms
+    const int kRowHeight = 34;
+    const int kHeaderHeight = 40;
+    const int kWidth = 330;
+    const int kMargin = 8;
+    const int kHistogramWidth = 90;
+    
+    QFont overlayFont()
+    {
+        QFont font("monospace", 8);
+        font.setStyleHint(QFont::TypeWriter);
+        return font;
+    }
+}
+
+FrameStatsOverlay::FrameStatsOverlay(QWidget *parent)
+    : QWidget(parent, Qt::Tool | Qt::FramelessWindowHint | Qt::WindowDoesNotAcceptFocus
+                      | Qt::WindowTransparentForInput)
+    , m_timer(new QTimer(this))
+    , m_lastPaints(0)
+    , m_itemsPerPaint(0.0)
+    , m_propertyChangesPerSecond(0.0)
+{
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setWindowTitle("Frame Timing");
+    resize(sizeHint());
+    
+    for (quint64 &counter : m_lastCounters) {
+        counter = 0;
+    }
+    
+    m_timer->setInterval(kRefreshInterval);
+    connect(m_timer, &QTimer::timeout, this, &FrameStatsOverlay::refresh);
+}
+
+QSize FrameStatsOverlay::sizeHint() const
+{
+    return QSize(kWidth, kHeaderHeight + FrameStats::StageCount * kRowHeight + kMargin);
+}
+
+void FrameStatsOverlay::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_timer->start();
+}
+
+void FrameStatsOverlay::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_timer->stop();
+}
+
+void FrameStatsOverlay::refresh()
+{
+    for (int stage = 0; stage < FrameStats::StageCount; ++stage) {
+        m_summaries[stage] = FrameStats::summary(FrameStats::Stage(stage));
+    }
+    
+    // Counters are running totals; show their rate since the last refresh
+    quint64 items = FrameStats::counter(FrameStats::RepaintedItems);
+    quint64 changes = FrameStats::counter(FrameStats::PropertyChanges3D);
+    quint64 paints = FrameStats::frames(FrameStats::Paint);
+    double seconds = m_interval.isValid() ? m_interval.restart() / 1000.0 : 0.0;
+    if (!m_interval.isValid()) {
+        m_interval.start();
+    }
+    
+    quint64 newPaints = paints - m_lastPaints;
+    m_itemsPerPaint = newPaints > 0 ? double(items - m_lastCounters[FrameStats::RepaintedItems]) / newPaints : 0.0;
+    m_propertyChangesPerSecond = seconds > 0.0
+                                 ? (changes - m_lastCounters[FrameStats::PropertyChanges3D]) / seconds : 0.0;
+    
+    m_lastCounters[FrameStats::RepaintedItems] = items;
+    m_lastCounters[FrameStats::PropertyChanges3D] = changes;
+    m_lastPaints = paints;
+    
+    update();
+}
+
+void FrameStatsOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(40, 40, 40));
+    painter.setFont(overlayFont());
+    painter.setPen(Qt::white);
+    
+    // Changes twice a second at most, so plain drawText is fine here
+    auto drawLine = [&](int top, const QString &text) {
+        painter.drawText(QRect(kMargin, top, kWidth - 2 * kMargin, 14), Qt::AlignLeft | Qt::AlignTop, text);
+    };
+    
+    drawLine(kMargin, QString("Items/paint %1  3D changes/s %2")
+                          .arg(m_itemsPerPaint, 0, 'f', 1)
+                          .arg(m_propertyChangesPerSecond, 0, 'f', 0));
+    drawLine(kMargin + 14, QString("%1 %2 %3 %4").arg("ms", -12).arg("P50", 6).arg("P99", 6).arg("max", 6));
+    
+    const QVector<double> &bounds = FrameStats::histogramBounds();
+    for (int stage = 0; stage < FrameStats::StageCount; ++stage) {
+        const FrameStats::Summary &summary = m_summaries[stage];
+        int top = kHeaderHeight + stage * kRowHeight;
+        
+        drawLine(top, QString("%1 %2 %3 %4")
+                          .arg(FrameStats::stageName(FrameStats::Stage(stage)), -12)
+                          .arg(summary.p50Ms, 6, 'f', 2)
+                          .arg(summary.p99Ms, 6, 'f', 2)
+                          .arg(summary.maxMs, 6, 'f', 1));
+        drawLine(top + 14, QString("%1 frames, mean %2").arg(summary.samples).arg(summary.meanMs, 0, 'f', 2));
+        
+        // Histogram of the kept samples; bars past a 60 Hz frame turn red
+        if (summary.samples == 0) {
+            continue;
+        }
+        int buckets = summary.histogram.size();
+        double barWidth = double(kHistogramWidth) / buckets;
+        QRectF area(kWidth - kMargin - kHistogramWidth, top, kHistogramWidth, kRowHeight - 6);
+        painter.fillRect(area, QColor(60, 60, 60));
+        for (int bucket = 0; bucket < buckets; ++bucket) {
+            double height = area.height() * summary.histogram[bucket] / summary.samples;
+            bool slow = bucket > 0 && bounds[bucket - 1] >= 16.7;
+            painter.fillRect(QRectF(area.left() + bucket * barWidth, area.bottom() - height, barWidth - 1, height),
+                             slow ? QColor(230, 90, 80) : QColor(120, 200, 120));
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef FRAMESTATSOVERLAY_H
+#define FRAMESTATSOVERLAY_H
+
+#include <QElapsedTimer>
+#include <QWidget>
+#include "framestats.h"
+
+class QTimer;
+
+// Small always-on-top panel with a histogram and P50/P99/max per frame
+// stage, plus repainted items per paint and Qt3D property changes per
+// second. A frameless tool window, so it also shows over the native 3D
+// view; it refreshes twice a second and only while shown.
+class FrameStatsOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FrameStatsOverlay(QWidget *parent = nullptr);
+    
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    
+    QTimer *m_timer;
+    FrameStats::Summary m_summaries[FrameStats::StageCount];
+    
+    // Counter rates over the last refresh interval
+    QElapsedTimer m_interval;
+    quint64 m_lastCounters[FrameStats::CounterCount];
+    quint64 m_lastPaints;
+    double m_itemsPerPaint;
+    double m_propertyChangesPerSecond;
+};
+
+#endif // FRAMESTATSOVERLAY_H
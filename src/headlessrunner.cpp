@@ -0,0 +1,138 @@
+#include "headlessrunner.h"
+#include "datamodel.h"
+#include "scenarioengine.h"
+#include "montecarloanalysis.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+namespace {
+    void runMonteCarlo(const DataModel &model, const QCommandLineParser &parser, QTextStream &out)
+    {
+        MonteCarloConfig config;
+        config.replicas = parser.value("monte-carlo").toInt();
+        config.horizon = parser.value("horizon").toDouble();
+        config.seed = parser.value("seed").toULongLong();
+        
+        MonteCarloAnalysis analysis(config);
+        MonteCarloResult result = analysis.run(model);
+        
+        out << Qt::endl;
+        out << QString("Monte Carlo: %1 replicas over %2 s").arg(result.replicas).arg(result.horizon) << Qt::endl;
+        out << "    time   supply P05   supply P50   supply P95   return P95" << Qt::endl;
+        
+        // About a dozen rows regardless of the horizon
+        int stride = qMax(1, result.sampleTimes.size() / 12);
+        for (int i = 0; i < result.sampleTimes.size(); i += stride) {
+            out << QString("%1 s %2 %3 %4 %5")
+                       .arg(result.sampleTimes[i], 6, 'f', 0)
+                       .arg(result.supplyP05[i], 12, 'f', 2)
+                       .arg(result.supplyP50[i], 12, 'f', 2)
+                       .arg(result.supplyP95[i], 12, 'f', 2)
+                       .arg(result.returnP95[i], 12, 'f', 2) << Qt::endl;
+        }
+        
+        out << QString("P95 of peak supply: %1 °C").arg(result.peakSupplyP95, 0, 'f', 2) << Qt::endl;
+        out << QString("%1 ms, %2 replica-seconds per second")
+                   .arg(result.wallTimeMs).arg(result.replicaSecondsPerSecond, 0, 'f', 0) << Qt::endl;
+    }
+}
+
+int runHeadlessScenario(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Liquid Cooling Unit Simulator - headless scenario runner");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("headless", "Run without a GUI."));
+    parser.addOption(QCommandLineOption("scenario", "Scenario name to run.", "name"));
+    parser.addOption(QCommandLineOption("scenario-file", "Scenario file (default: test_data.json).", "path"));
+    parser.addOption(QCommandLineOption("max-step", "Largest integration step in seconds.", "seconds", "0.1"));
+    parser.addOption(QCommandLineOption("no-jump", "Integrate step by step instead of jumping analytically."));
+    parser.addOption(QCommandLineOption("list", "List the scenarios and exit."));
+    parser.addOption(QCommandLineOption("monte-carlo", "Run a Monte Carlo analysis with this many replicas "
+                                        "(after the scenario, if one is given).", "replicas"));
+    parser.addOption(QCommandLineOption("horizon", "Monte Carlo horizon in seconds.", "seconds", "600"));
+    parser.addOption(QCommandLineOption("seed", "Monte Carlo random seed.", "seed", "1"));
+    parser.process(arguments);
+    
+    QString fileName = parser.value("scenario-file");
+    if (fileName.isEmpty()) {
+        fileName = ScenarioEngine::defaultScenarioFile();
+    }
+    
+    QString error;
+    const QVector<ScenarioDefinition> scenarios = ScenarioEngine::loadScenarioFile(fileName, &error);
+    if (scenarios.isEmpty()) {
+        err << (error.isEmpty() ? QString("No scenarios found in %1").arg(fileName) : error) << Qt::endl;
+        return 1;
+    }
+    
+    // Monte Carlo from a freshly started unit
+    if (parser.isSet("monte-carlo") && !parser.isSet("scenario") && !parser.isSet("list")) {
+        DataModel model;
+        model.setSystemRunning(true);
+        model.updateSimulation(0.1);    // settle flows and heater power
+        runMonteCarlo(model, parser, out);
+        return 0;
+    }
+    
+    if (parser.isSet("list") || !parser.isSet("scenario")) {
+        for (const ScenarioDefinition &scenario : scenarios) {
+            out << scenario.name << " (" << scenario.duration << " s)" << Qt::endl;
+        }
+        return parser.isSet("list") ? 0 : 1;
+    }
+    
+    const QString name = parser.value("scenario");
+    const ScenarioDefinition *selected = nullptr;
+    for (const ScenarioDefinition &scenario : scenarios) {
+        if (scenario.name.compare(name, Qt::CaseInsensitive) == 0) {
+            selected = &scenario;
+            break;
+        }
+    }
+    if (!selected) {
+        err << "Unknown scenario: " << name << Qt::endl;
+        return 1;
+    }
+    
+    DataModel model;
+    ScenarioEngine engine(&model);
+    engine.setAnalyticJumps(!parser.isSet("no-jump"));
+    
+    QObject::connect(&engine, &ScenarioEngine::eventApplied,
+                     [&out](const QString &description, double time) {
+                         out << QString("%1 s").arg(time, 9, 'f', 3) << "  " << description << Qt::endl;
+                     });
+    
+    if (!engine.start(*selected, &error)) {
+        err << error << Qt::endl;
+        return 1;
+    }
+    
+    out << "Scenario: " << selected->name << Qt::endl;
+    
+    QElapsedTimer wallClock;
+    wallClock.start();
+    engine.runHeadless(qMax(1e-3, parser.value("max-step").toDouble()));
+    qint64 wallTime = wallClock.elapsed();
+    
+    out << Qt::endl;
+    out << QString("Simulated %1 s in %2 ms (%3 model steps)")
+               .arg(selected->duration).arg(wallTime).arg(engine.getModelSteps()) << Qt::endl;
+    out << QString("Supply %1 °C, return %2 °C, flow %3 LPM, pressure %4 bar, tank %5 %")
+               .arg(model.getSupplyTemp(), 0, 'f', 2)
+               .arg(model.getReturnTemp(), 0, 'f', 2)
+               .arg(model.getFlowRate(), 0, 'f', 1)
+               .arg(model.getSystemPressure(), 0, 'f', 2)
+               .arg(model.getTankLevel(), 0, 'f', 1) << Qt::endl;
+    
+    if (parser.isSet("monte-carlo")) {
+        runMonteCarlo(model, parser, out);
+    }
+    
+    return 0;
+}
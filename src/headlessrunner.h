@@ -0,0 +1,10 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QStringList>
+
+// Runs a scenario from test_data.json without a GUI and prints the event
+// timeline and final state. Returns the process exit code.
+int runHeadlessScenario(const QStringList &arguments);
+
+#endif // HEADLESSRUNNER_H
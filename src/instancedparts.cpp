@@ -0,0 +1,177 @@
+#include "instancedparts.h"
+#include <Qt3DCore/QAttribute>
+#include <Qt3DCore/QBuffer>
+#include <Qt3DCore/QGeometry>
+#include <Qt3DRender/QBoundingVolume>
+#include <Qt3DRender/QEffect>
+#include <Qt3DRender/QFilterKey>
+#include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QGraphicsApiFilter>
+#include <Qt3DRender/QMaterial>
+#include <Qt3DRender/QRenderPass>
+#include <Qt3DRender/QShaderProgram>
+#include <Qt3DRender/QTechnique>
+#include <QUrl>
+#include <cstring>
+#include <limits>
+
+namespace {
+    // A technique per backend; both pick up the forward renderer's filter
+    Qt3DRender::QTechnique *instancedTechnique(Qt3DRender::QGraphicsApiFilter::Api api, int major, int minor,
+                                               const QString &shaderName)
+    {
+        Qt3DRender::QTechnique *technique = new Qt3DRender::QTechnique();
+        technique->graphicsApiFilter()->setApi(api);
+        technique->graphicsApiFilter()->setMajorVersion(major);
+        technique->graphicsApiFilter()->setMinorVersion(minor);
+        if (api == Qt3DRender::QGraphicsApiFilter::OpenGL) {
+            technique->graphicsApiFilter()->setProfile(Qt3DRender::QGraphicsApiFilter::CoreProfile);
+        }
+        
+        Qt3DRender::QFilterKey *filterKey = new Qt3DRender::QFilterKey(technique);
+        filterKey->setName(QStringLiteral("renderingStyle"));
+        filterKey->setValue(QStringLiteral("forward"));
+        technique->addFilterKey(filterKey);
+        
+        Qt3DRender::QShaderProgram *program = new Qt3DRender::QShaderProgram(technique);
+        program->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(
+            QUrl(QString("qrc:/shaders/%1.vert").arg(shaderName))));
+        program->setFragmentShaderCode(Qt3DRender::QShaderProgram::loadSource(
+            QUrl(QString("qrc:/shaders/%1.frag").arg(shaderName))));
+        
+        Qt3DRender::QRenderPass *pass = new Qt3DRender::QRenderPass(technique);
+        pass->setShaderProgram(program);
+        technique->addRenderPass(pass);
+        return technique;
+    }
+    
+    Qt3DCore::QAttribute *instanceAttribute(Qt3DCore::QBuffer *buffer, const QString &name, int offset)
+    {
+        Qt3DCore::QAttribute *attribute = new Qt3DCore::QAttribute();
+        attribute->setName(name);
+        attribute->setAttributeType(Qt3DCore::QAttribute::VertexAttribute);
+        attribute->setVertexBaseType(Qt3DCore::QAttribute::Float);
+        attribute->setVertexSize(4);
+        attribute->setBuffer(buffer);
+        attribute->setByteStride(20 * sizeof(float));
+        attribute->setByteOffset(offset * sizeof(float));
+        attribute->setDivisor(1);
+        return attribute;
+    }
+}
+
+InstancedParts::InstancedParts(Qt3DCore::QGeometry *geometry, Qt3DRender::QMaterial *material,
+                               Qt3DCore::QNode *parent)
+    : Qt3DCore::QEntity(parent)
+    , m_geometry(geometry)
+    , m_uploadedCount(0)
+    , m_dirtyFirst(-1)
+    , m_dirtyLast(-1)
+{
+    m_geometry->setParent(this);
+    m_buffer = new Qt3DCore::QBuffer(m_geometry);
+    m_geometry->addAttribute(instanceAttribute(m_buffer, QStringLiteral("instanceColumn0"), 0));
+    m_geometry->addAttribute(instanceAttribute(m_buffer, QStringLiteral("instanceColumn1"), 4));
+    m_geometry->addAttribute(instanceAttribute(m_buffer, QStringLiteral("instanceColumn2"), 8));
+    m_geometry->addAttribute(instanceAttribute(m_buffer, QStringLiteral("instanceColumn3"), 12));
+    m_geometry->addAttribute(instanceAttribute(m_buffer, QStringLiteral("instanceColor"), 16));
+    
+    m_renderer = new Qt3DRender::QGeometryRenderer(this);
+    m_renderer->setGeometry(m_geometry);
+    m_renderer->setInstanceCount(0);
+    
+    // The primitive's own bounds would cull every copy away from the origin
+    m_boundingVolume = new Qt3DRender::QBoundingVolume(this);
+    
+    addComponent(m_renderer);
+    addComponent(material);
+    addComponent(m_boundingVolume);
+    setEnabled(false);
+}
+
+Qt3DRender::QMaterial *InstancedParts::createMaterial(Qt3DCore::QNode *parent)
+{
+    Qt3DRender::QEffect *effect = new Qt3DRender::QEffect();
+    effect->addTechnique(instancedTechnique(Qt3DRender::QGraphicsApiFilter::RHI, 1, 0,
+                                            QStringLiteral("instanced_rhi")));
+    effect->addTechnique(instancedTechnique(Qt3DRender::QGraphicsApiFilter::OpenGL, 3, 2,
+                                            QStringLiteral("instanced")));
+    
+    Qt3DRender::QMaterial *material = new Qt3DRender::QMaterial(parent);
+    material->setEffect(effect);
+    return material;
+}
+
+int InstancedParts::addInstance(const QMatrix4x4 &transform, const QColor &color)
+{
+    int instance = instanceCount();
+    m_data.resize(m_data.size() + kFloatsPerInstance);
+    setTransform(instance, transform);
+    setColor(instance, color);
+    return instance;
+}
+
+void InstancedParts::setTransform(int instance, const QMatrix4x4 &transform)
+{
+    // QMatrix4x4 stores its columns contiguously
+    std::memcpy(m_data.data() + instance * kFloatsPerInstance, transform.constData(), 16 * sizeof(float));
+    markDirty(instance);
+}
+
+void InstancedParts::setColor(int instance, const QColor &color)
+{
+    float *data = m_data.data() + instance * kFloatsPerInstance + 16;
+    data[0] = color.redF();
+    data[1] = color.greenF();
+    data[2] = color.blueF();
+    data[3] = color.alphaF();
+    markDirty(instance);
+}
+
+void InstancedParts::markDirty(int instance)
+{
+    m_dirtyFirst = m_dirtyFirst < 0 ? instance : qMin(m_dirtyFirst, instance);
+    m_dirtyLast = qMax(m_dirtyLast, instance);
+}
+
+void InstancedParts::commit()
+{
+    if (m_dirtyFirst < 0) {
+        return;
+    }
+    
+    const char *bytes = reinterpret_cast<const char*>(m_data.constData());
+    if (instanceCount() != m_uploadedCount) {
+        // New instances: upload everything and grow the bounds
+        m_buffer->setData(QByteArray(bytes, m_data.size() * int(sizeof(float))));
+        m_renderer->setInstanceCount(instanceCount());
+        m_uploadedCount = instanceCount();
+        
+        // Unit primitives fit in [-1, 1]^3; take a box around each copy
+        // that still holds it when it spins about its origin (blades)
+        QVector3D minPoint(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                           std::numeric_limits<float>::max());
+        QVector3D maxPoint = -minPoint;
+        for (int i = 0; i < instanceCount(); ++i) {
+            const float *m = m_data.constData() + i * kFloatsPerInstance;
+            QVector3D origin(m[12], m[13], m[14]);
+            float extent = QVector3D(m[0], m[1], m[2]).length() + QVector3D(m[4], m[5], m[6]).length()
+                           + QVector3D(m[8], m[9], m[10]).length();
+            minPoint = QVector3D(qMin(minPoint.x(), origin.x() - extent), qMin(minPoint.y(), origin.y() - extent),
+                                 qMin(minPoint.z(), origin.z() - extent));
+            maxPoint = QVector3D(qMax(maxPoint.x(), origin.x() + extent), qMax(maxPoint.y(), origin.y() + extent),
+                                 qMax(maxPoint.z(), origin.z() + extent));
+        }
+        m_boundingVolume->setMinPoint(minPoint);
+        m_boundingVolume->setMaxPoint(maxPoint);
+        setEnabled(instanceCount() > 0);
+    } else {
+        // Moved or recoloured instances: one partial upload
+        int offset = m_dirtyFirst * kFloatsPerInstance * int(sizeof(float));
+        int size = (m_dirtyLast - m_dirtyFirst + 1) * kFloatsPerInstance * int(sizeof(float));
+        m_buffer->updateData(offset, QByteArray(bytes + offset, size));
+    }
+    
+    m_dirtyFirst = -1;
+    m_dirtyLast = -1;
+}
@@ -0,0 +1,65 @@
+#ifndef INSTANCEDPARTS_H
+#define INSTANCEDPARTS_H
+
+#include <Qt3DCore/QEntity>
+#include <QColor>
+#include <QMatrix4x4>
+#include <QVector>
+
+namespace Qt3DCore {
+    class QBuffer;
+    class QGeometry;
+}
+
+namespace Qt3DRender {
+    class QBoundingVolume;
+    class QGeometryRenderer;
+    class QMaterial;
+}
+
+// Many copies of one primitive in a single draw call. The transform and
+// colour of every copy live in a per-instance vertex buffer read by a
+// small shader, so repeated parts cost one draw call per part type
+// instead of an entity, mesh, material and transform node each. Moving
+// or recolouring copies rewrites the buffer once per commit().
+class InstancedParts : public Qt3DCore::QEntity
+{
+    Q_OBJECT
+
+public:
+    // geometry is the primitive at unit size, e.g. a QCuboidGeometry
+    InstancedParts(Qt3DCore::QGeometry *geometry, Qt3DRender::QMaterial *material,
+                   Qt3DCore::QNode *parent = nullptr);
+    
+    // Shader-based material reading the instance attributes; one serves
+    // every InstancedParts
+    static Qt3DRender::QMaterial *createMaterial(Qt3DCore::QNode *parent);
+    
+    // Copies may turn about their origin once added; the culling bounds
+    // are only grown when copies are added
+    int addInstance(const QMatrix4x4 &transform, const QColor &color);
+    void setTransform(int instance, const QMatrix4x4 &transform);
+    void setColor(int instance, const QColor &color);
+    int instanceCount() const { return int(m_data.size()) / kFloatsPerInstance; }
+    
+    // Uploads the instances changed since the last commit
+    void commit();
+
+private:
+    // Four matrix columns and a colour
+    static const int kFloatsPerInstance = 20;
+    
+    void markDirty(int instance);
+    
+    Qt3DCore::QGeometry *m_geometry;
+    Qt3DCore::QBuffer *m_buffer;
+    Qt3DRender::QGeometryRenderer *m_renderer;
+    Qt3DRender::QBoundingVolume *m_boundingVolume;
+    
+    QVector<float> m_data;
+    int m_uploadedCount;
+    int m_dirtyFirst;
+    int m_dirtyLast;
+};
+
+#endif // INSTANCEDPARTS_H
@@ -0,0 +1,211 @@
+#include "layoutbuilder.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+
+namespace {
+    const char *const kStockLayoutFile = ":/layouts/lcu.json";
+    
+    // Defaults of the stock drawing
+    const double kPipeWidth = 6.0;
+    const double kPipeRadius = 0.4;
+    const char *const kFontFamily = "Arial";
+    const int kFontSize = 10;
+    
+    struct TypeName {
+        const char *name;
+        LayoutItem::Type type;
+    };
+    
+    const TypeName kTypeNames[] = {
+        {"tank", LayoutItem::Tank},
+        {"heater", LayoutItem::Heater},
+        {"pump", LayoutItem::Pump},
+        {"valve", LayoutItem::Valve},
+        {"phe", LayoutItem::HeatExchanger},
+        {"solenoid_valve", LayoutItem::SolenoidValve},
+        {"condenser", LayoutItem::Condenser},
+        {"blower", LayoutItem::Blower},
+        {"pipe", LayoutItem::Pipe},
+        {"label", LayoutItem::Label},
+        {"panel", LayoutItem::Panel}
+    };
+    
+    bool typeFromName(const QString &name, LayoutItem::Type *type)
+    {
+        for (const TypeName &entry : kTypeNames) {
+            if (name == QLatin1String(entry.name)) {
+                *type = entry.type;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    LayoutItem::Circuit circuitFromName(const QString &name)
+    {
+        if (name == QLatin1String("channel")) {
+            return LayoutItem::Channel;
+        } else if (name == QLatin1String("refrigerant")) {
+            return LayoutItem::Refrigerant;
+        }
+        return LayoutItem::Coolant;
+    }
+    
+    // Points are [x, y] and [x, y, z] arrays
+    QPointF point(const QJsonValue &value)
+    {
+        QJsonArray xy = value.toArray();
+        return QPointF(xy.at(0).toDouble(), xy.at(1).toDouble());
+    }
+    
+    QVector3D point3D(const QJsonValue &value)
+    {
+        QJsonArray xyz = value.toArray();
+        return QVector3D(float(xyz.at(0).toDouble()), float(xyz.at(1).toDouble()), float(xyz.at(2).toDouble()));
+    }
+    
+    QRectF rect(const QJsonValue &value)
+    {
+        QJsonArray xywh = value.toArray();
+        return QRectF(xywh.at(0).toDouble(), xywh.at(1).toDouble(), xywh.at(2).toDouble(), xywh.at(3).toDouble());
+    }
+    
+    QFont font(const QJsonObject &json)
+    {
+        QFont font(json.value("family").toString(QString::fromLatin1(kFontFamily)), json.value("size").toInt(kFontSize));
+        font.setBold(json.value("bold").toBool());
+        return font;
+    }
+    
+    bool parseItem(const QJsonObject &json, LayoutItem *item)
+    {
+        if (!typeFromName(json.value("type").toString(), &item->type)) {
+            qWarning() << "Unknown layout item type" << json.value("type").toString();
+            return false;
+        }
+        
+        item->id = json.value("id").toInt();
+        item->model = json.value("model").toInt(item->id);
+        item->circuit = circuitFromName(json.value("circuit").toString());
+        item->width = json.value("width").toDouble(kPipeWidth);
+        item->radius = json.value("radius").toDouble(kPipeRadius);
+        item->text = json.value("text").toString();
+        
+        if (item->type == LayoutItem::Pipe) {
+            const QJsonArray path = json.value("path").toArray();
+            item->path.reserve(path.size());
+            for (const QJsonValue &value : path) {
+                item->path.append(point(value));
+            }
+            const QJsonArray path3D = json.value("path3d").toArray();
+            item->path3D.reserve(path3D.size());
+            for (const QJsonValue &value : path3D) {
+                item->path3D.append(point3D(value));
+            }
+            item->in2D = item->path.size() >= 2;
+            item->in3D = item->path3D.size() >= 2;
+        } else {
+            item->pos = point(json.value("pos"));
+            item->pos3D = point3D(json.value("pos3d"));
+            item->rect = rect(json.value("rect"));
+            item->in2D = json.contains("pos") || json.contains("rect");
+            item->in3D = json.contains("pos3d");
+        }
+        
+        // Unset colours fall back to what each item draws by default
+        if (json.contains("color")) {
+            item->color = QColor(json.value("color").toString());
+        } else if (item->type == LayoutItem::Pipe) {
+            item->color = QColor(100, 150, 200);
+        } else if (item->type == LayoutItem::Panel) {
+            item->color = QColor(240, 240, 240);
+        } else {
+            item->color = Qt::black;
+        }
+        
+        if (item->type == LayoutItem::Label) {
+            item->font = font(json.value("font").toObject());
+        }
+        
+        if (!item->in2D && !item->in3D) {
+            qWarning() << "Layout item" << json.value("type").toString() << "has no position";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool LayoutBuilder::load(const QString &fileName, PlantLayout *layout, QString *errorMessage)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("Cannot open %1").arg(fileName);
+        }
+        return false;
+    }
+    
+    if (!parse(file.readAll(), layout, errorMessage)) {
+        if (errorMessage) {
+            *errorMessage = QString("%1: %2").arg(fileName, *errorMessage);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool LayoutBuilder::parse(const QByteArray &json, PlantLayout *layout, QString *errorMessage)
+{
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        if (errorMessage) {
+            *errorMessage = parseError.errorString();
+        }
+        return false;
+    }
+    
+    QJsonObject root = document.object();
+    if (!root.value("items").isArray()) {
+        if (errorMessage) {
+            *errorMessage = QString("No layout items");
+        }
+        return false;
+    }
+    
+    layout->name = root.value("name").toString();
+    layout->sceneRect = rect(root.value("scene_rect"));
+    
+    // Bad entries are skipped so one typo does not blank the whole plant
+    const QJsonArray items = root.value("items").toArray();
+    layout->items.clear();
+    layout->items.reserve(items.size());
+    for (const QJsonValue &value : items) {
+        LayoutItem item;
+        if (parseItem(value.toObject(), &item)) {
+            layout->items.append(item);
+        }
+    }
+    return true;
+}
+
+const PlantLayout &LayoutBuilder::stockLayout()
+{
+    static const PlantLayout layout = []() {
+        PlantLayout stock;
+        QString errorMessage;
+        if (!load(stockLayoutFile(), &stock, &errorMessage)) {
+            qWarning() << "Stock layout:" << errorMessage;
+        }
+        return stock;
+    }();
+    return layout;
+}
+
+QString LayoutBuilder::stockLayoutFile()
+{
+    return QString::fromLatin1(kStockLayoutFile);
+}
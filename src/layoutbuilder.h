@@ -0,0 +1,79 @@
+#ifndef LAYOUTBUILDER_H
+#define LAYOUTBUILDER_H
+
+#include <QString>
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <QVector3D>
+#include <QColor>
+#include <QFont>
+
+// One entry of a plant layout file
+struct LayoutItem
+{
+    enum Type {
+        Tank,
+        Heater,
+        Pump,
+        Valve,
+        HeatExchanger,
+        SolenoidValve,
+        Condenser,
+        Blower,
+        Pipe,
+        Label,
+        Panel
+    };
+    
+    enum Circuit {
+        Coolant,
+        Channel,
+        Refrigerant
+    };
+    
+    Type type;
+    int id;                     // number shown on the component
+    int model;                  // DataModel pump, channel or loop index it follows
+    Circuit circuit;            // pipes only
+    
+    // Schematic placement; in2D is false for items only in the 3D model
+    bool in2D;
+    QPointF pos;
+    QVector<QPointF> path;
+    QRectF rect;
+    double width;               // pipe width
+    
+    // 3D placement
+    bool in3D;
+    QVector3D pos3D;
+    QVector<QVector3D> path3D;
+    double radius;              // pipe radius
+    
+    QColor color;
+    QString text;
+    QFont font;
+};
+
+struct PlantLayout
+{
+    QString name;
+    QRectF sceneRect;           // empty: fit the schematic items
+    QVector<LayoutItem> items;
+};
+
+// Reads plant layout files. Both LCUScene and LCUScene3D build from the
+// parsed items, so the schematic and the 3D model always show the same
+// plant. The stock unit is compiled in from resources/layouts/lcu.json.
+class LayoutBuilder
+{
+public:
+    static bool load(const QString &fileName, PlantLayout *layout, QString *errorMessage = nullptr);
+    static bool parse(const QByteArray &json, PlantLayout *layout, QString *errorMessage = nullptr);
+    
+    // Parsed once and shared by every scene
+    static const PlantLayout &stockLayout();
+    static QString stockLayoutFile();
+};
+
+#endif // LAYOUTBUILDER_H
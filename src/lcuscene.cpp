@@ -1,5 +1,6 @@
 #include "lcuscene.h"
 #include "datamodel.h"
+#include "layoutbuilder.h"
 #include "components/pump.h"
 #include "components/valve.h"
 #include "components/tank.h"
@@ -9,334 +10,258 @@
 #include "components/blower.h"
 #include "components/pipe.h"
 #include "components/solenoidvalve.h"
-#include <QGraphicsTextItem>
-#include <QFont>
+#include "components/pipebatch.h"
+#include "components/statusledbatch.h"
+#include "components/labelitem.h"
+#include "components/valuelabel.h"
+#include <QGraphicsRectItem>
+#include <QPen>
 
 LCUScene::LCUScene(DataModel *dataModel, QObject *parent)
-    : QGraphicsScene(parent)
-    , m_dataModel(dataModel)
+    : LCUScene(dataModel, LayoutBuilder::stockLayout(), parent)
 {
-    setSceneRect(0, 0, 1200, 700);
-    setupScene();
 }
 
-void LCUScene::setupScene()
+LCUScene::LCUScene(DataModel *dataModel, const PlantLayout &layout, QObject *parent)
+    : QGraphicsScene(parent)
+    , m_dataModel(dataModel)
+    , m_pipeBatch(nullptr)
+    , m_ledBatch(nullptr)
+    , m_state(RenderSnapshot::capture(dataModel))
 {
-    // Create all components according to the LCU diagram
-    createCoolantSystem();
-    createChannelSystem();
-    createRefrigerantSystem();
-    createPipingConnections();
-    createLabels();
+    loadLayout(layout);
 }
 
-void LCUScene::createCoolantSystem()
+void LCUScene::loadLayout(const PlantLayout &layout)
 {
-    // Tank (left side, lower area)
-    m_tank = new Tank();
-    m_tank->setPos(100, 500);
-    m_tank->setLevel(75.0);
-    addItem(m_tank);
-    m_allComponents.append(m_tank);
-    
-    // Heater (above tank)
-    m_heater = new Heater();
-    m_heater->setPos(100, 380);
-    addItem(m_heater);
-    m_allComponents.append(m_heater);
+    // Items are fully configured before they join the scene, then added
+    // unindexed; the BSP tree is built once for the final scene rect
+    // instead of being grown and rebalanced item by item
+    setItemIndexMethod(NoIndex);
     
-    // Coolant pumps (2 pumps)
-    for (int i = 0; i < 2; ++i) {
-        Pump *pump = new Pump(i);
-        pump->setPos(180 + i * 60, 500);
-        m_coolantPumps.append(pump);
-        addItem(pump);
-        m_allComponents.append(pump);
+    QVector<QGraphicsItem*> items;
+    items.reserve(layout.items.size());
+    m_allComponents.reserve(layout.items.size());
+    for (const LayoutItem &item : layout.items) {
+        if (item.in2D) {
+            items.append(createItem(item));
+        }
     }
     
-    // Create coolant system label
-    QGraphicsTextItem *coolantLabel = addText("Coolant System", QFont("Arial", 10, QFont::Bold));
-    coolantLabel->setPos(50, 300);
-    coolantLabel->setDefaultTextColor(Qt::darkBlue);
-}
-
-void LCUScene::createChannelSystem()
-{
-    // Create 4 channels with valves (top section)
-    double startX = 350;
-    double startY = 100;
-    double spacing = 50;
-    
-    for (int i = 0; i < 4; ++i) {
-        // Main flow valves
-        Valve *inflowValve = new Valve(i * 3, Valve::BallValve);
-        inflowValve->setPos(startX, startY + i * spacing);
-        m_channelValves.append(inflowValve);
-        addItem(inflowValve);
-        m_allComponents.append(inflowValve);
-        
-        // Mid channel valves
-        Valve *midValve1 = new Valve(i * 3 + 1, Valve::BallValve);
-        midValve1->setPos(startX + 150, startY + i * spacing);
-        m_channelValves.append(midValve1);
-        addItem(midValve1);
-        m_allComponents.append(midValve1);
-        
-        Valve *midValve2 = new Valve(i * 3 + 2, Valve::BallValve);
-        midValve2->setPos(startX + 250, startY + i * spacing);
-        m_channelValves.append(midValve2);
-        addItem(midValve2);
-        m_allComponents.append(midValve2);
-        
-        // Channel label
-        QGraphicsTextItem *chLabel = addText(QString("CH %1").arg(i + 1), QFont("Arial", 8, QFont::Bold));
-        chLabel->setPos(startX - 50, startY + i * spacing - 10);
+    for (QGraphicsItem *item : items) {
+        addItem(item);
     }
     
-    // Add sensor display area at top
-    QGraphicsTextItem *sensorLabel = addText("Sensor Data", QFont("Arial", 10, QFont::Bold));
-    sensorLabel->setPos(350, 20);
-    sensorLabel->setDefaultTextColor(Qt::darkBlue);
+    setSceneRect(layout.sceneRect.isEmpty() ? itemsBoundingRect() : layout.sceneRect);
+    setItemIndexMethod(BspTreeIndex);
 }
 
-void LCUScene::createRefrigerantSystem()
+QGraphicsItem *LCUScene::createItem(const LayoutItem &item)
 {
-    // Create 3 refrigerant loops (bottom right section)
-    double startX = 650;
-    double startY = 400;
-    double spacing = 100;
+    BaseComponent *component = nullptr;
     
-    for (int i = 0; i < 3; ++i) {
-        double yPos = startY + i * spacing;
-        
-        // PHE (Plate Heat Exchanger)
-        HeatExchanger *phe = new HeatExchanger(i + 1);
-        phe->setPos(startX - 80, yPos);
-        m_heatExchangers.append(phe);
-        addItem(phe);
-        m_allComponents.append(phe);
-        
-        // Solenoid Valve
-        SolenoidValve *sv = new SolenoidValve(i + 1);
-        sv->setPos(startX, yPos);
-        m_solenoidValves.append(sv);
-        addItem(sv);
-        m_allComponents.append(sv);
-        
-        // Condenser
-        Condenser *condenser = new Condenser(i + 1);
-        condenser->setPos(startX + 80, yPos);
-        m_condensers.append(condenser);
-        addItem(condenser);
-        m_allComponents.append(condenser);
-        
-        // Blower
-        Blower *blower = new Blower(i + 1);
-        blower->setPos(startX + 150, yPos);
-        m_blowers.append(blower);
-        addItem(blower);
-        m_allComponents.append(blower);
-        
-        // Loop label
-        QGraphicsTextItem *loopLabel = addText(QString("Loop %1").arg(i + 1), QFont("Arial", 7));
-        loopLabel->setPos(startX - 120, yPos - 15);
+    switch (item.type) {
+    case LayoutItem::Tank: {
+        Tank *tank = new Tank();
+        m_tanks.append(tank);
+        component = tank;
+        break;
+    }
+    case LayoutItem::Heater: {
+        Heater *heater = new Heater();
+        m_heaters.append(heater);
+        component = heater;
+        break;
+    }
+    case LayoutItem::Pump: {
+        Pump *pump = new Pump(item.id);
+        m_coolantPumps.append({pump, item.model});
+        component = pump;
+        break;
+    }
+    case LayoutItem::Valve: {
+        Valve *valve = new Valve(item.id, Valve::BallValve);
+        m_channelValves.append({valve, item.model});
+        component = valve;
+        break;
+    }
+    case LayoutItem::HeatExchanger: {
+        HeatExchanger *phe = new HeatExchanger(item.id);
+        m_heatExchangers.append({phe, item.model});
+        component = phe;
+        break;
+    }
+    case LayoutItem::SolenoidValve: {
+        SolenoidValve *sv = new SolenoidValve(item.id);
+        m_solenoidValves.append({sv, item.model});
+        component = sv;
+        break;
+    }
+    case LayoutItem::Condenser: {
+        Condenser *condenser = new Condenser(item.id);
+        m_condensers.append({condenser, item.model});
+        component = condenser;
+        break;
+    }
+    case LayoutItem::Blower: {
+        Blower *blower = new Blower(item.id);
+        m_blowers.append({blower, item.model});
+        component = blower;
+        break;
+    }
+    case LayoutItem::Pipe: {
+        // Path last so the geometry is built once
+        Pipe *pipe = new Pipe();
+        pipe->setFluidColor(item.color);
+        pipe->setWidth(item.width);
+        pipe->setPath(item.path);
+        if (item.circuit == LayoutItem::Channel) {
+            m_channelPipes.append({pipe, item.model});
+        } else if (item.circuit == LayoutItem::Refrigerant) {
+            m_refrigerantPipes.append({pipe, item.model});
+        } else {
+            m_coolantPipes.append(pipe);
+        }
+        m_allComponents.append(pipe);
+        return pipe;
+    }
+    case LayoutItem::Label: {
+        LabelItem *label = new LabelItem(item.text, item.font);
+        label->setPos(item.pos);
+        label->setColor(item.color);
+        return label;
+    }
+    case LayoutItem::Panel: {
+        QGraphicsRectItem *panel = new QGraphicsRectItem(item.rect);
+        panel->setPen(QPen(Qt::black, 2));
+        panel->setBrush(item.color);
+        return panel;
+    }
     }
     
-    // Create refrigerant system label
-    QGraphicsTextItem *refLabel = addText("Refrigerant System", QFont("Arial", 10, QFont::Bold));
-    refLabel->setPos(650, 300);
-    refLabel->setDefaultTextColor(Qt::darkBlue);
+    component->setPos(item.pos);
+    m_allComponents.append(component);
+    return component;
 }
 
-void LCUScene::createPipingConnections()
+void LCUScene::setValueOverlays(bool enabled)
 {
-    // Connect coolant system components
-    
-    // Tank to heater
-    Pipe *tankToHeater = new Pipe();
-    tankToHeater->setPath({{100, 450}, {100, 410}});
-    tankToHeater->setFluidColor(QColor(100, 150, 200));
-    m_coolantPipes.append(tankToHeater);
-    addItem(tankToHeater);
-    m_allComponents.append(tankToHeater);
+    if (enabled == hasValueOverlays()) {
+        return;
+    }
     
-    // Heater to pumps
-    for (int i = 0; i < 2; ++i) {
-        Pipe *heaterToPump = new Pipe();
-        heaterToPump->setPath({{120, 380}, {180 + i * 60, 380}, {180 + i * 60, 475}});
-        heaterToPump->setFluidColor(QColor(100, 150, 200));
-        m_coolantPipes.append(heaterToPump);
-        addItem(heaterToPump);
-        m_allComponents.append(heaterToPump);
+    if (!enabled) {
+        for (const ValueOverlay &overlay : m_valueOverlays) {
+            delete overlay.label;
+        }
+        m_valueOverlays.clear();
+        return;
     }
     
-    // Pumps to channel distribution
-    Pipe *pumpToChannels = new Pipe();
-    pumpToChannels->setPath({{220, 500}, {300, 500}, {300, 150}});
-    pumpToChannels->setFluidColor(QColor(100, 150, 200));
-    m_coolantPipes.append(pumpToChannels);
-    addItem(pumpToChannels);
-    m_allComponents.append(pumpToChannels);
+    // Readouts stacked under the bottom-left corner of their component
+    auto add = [this](BaseComponent *component, int row, const QString &unit, int decimals,
+                      std::function<double(const RenderSnapshot &)> read) {
+        ValueLabel *label = new ValueLabel(unit, decimals);
+        QRectF bounds = component->sceneBoundingRect();
+        label->setPos(bounds.left(), bounds.bottom() + 2 + row * label->boundingRect().height());
+        addItem(label);
+        m_valueOverlays.append(ValueOverlay{label, read});
+    };
     
-    // Channel connections
-    for (int i = 0; i < 4; ++i) {
-        double y = 100 + i * 50;
-        
-        // Supply to channel
-        Pipe *supplyPipe = new Pipe();
-        supplyPipe->setPath({{300, y}, {330, y}});
-        supplyPipe->setFluidColor(QColor(100, 150, 200));
-        m_channelPipes.append(supplyPipe);
-        addItem(supplyPipe);
-        m_allComponents.append(supplyPipe);
-        
-        // Channel flow
-        Pipe *channelPipe = new Pipe();
-        channelPipe->setPath({{370, y}, {480, y}});
-        channelPipe->setFluidColor(QColor(120, 170, 220));
-        m_channelPipes.append(channelPipe);
-        addItem(channelPipe);
-        m_allComponents.append(channelPipe);
-        
-        // Return from channel
-        Pipe *returnPipe = new Pipe();
-        returnPipe->setPath({{520, y}, {600, y}});
-        returnPipe->setFluidColor(QColor(200, 150, 100));
-        m_channelPipes.append(returnPipe);
-        addItem(returnPipe);
-        m_allComponents.append(returnPipe);
+    for (Tank *tank : m_tanks) {
+        add(tank, 0, "°C", 1, [](const RenderSnapshot &state) { return state.supplyTemp; });
+        add(tank, 1, "%", 1, [](const RenderSnapshot &state) { return state.tankLevel; });
+    }
+    for (const Binding<Pump> &pump : m_coolantPumps) {
+        int i = pump.index;
+        add(pump.item, 0, "LPM", 1, [i](const RenderSnapshot &state) {
+            return state.pumpState(i) ? state.flowRate / 2.0 : 0.0;
+        });
+    }
+    for (const Binding<HeatExchanger> &phe : m_heatExchangers) {
+        int i = phe.index;
+        add(phe.item, 0, "°C", 1, [i](const RenderSnapshot &state) { return state.pheTemp(i); });
+    }
+    for (const Binding<Condenser> &condenser : m_condensers) {
+        int i = condenser.index;
+        add(condenser.item, 0, "°C", 1, [i](const RenderSnapshot &state) { return state.condenserTemp(i); });
     }
     
-    // Return manifold
-    Pipe *returnManifold = new Pipe();
-    returnManifold->setPath({{600, 100}, {600, 250}, {100, 250}, {100, 450}});
-    returnManifold->setFluidColor(QColor(200, 150, 100));
-    m_coolantPipes.append(returnManifold);
-    addItem(returnManifold);
-    m_allComponents.append(returnManifold);
-    
-    // Refrigerant connections
-    for (int i = 0; i < 3; ++i) {
-        double y = 400 + i * 100;
-        
-        // Connect PHE to Solenoid Valve
-        Pipe *pheToSV = new Pipe();
-        pheToSV->setPath({{595, y}, {635, y}});
-        pheToSV->setFluidColor(QColor(150, 200, 255));
-        m_refrigerantPipes.append(pheToSV);
-        addItem(pheToSV);
-        m_allComponents.append(pheToSV);
-        
-        // Connect Solenoid Valve to Condenser
-        Pipe *svToCondenser = new Pipe();
-        svToCondenser->setPath({{665, y}, {650, y}});
-        svToCondenser->setFluidColor(QColor(150, 200, 255));
-        m_refrigerantPipes.append(svToCondenser);
-        addItem(svToCondenser);
-        m_allComponents.append(svToCondenser);
-        
-        // Connect Condenser to return
-        Pipe *condenserReturn = new Pipe();
-        condenserReturn->setPath({{710, y}, {540, y}});
-        condenserReturn->setFluidColor(QColor(255, 150, 150));
-        m_refrigerantPipes.append(condenserReturn);
-        addItem(condenserReturn);
-        m_allComponents.append(condenserReturn);
+    for (const ValueOverlay &overlay : m_valueOverlays) {
+        overlay.label->setValue(overlay.read(m_state));
     }
 }
 
-void LCUScene::createLabels()
+void LCUScene::updateAnimations(double deltaTime)
 {
-    // Main title
-    QGraphicsTextItem *title = addText("Liquid Cooling Unit (LCU) - RSCU A C01", 
-                                       QFont("Arial", 14, QFont::Bold));
-    title->setPos(300, -20);
-    title->setDefaultTextColor(Qt::darkBlue);
-    
-    // System status indicator
-    QGraphicsRectItem *statusBox = addRect(1050, 30, 120, 60, 
-                                          QPen(Qt::black, 2), 
-                                          QBrush(QColor(240, 240, 240)));
-    
-    QGraphicsTextItem *statusText = addText("System Status", QFont("Arial", 9, QFont::Bold));
-    statusText->setPos(1060, 35);
-    
-    QGraphicsTextItem *runningText = addText("READY", QFont("Arial", 8));
-    runningText->setPos(1070, 55);
-    runningText->setDefaultTextColor(Qt::darkGreen);
+    updateAnimations(deltaTime, RenderSnapshot::capture(m_dataModel));
 }
 
-void LCUScene::updateAnimations(double deltaTime)
+void LCUScene::updateAnimations(double deltaTime, const RenderSnapshot &state)
 {
+    m_state = state;
+    
     // Update all components
     for (BaseComponent *component : m_allComponents) {
         component->updateAnimation(deltaTime);
     }
     
     // Update component states based on data model
+    bool systemRunning = state.systemRunning;
     
     // Update coolant pumps
-    for (int i = 0; i < m_coolantPumps.size(); ++i) {
-        bool running = m_dataModel->getPumpState(i);
-        m_coolantPumps[i]->setRunning(running);
-        m_coolantPumps[i]->setFlowRate(running ? m_dataModel->getFlowRate() / 2.0 : 0.0);
+    for (const Binding<Pump> &pump : m_coolantPumps) {
+        bool running = state.pumpState(pump.index);
+        pump.item->setRunning(running);
+        pump.item->setFlowRate(running ? state.flowRate / 2.0 : 0.0);
     }
     
-    // Update heater
-    if (m_dataModel->isSystemRunning()) {
-        m_heater->setActive(true);
-        m_heater->setPower(m_dataModel->getHeaterPower());
-    } else {
-        m_heater->setActive(false);
-        m_heater->setPower(0.0);
+    // Update heaters
+    double heaterPower = systemRunning ? state.heaterPower : 0.0;
+    for (Heater *heater : m_heaters) {
+        heater->setActive(systemRunning);
+        heater->setPower(heaterPower);
     }
     
-    // Update tank
-    m_tank->setLevel(m_dataModel->getTankLevel());
-    m_tank->setTemperature(m_dataModel->getSupplyTemp());
+    // Update tanks
+    double tankLevel = state.tankLevel;
+    double supplyTemp = state.supplyTemp;
+    for (Tank *tank : m_tanks) {
+        tank->setLevel(tankLevel);
+        tank->setTemperature(supplyTemp);
+    }
     
-    // Update channel valves (simplified - every 3 valves per channel)
-    for (int ch = 0; ch < 4; ++ch) {
-        bool channelOpen = m_dataModel->getChannelState(ch);
-        for (int v = 0; v < 3 && (ch * 3 + v) < m_channelValves.size(); ++v) {
-            m_channelValves[ch * 3 + v]->setOpen(channelOpen);
-        }
+    // Update channel valves
+    for (const Binding<Valve> &valve : m_channelValves) {
+        valve.item->setOpen(state.channelState(valve.index));
     }
     
     // Update refrigerant system
-    for (int i = 0; i < 3; ++i) {
-        // Update heat exchangers
-        if (i < m_heatExchangers.size()) {
-            bool active = m_dataModel->getCompressorState(i);
-            m_heatExchangers[i]->setActive(active);
-            m_heatExchangers[i]->setHotSideTemp(m_dataModel->getReturnTemp());
-            m_heatExchangers[i]->setColdSideTemp(m_dataModel->getPHETemp(i));
-        }
-        
-        // Update solenoid valves
-        if (i < m_solenoidValves.size()) {
-            bool open = m_dataModel->getSolenoidValveState(i);
-            m_solenoidValves[i]->setOpen(open);
-            m_solenoidValves[i]->setEnergized(open);
-        }
-        
-        // Update condensers
-        if (i < m_condensers.size()) {
-            bool active = m_dataModel->getCompressorState(i);
-            m_condensers[i]->setActive(active);
-            m_condensers[i]->setTemperature(m_dataModel->getCondenserTemp(i));
-        }
-        
-        // Update blowers
-        if (i < m_blowers.size()) {
-            bool running = m_dataModel->getBlowerState(i);
-            m_blowers[i]->setRunning(running);
-            m_blowers[i]->setSpeed(running ? 75.0 : 0.0);
-        }
+    double returnTemp = state.returnTemp;
+    for (const Binding<HeatExchanger> &phe : m_heatExchangers) {
+        phe.item->setActive(state.compressorState(phe.index));
+        phe.item->setHotSideTemp(returnTemp);
+        phe.item->setColdSideTemp(state.pheTemp(phe.index));
+    }
+    
+    for (const Binding<SolenoidValve> &sv : m_solenoidValves) {
+        bool open = state.solenoidValveState(sv.index);
+        sv.item->setOpen(open);
+        sv.item->setEnergized(open);
+    }
+    
+    for (const Binding<Condenser> &condenser : m_condensers) {
+        condenser.item->setActive(state.compressorState(condenser.index));
+        condenser.item->setTemperature(state.condenserTemp(condenser.index));
+    }
+    
+    for (const Binding<Blower> &blower : m_blowers) {
+        bool running = state.blowerState(blower.index);
+        blower.item->setRunning(running);
+        blower.item->setSpeed(running ? state.blowerSpeed(blower.index) : 0.0);
     }
     
     // Update pipe flows
-    bool systemRunning = m_dataModel->isSystemRunning();
     
     // Coolant pipes
     for (Pipe *pipe : m_coolantPipes) {
@@ -344,19 +269,79 @@ void LCUScene::updateAnimations(double deltaTime)
     }
     
     // Channel pipes - only if channel is open
-    for (int ch = 0; ch < 4; ++ch) {
-        bool channelOpen = m_dataModel->getChannelState(ch);
-        for (int p = 0; p < 3 && (ch * 3 + p) < m_channelPipes.size(); ++p) {
-            m_channelPipes[ch * 3 + p]->setFlowing(channelOpen && systemRunning);
-        }
+    for (const Binding<Pipe> &pipe : m_channelPipes) {
+        pipe.item->setFlowing(state.channelState(pipe.index) && systemRunning);
     }
     
     // Refrigerant pipes
-    for (int i = 0; i < m_refrigerantPipes.size(); ++i) {
-        int loopIndex = i / 3;
-        if (loopIndex < 3) {
-            bool loopActive = m_dataModel->getCompressorState(loopIndex);
-            m_refrigerantPipes[i]->setFlowing(loopActive);
+    for (const Binding<Pipe> &pipe : m_refrigerantPipes) {
+        pipe.item->setFlowing(state.compressorState(pipe.index));
+    }
+    
+    // Live readouts only repaint when the displayed digits change
+    for (const ValueOverlay &overlay : m_valueOverlays) {
+        overlay.label->setValue(overlay.read(state));
+    }
+    
+    if (m_pipeBatch) {
+        syncPipeBatch();
+        m_pipeBatch->updateAnimation(deltaTime);
+        m_ledBatch->updateAnimation(deltaTime);
+    }
+}
+
+bool LCUScene::isAnimating() const
+{
+    for (BaseComponent *component : m_allComponents) {
+        if (component->isAnimating()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LCUScene::setBatchedRendering(bool enabled)
+{
+    if (enabled == isBatchedRendering()) {
+        return;
+    }
+    
+    if (enabled) {
+        m_pipeBatch = new PipeBatch();
+        m_ledBatch = new StatusLedBatch();
+        
+        for (BaseComponent *component : m_allComponents) {
+            if (Pipe *pipe = qobject_cast<Pipe*>(component)) {
+                m_pipeBatch->addPipe(pipe->getPath(), pipe->getFluidColor(), pipe->getWidth());
+                m_batchedPipes.append(pipe);
+                pipe->setVisible(false);
+            } else {
+                m_ledBatch->addComponent(component);
+            }
+        }
+        
+        addItem(m_pipeBatch);
+        addItem(m_ledBatch);
+        syncPipeBatch();
+    } else {
+        for (Pipe *pipe : m_batchedPipes) {
+            pipe->setVisible(true);
         }
+        m_batchedPipes.clear();
+        m_ledBatch->clear();
+        
+        delete m_pipeBatch;
+        delete m_ledBatch;
+        m_pipeBatch = nullptr;
+        m_ledBatch = nullptr;
+    }
+}
+
+void LCUScene::syncPipeBatch()
+{
+    // The hidden pipes still follow the model; mirror their state
+    for (int i = 0; i < m_batchedPipes.size(); ++i) {
+        m_pipeBatch->setFlowing(i, m_batchedPipes[i]->isFlowing());
+        m_pipeBatch->setFlowDirection(i, m_batchedPipes[i]->isFlowForward());
     }
 }
@@ -3,6 +3,8 @@
 
 #include <QGraphicsScene>
 #include <QVector>
+#include <functional>
+#include "rendersnapshot.h"
 
 class DataModel;
 class BaseComponent;
@@ -15,45 +17,85 @@ class Condenser;
 class Blower;
 class Pipe;
 class SolenoidValve;
+class PipeBatch;
+class StatusLedBatch;
+class LabelItem;
+class ValueLabel;
+struct LayoutItem;
+struct PlantLayout;
 
 class LCUScene : public QGraphicsScene
 {
     Q_OBJECT
 
 public:
+    // Builds the stock unit, or the given plant layout
     explicit LCUScene(DataModel *dataModel, QObject *parent = nullptr);
+    LCUScene(DataModel *dataModel, const PlantLayout &layout, QObject *parent = nullptr);
     
+    // Draws the model as it is now, or as the given (interpolated) state
     void updateAnimations(double deltaTime);
+    void updateAnimations(double deltaTime, const RenderSnapshot &state);
+    
+    // False once every component has come to rest
+    bool isAnimating() const;
+    
+    // Draw all pipes and status LEDs through batch items instead of
+    // painting each item separately
+    void setBatchedRendering(bool enabled);
+    bool isBatchedRendering() const { return m_pipeBatch != nullptr; }
+    
+    // Live temperature, level and flow readouts next to the components
+    void setValueOverlays(bool enabled);
+    bool hasValueOverlays() const { return !m_valueOverlays.isEmpty(); }
 
 private:
-    void setupScene();
-    void createCoolantSystem();
-    void createRefrigerantSystem();
-    void createChannelSystem();
-    void createPipingConnections();
-    void createLabels();
+    // A component and the DataModel pump, channel or loop it follows
+    template <typename T>
+    struct Binding {
+        T *item;
+        int index;
+    };
+    
+    void loadLayout(const PlantLayout &layout);
+    QGraphicsItem *createItem(const LayoutItem &item);
+    void syncPipeBatch();
     
     DataModel *m_dataModel;
     
     // Coolant system components
-    Tank *m_tank;
-    Heater *m_heater;
-    QVector<Pump*> m_coolantPumps;
+    QVector<Tank*> m_tanks;
+    QVector<Heater*> m_heaters;
+    QVector<Binding<Pump>> m_coolantPumps;
     QVector<Pipe*> m_coolantPipes;
     
     // Channel system
-    QVector<Valve*> m_channelValves;
-    QVector<Pipe*> m_channelPipes;
+    QVector<Binding<Valve>> m_channelValves;
+    QVector<Binding<Pipe>> m_channelPipes;
     
     // Refrigerant system
-    QVector<HeatExchanger*> m_heatExchangers;
-    QVector<SolenoidValve*> m_solenoidValves;
-    QVector<Condenser*> m_condensers;
-    QVector<Blower*> m_blowers;
-    QVector<Pipe*> m_refrigerantPipes;
+    QVector<Binding<HeatExchanger>> m_heatExchangers;
+    QVector<Binding<SolenoidValve>> m_solenoidValves;
+    QVector<Binding<Condenser>> m_condensers;
+    QVector<Binding<Blower>> m_blowers;
+    QVector<Binding<Pipe>> m_refrigerantPipes;
     
     // All components for easy iteration
     QVector<BaseComponent*> m_allComponents;
+    
+    // Batched rendering; m_batchedPipes[i] is pipe i of m_pipeBatch
+    PipeBatch *m_pipeBatch;
+    StatusLedBatch *m_ledBatch;
+    QVector<Pipe*> m_batchedPipes;
+    
+    struct ValueOverlay {
+        ValueLabel *label;
+        std::function<double(const RenderSnapshot &)> read;
+    };
+    QVector<ValueOverlay> m_valueOverlays;
+    
+    // State drawn by the last update
+    RenderSnapshot m_state;
 };
 
 #endif // LCUSCENE_H
@@ -1,5 +1,8 @@
 #include "lcuscene3d.h"
 #include "datamodel.h"
+#include "layoutbuilder.h"
+#include "framestats.h"
+#include "instancedparts.h"
 #include <Qt3DCore/QTransform>
 #include <Qt3DExtras/QPhongMaterial>
 #include <Qt3DExtras/QCylinderMesh>
@@ -7,17 +10,109 @@
 #include <Qt3DExtras/QCuboidMesh>
 #include <Qt3DExtras/QTorusMesh>
 #include <Qt3DExtras/QConeMesh>
+#include <Qt3DExtras/QCuboidGeometry>
+#include <Qt3DExtras/QCylinderGeometry>
+#include <Qt3DExtras/QSphereGeometry>
 #include <Qt3DRender/QPointLight>
 #include <Qt3DRender/QCamera>
+#include <Qt3DRender/QGeometryRenderer>
+#include <QMetaProperty>
 #include <QtMath>
 
+namespace {
+    // Per vertex: position, normal, texture coordinate and tangent floats
+    const qint64 kVertexBytes = (3 + 3 + 2 + 4) * sizeof(float);
+    const qint64 kIndexBytes = sizeof(quint16);
+    
+    qint64 meshBytes(qint64 vertices, qint64 indices)
+    {
+        return vertices * kVertexBytes + indices * kIndexBytes;
+    }
+    
+    const int kBladesPerBlower = 6;
+    
+    // Instance transform of a unit primitive
+    QMatrix4x4 partMatrix(const QVector3D &position, const QVector3D &scale)
+    {
+        QMatrix4x4 matrix;
+        matrix.translate(position);
+        matrix.scale(scale);
+        return matrix;
+    }
+    
+    // Blade of a blower housing turned by rotationY, as the housing's
+    // QTransform and the blade's own would place it
+    QMatrix4x4 bladeMatrix(const QVector3D &position, float rotationY, float angle)
+    {
+        QMatrix4x4 matrix;
+        matrix.translate(position);
+        matrix.rotate(rotationY, 0.0f, 1.0f, 0.0f);
+        matrix.rotate(angle, 0.0f, 0.0f, 1.0f);
+        matrix.scale(1.5f, 0.2f, 0.3f);
+        return matrix;
+    }
+    
+    // Rotation taking the cylinder's Y axis onto a pipe run
+    QQuaternion pipeRotation(QVector3D direction)
+    {
+        QVector3D yAxis(0, 1, 0);
+        direction.normalize();
+        
+        QVector3D rotationAxis = QVector3D::crossProduct(yAxis, direction);
+        float rotationAngle = qRadiansToDegrees(qAcos(QVector3D::dotProduct(yAxis, direction)));
+        
+        if (rotationAxis.length() > 0.001f) {
+            return QQuaternion::fromAxisAndAngle(rotationAxis, rotationAngle);
+        }
+        return QQuaternion();
+    }
+}
+
+namespace {
+    struct Look {
+        QColor diffuse;
+        QColor ambient;
+    };
+    
+    // Off and on look of each LCUScene3D::PartType
+    const Look kLooks[][2] = {
+        { { QColor(200, 50, 50), QColor(150, 40, 40) },         // heater: dull red
+          { QColor(255, 80, 20), QColor(200, 50, 10) } },       // red/orange glow
+        { { QColor(80, 120, 160), QColor(60, 90, 120) },        // pump: dull blue
+          { QColor(100, 180, 240), QColor(80, 120, 160) } },    // brighter blue
+        { { QColor(120, 120, 120), QColor(90, 90, 90) },        // valve: closed gray
+          { QColor(50, 200, 50), QColor(40, 150, 40) } },       // open green
+        { { QColor(180, 180, 180), QColor(140, 140, 140) },     // heat exchanger: gray
+          { QColor(150, 220, 250), QColor(120, 180, 200) } },   // cyan tint
+        { { QColor(100, 100, 150), QColor(70, 70, 110) },       // solenoid: dark blue
+          { QColor(150, 255, 100), QColor(100, 200, 70) } },    // energized yellow/green
+        { { QColor(160, 160, 160), QColor(120, 120, 120) },     // condenser: gray
+          { QColor(200, 180, 160), QColor(160, 140, 120) } },   // warmer
+        { { QColor(80, 80, 120), QColor(60, 60, 90) },          // blower: dark blue
+          { QColor(100, 140, 200), QColor(80, 100, 150) } },    // brighter blue
+    };
+}
+
+bool LCUScene3D::s_resourceSharing = true;
+bool LCUScene3D::s_instancing = true;
+
 LCUScene3D::LCUScene3D(DataModel *dataModel, Qt3DCore::QEntity *parent)
+    : LCUScene3D(dataModel, LayoutBuilder::stockLayout(), parent)
+{
+}
+
+LCUScene3D::LCUScene3D(DataModel *dataModel, const PlantLayout &layout, Qt3DCore::QEntity *parent)
     : Qt3DCore::QEntity(parent)
     , m_dataModel(dataModel)
     , m_pumpRotation(0.0)
     , m_blowerRotation(0.0)
+    , m_geometryBytes(0)
+    , m_valveHandles(nullptr)
+    , m_condenserFins(nullptr)
+    , m_blowerBlades(nullptr)
+    , m_pipeRuns(nullptr)
 {
-    setupScene();
+    setupScene(layout);
 }
 
 void LCUScene3D::setupCamera(Qt3DRender::QCamera *camera)
@@ -29,14 +124,59 @@ void LCUScene3D::setupCamera(Qt3DRender::QCamera *camera)
     camera->setViewCenter(QVector3D(0, 0, 0));
 }
 
-void LCUScene3D::setupScene()
+void LCUScene3D::setupScene(const PlantLayout &layout)
 {
+    // Two looks per model-driven part type, shared by every part of it
+    for (int type = 0; type < PartTypeCount; ++type) {
+        for (int state = 0; state < 2; ++state) {
+            m_looks[type][state] = nullptr;
+            if (s_resourceSharing) {
+                Qt3DExtras::QPhongMaterial *look = new Qt3DExtras::QPhongMaterial(this);
+                look->setDiffuse(kLooks[type][state].diffuse);
+                look->setAmbient(kLooks[type][state].ambient);
+                look->setSpecular(QColor(255, 255, 255));
+                look->setShininess(50.0f);
+                m_looks[type][state] = look;
+            }
+        }
+    }
+    
     setupLighting();
     createFloor();
-    createCoolantSystem();
-    createChannelSystem();
-    createRefrigerantSystem();
-    createPipingConnections();
+    
+    if (s_instancing) {
+        // Unit primitives; each copy's matrix sizes and places it
+        Qt3DRender::QMaterial *material = InstancedParts::createMaterial(this);
+        
+        Qt3DExtras::QSphereGeometry *handle = new Qt3DExtras::QSphereGeometry();
+        handle->setRings(20);
+        handle->setSlices(20);
+        m_valveHandles = new InstancedParts(handle, material, this);
+        
+        m_condenserFins = new InstancedParts(new Qt3DExtras::QCuboidGeometry(), material, this);
+        m_blowerBlades = new InstancedParts(new Qt3DExtras::QCuboidGeometry(), material, this);
+        
+        Qt3DExtras::QCylinderGeometry *run = new Qt3DExtras::QCylinderGeometry();
+        run->setRings(10);
+        run->setSlices(12);
+        m_pipeRuns = new InstancedParts(run, material, this);
+        
+        m_geometryBytes += meshBytes(21 * 21, 20 * 19 * 6) + 2 * meshBytes(24, 36)
+                           + meshBytes(10 * 13 + 2 * 14, 12 * 9 * 6 + 12 * 6);
+    }
+    
+    for (const LayoutItem &item : layout.items) {
+        if (item.in3D) {
+            createItem(item);
+        }
+    }
+    
+    if (s_instancing) {
+        m_valveHandles->commit();
+        m_condenserFins->commit();
+        m_blowerBlades->commit();
+        m_pipeRuns->commit();
+    }
 }
 
 void LCUScene3D::setupLighting()
@@ -75,42 +215,41 @@ void LCUScene3D::createFloor()
     );
 }
 
-void LCUScene3D::createCoolantSystem()
+void LCUScene3D::createItem(const LayoutItem &item)
 {
-    // Create coolant tank (vertical cylinder)
-    m_tankEntity = createCylinder(
-        QVector3D(-15, 5, 0),
-        3.0f,
-        10.0f,
-        QColor(100, 150, 200),
-        this
-    );
-    
-    // Rotate tank to be vertical (cylinder is horizontal by default)
-    Qt3DCore::QTransform *tankTransform = m_tankEntity->findChild<Qt3DCore::QTransform*>();
-    if (tankTransform) {
-        tankTransform->setRotationX(90);
+    switch (item.type) {
+    case LayoutItem::Tank: {
+        // Coolant tank (vertical cylinder)
+        Qt3DCore::QEntity *tankEntity = createCylinder(
+            item.pos3D,
+            3.0f,
+            10.0f,
+            QColor(100, 150, 200),
+            this
+        );
+        
+        // Rotate tank to be vertical (cylinder is horizontal by default)
+        Qt3DCore::QTransform *tankTransform = tankEntity->findChild<Qt3DCore::QTransform*>();
+        if (tankTransform) {
+            tankTransform->setRotationX(90);
+        }
+        break;
     }
-    
-    // Store tank material for state updates
-    m_tankMaterial = m_tankEntity->findChild<Qt3DExtras::QPhongMaterial*>();
-    
-    // Create heater (box below tank)
-    m_heaterEntity = createBox(
-        QVector3D(-15, 0.5, 0),
-        QVector3D(4, 1, 4),
-        QColor(200, 50, 50),
-        this
-    );
-    
-    // Store heater material for state updates
-    m_heaterMaterial = m_heaterEntity->findChild<Qt3DExtras::QPhongMaterial*>();
-    
-    // Create two pumps
-    for (int i = 0; i < 2; ++i) {
-        float xPos = -15 + (i * 6);
+    case LayoutItem::Heater: {
+        // Heater (box below tank)
+        Qt3DCore::QEntity *heaterEntity = createBox(
+            item.pos3D,
+            QVector3D(4, 1, 4),
+            QColor(200, 50, 50),
+            this
+        );
+        
+        m_heaterParts.append(statePart(heaterEntity, HeaterPart));
+        break;
+    }
+    case LayoutItem::Pump: {
         Qt3DCore::QEntity *pumpEntity = createCylinder(
-            QVector3D(xPos, 1.5, -6),
+            item.pos3D,
             1.5f,
             3.0f,
             QColor(80, 120, 160),
@@ -118,7 +257,7 @@ void LCUScene3D::createCoolantSystem()
         );
         
         // Add pump impeller (sphere in center)
-        Qt3DCore::QEntity *impeller = createSphere(
+        createSphere(
             QVector3D(0, 0, 0),
             1.0f,
             QColor(150, 150, 150),
@@ -126,97 +265,73 @@ void LCUScene3D::createCoolantSystem()
         );
         
         m_pumpEntities.append(pumpEntity);
-        
-        // Store transform for animation
-        Qt3DCore::QTransform *pumpTransform = pumpEntity->findChild<Qt3DCore::QTransform*>();
-        m_pumpTransforms.append(pumpTransform);
-        
-        // Store material for state updates
-        Qt3DExtras::QPhongMaterial *pumpMaterial = pumpEntity->findChild<Qt3DExtras::QPhongMaterial*>();
-        m_pumpMaterials.append(pumpMaterial);
+        m_pumpTransforms.append(pumpEntity->findChild<Qt3DCore::QTransform*>());
+        m_pumpParts.append(statePart(pumpEntity, PumpPart));
+        m_pumpIndices.append(item.model);
+        break;
     }
-}
-
-void LCUScene3D::createChannelSystem()
-{
-    // Create 12 valves (3 per channel, matching 2D layout)
-    double startX = -10;
-    double startZ = 10;
-    double channelSpacing = 5;
-    double valveSpacing = 3;
-    
-    for (int ch = 0; ch < 4; ++ch) {
-        float zPos = startZ + (ch * channelSpacing);
+    case LayoutItem::Valve: {
+        // Valve body (cylinder)
+        Qt3DCore::QEntity *valveEntity = createCylinder(
+            item.pos3D,
+            0.6f,
+            1.5f,
+            QColor(120, 120, 120),
+            this
+        );
         
-        // Create 3 valves per channel
-        for (int v = 0; v < 3; ++v) {
-            float xPos = startX + (v * valveSpacing);
-            
-            // Create valve body (cylinder)
-            Qt3DCore::QEntity *valveEntity = createCylinder(
-                QVector3D(xPos, 2, zPos),
-                0.6f,
-                1.5f,
-                QColor(120, 120, 120),
-                this
-            );
-            
-            // Add valve handle (sphere on top)
-            Qt3DCore::QEntity *handle = createSphere(
+        // Add valve handle (sphere on top)
+        if (m_valveHandles) {
+            m_valveHandles->addInstance(partMatrix(item.pos3D + QVector3D(0, 1.2f, 0), QVector3D(0.4f, 0.4f, 0.4f)),
+                                        QColor(200, 100, 50));
+        } else {
+            createSphere(
                 QVector3D(0, 1.2, 0),
                 0.4f,
                 QColor(200, 100, 50),
                 valveEntity
             );
-            
-            m_valveEntities.append(valveEntity);
-            
-            Qt3DCore::QTransform *valveTransform = valveEntity->findChild<Qt3DCore::QTransform*>();
-            m_valveTransforms.append(valveTransform);
-            
-            // Store material reference for state updates
-            Qt3DExtras::QPhongMaterial *material = valveEntity->findChild<Qt3DExtras::QPhongMaterial*>();
-            m_valveMaterials.append(material);
         }
-    }
-}
-
-void LCUScene3D::createRefrigerantSystem()
-{
-    // Create 3 refrigerant loops
-    for (int i = 0; i < 3; ++i) {
-        float zPos = -5 + (i * 6);
         
+        m_valveEntities.append(valveEntity);
+        m_valveTransforms.append(valveEntity->findChild<Qt3DCore::QTransform*>());
+        m_valveParts.append(statePart(valveEntity, ValvePart));
+        m_valveChannels.append(item.model);
+        break;
+    }
+    case LayoutItem::HeatExchanger: {
         // Heat Exchanger (flat box)
         Qt3DCore::QEntity *heatExchanger = createBox(
-            QVector3D(5, 3, zPos),
+            item.pos3D,
             QVector3D(3, 4, 2),
             QColor(180, 180, 180),
             this
         );
-        m_heatExchangerEntities.append(heatExchanger);
-        
-        // Store material for state updates
-        Qt3DExtras::QPhongMaterial *heMaterial = heatExchanger->findChild<Qt3DExtras::QPhongMaterial*>();
-        m_heatExchangerMaterials.append(heMaterial);
         
+        m_heatExchangerEntities.append(heatExchanger);
+        m_heatExchangerParts.append(statePart(heatExchanger, HeatExchangerPart));
+        m_heatExchangerLoops.append(item.model);
+        break;
+    }
+    case LayoutItem::SolenoidValve: {
         // Solenoid Valve (small cylinder)
         Qt3DCore::QEntity *solenoidValve = createCylinder(
-            QVector3D(10, 3, zPos),
+            item.pos3D,
             0.5f,
             1.5f,
             QColor(100, 100, 150),
             this
         );
-        m_solenoidValveEntities.append(solenoidValve);
-        
-        // Store material for energized state visualization
-        Qt3DExtras::QPhongMaterial *svMaterial = solenoidValve->findChild<Qt3DExtras::QPhongMaterial*>();
-        m_solenoidValveMaterials.append(svMaterial);
         
+        m_solenoidValveEntities.append(solenoidValve);
+        m_solenoidValveParts.append(statePart(solenoidValve, SolenoidValvePart));
+        m_solenoidValveLoops.append(item.model);
+        break;
+    }
+    case LayoutItem::Condenser: {
         // Condenser (larger box with fins)
         Qt3DCore::QEntity *condenser = createBox(
-            QVector3D(15, 3, zPos),
+            item.pos3D,
             QVector3D(4, 5, 3),
             QColor(160, 160, 160),
             this
@@ -224,6 +339,11 @@ void LCUScene3D::createRefrigerantSystem()
         
         // Add condenser fins (small boxes)
         for (int j = 0; j < 5; ++j) {
+            if (m_condenserFins) {
+                m_condenserFins->addInstance(partMatrix(item.pos3D + QVector3D(-2 + j * 1, 0, 0), QVector3D(0.1f, 5, 3.5f)),
+                                             QColor(140, 140, 140));
+                continue;
+            }
             createBox(
                 QVector3D(-2 + j * 1, 0, 0),
                 QVector3D(0.1, 5, 3.5),
@@ -231,18 +351,19 @@ void LCUScene3D::createRefrigerantSystem()
                 condenser
             );
         }
-        m_condenserEntities.append(condenser);
-        
-        // Store material for state updates
-        Qt3DExtras::QPhongMaterial *condenserMaterial = condenser->findChild<Qt3DExtras::QPhongMaterial*>();
-        m_condenserMaterials.append(condenserMaterial);
         
+        m_condenserEntities.append(condenser);
+        m_condenserParts.append(statePart(condenser, CondenserPart));
+        m_condenserLoops.append(item.model);
+        break;
+    }
+    case LayoutItem::Blower: {
         // Blower (cylinder with cone for fan)
         Qt3DCore::QEntity *blowerEntity = new Qt3DCore::QEntity(this);
         
         // Blower housing
         Qt3DCore::QEntity *housing = createCylinder(
-            QVector3D(20, 3, zPos),
+            item.pos3D,
             1.5f,
             2.0f,
             QColor(80, 80, 120),
@@ -250,8 +371,16 @@ void LCUScene3D::createRefrigerantSystem()
         );
         
         // Fan blades (thin cylinders radiating from center)
-        for (int b = 0; b < 6; ++b) {
+        if (m_blowerBlades) {
+            m_blowerFirstBlade.append(m_blowerBlades->instanceCount());
+            m_blowerPositions.append(item.pos3D);
+        }
+        for (int b = 0; b < kBladesPerBlower; ++b) {
             float angle = b * 60.0f;
+            if (m_blowerBlades) {
+                m_blowerBlades->addInstance(bladeMatrix(item.pos3D, 0.0f, angle), QColor(120, 120, 120));
+                continue;
+            }
             Qt3DCore::QEntity *blade = createBox(
                 QVector3D(0, 0, 0),
                 QVector3D(1.5, 0.2, 0.3),
@@ -266,112 +395,83 @@ void LCUScene3D::createRefrigerantSystem()
         }
         
         m_blowerEntities.append(blowerEntity);
-        
-        Qt3DCore::QTransform *blowerTransform = housing->findChild<Qt3DCore::QTransform*>();
-        m_blowerTransforms.append(blowerTransform);
-        
-        // Store material for state updates
-        Qt3DExtras::QPhongMaterial *blowerMaterial = housing->findChild<Qt3DExtras::QPhongMaterial*>();
-        m_blowerMaterials.append(blowerMaterial);
+        m_blowerTransforms.append(housing->findChild<Qt3DCore::QTransform*>());
+        m_blowerParts.append(statePart(housing, BlowerPart));
+        m_blowerLoops.append(item.model);
+        break;
+    }
+    case LayoutItem::Pipe: {
+        // One straight run per path segment
+        for (int i = 1; i < item.path3D.size(); ++i) {
+            const QVector3D &start = item.path3D[i - 1];
+            const QVector3D &end = item.path3D[i];
+            if (m_pipeRuns) {
+                QMatrix4x4 matrix;
+                matrix.translate((start + end) / 2.0f);
+                matrix.rotate(pipeRotation(end - start));
+                matrix.scale(float(item.radius), (end - start).length(), float(item.radius));
+                m_pipeRuns->addInstance(matrix, item.color);
+            } else {
+                createPipe(start, end, float(item.radius), item.color, this);
+            }
+        }
+        break;
+    }
+    case LayoutItem::Label:
+    case LayoutItem::Panel:
+        // Schematic annotations have no 3D counterpart
+        break;
     }
 }
 
-void LCUScene3D::createPipingConnections()
+void LCUScene3D::setPropertyChangeCounting(bool enabled)
 {
-    // Main coolant pipe from tank
-    createPipe(
-        QVector3D(-15, 0, 0),
-        QVector3D(-15, 0, -6),
-        0.4f,
-        QColor(100, 150, 200),
-        this
-    );
-    
-    // Pipes connecting pumps
-    createPipe(
-        QVector3D(-15, 1.5, -6),
-        QVector3D(-9, 1.5, -6),
-        0.4f,
-        QColor(100, 150, 200),
-        this
-    );
-    
-    // Distribution manifold
-    createPipe(
-        QVector3D(-9, 1.5, -6),
-        QVector3D(-10, 2, 5),
-        0.4f,
-        QColor(100, 150, 200),
-        this
-    );
-    
-    // Channel pipes
-    for (int i = 0; i < 4; ++i) {
-        float xPos = -10 + (i * 5);
-        createPipe(
-            QVector3D(xPos, 2, 5),
-            QVector3D(xPos, 2, 10),
-            0.3f,
-            QColor(100, 150, 200),
-            this
-        );
+    for (const QMetaObject::Connection &connection : m_propertyConnections) {
+        disconnect(connection);
+    }
+    m_propertyConnections.clear();
+    if (!enabled) {
+        return;
     }
     
-    // Refrigerant pipes
-    for (int i = 0; i < 3; ++i) {
-        float zPos = -5 + (i * 6);
-        
-        // PHE to solenoid
-        createPipe(
-            QVector3D(5, 3, zPos),
-            QVector3D(10, 3, zPos),
-            0.25f,
-            QColor(200, 100, 100),
-            this
-        );
-        
-        // Solenoid to condenser
-        createPipe(
-            QVector3D(10, 3, zPos),
-            QVector3D(15, 3, zPos),
-            0.25f,
-            QColor(200, 100, 100),
-            this
-        );
-        
-        // Condenser to blower
-        createPipe(
-            QVector3D(15, 3, zPos),
-            QVector3D(20, 3, zPos),
-            0.25f,
-            QColor(200, 100, 100),
-            this
-        );
+    // Signal arguments are dropped, so one slot takes every notify signal
+    const QMetaMethod slot = metaObject()->method(metaObject()->indexOfSlot("countPropertyChange()"));
+    QList<Qt3DCore::QNode*> nodes = findChildren<Qt3DCore::QNode*>();
+    nodes.append(this);
+    for (Qt3DCore::QNode *node : nodes) {
+        const QMetaObject *meta = node->metaObject();
+        for (int i = 0; i < meta->propertyCount(); ++i) {
+            QMetaProperty property = meta->property(i);
+            if (property.hasNotifySignal()) {
+                m_propertyConnections.append(connect(node, property.notifySignal(), this, slot));
+            }
+        }
     }
 }
 
+void LCUScene3D::countPropertyChange()
+{
+    FrameStats::count(FrameStats::PropertyChanges3D);
+}
+
 void LCUScene3D::updateAnimations(double deltaTime)
 {
     if (!m_dataModel) return;
-    
-    bool systemRunning = m_dataModel->isSystemRunning();
+    updateAnimations(deltaTime, RenderSnapshot::capture(m_dataModel));
+}
+
+void LCUScene3D::updateAnimations(double deltaTime, const RenderSnapshot &state)
+{
+    bool systemRunning = state.systemRunning;
     
     // Update heater visual state
-    if (m_heaterMaterial) {
-        if (systemRunning) {
-            // Active heater - brighter red/orange glow
-            m_heaterMaterial->setDiffuse(QColor(255, 80, 20));
-            m_heaterMaterial->setAmbient(QColor(200, 50, 10));
-        } else {
-            // Inactive heater - dull red
-            m_heaterMaterial->setDiffuse(QColor(200, 50, 50));
-            m_heaterMaterial->setAmbient(QColor(150, 40, 40));
-        }
+    for (StatePart &heater : m_heaterParts) {
+        setPartState(heater, systemRunning);
     }
     
     // Update pump rotations and states
-    for (int i = 0; i < m_pumpEntities.size() && i < 2; ++i) {
-        bool pumpRunning = m_dataModel->getPumpState(i) && systemRunning;
+    for (int i = 0; i < m_pumpEntities.size(); ++i) {
+        bool pumpRunning = state.pumpState(m_pumpIndices[i]) && systemRunning;
         
         // Update pump rotation animation
         if (pumpRunning && m_pumpTransforms[i]) {
@@ -382,190 +482,137 @@ void LCUScene3D::updateAnimations(double deltaTime)
             m_pumpTransforms[i]->setRotationZ(m_pumpRotation);
         }
         
-        // Update pump color based on state
-        if (i < m_pumpMaterials.size() && m_pumpMaterials[i]) {
-            if (pumpRunning) {
-                // Running pump - brighter blue
-                m_pumpMaterials[i]->setDiffuse(QColor(100, 180, 240));
-                m_pumpMaterials[i]->setAmbient(QColor(80, 120, 160));
-            } else {
-                // Idle pump - dull blue
-                m_pumpMaterials[i]->setDiffuse(QColor(80, 120, 160));
-                m_pumpMaterials[i]->setAmbient(QColor(60, 90, 120));
-            }
-        }
+        setPartState(m_pumpParts[i], pumpRunning);
     }
     
-    // Update channel valves (3 per channel, matching 2D scene)
-    for (int ch = 0; ch < 4; ++ch) {
-        bool channelOpen = m_dataModel->getChannelState(ch);
-        
-        for (int v = 0; v < 3; ++v) {
-            int valveIndex = ch * 3 + v;
-            if (valveIndex < m_valveMaterials.size() && m_valveMaterials[valveIndex]) {
-                if (channelOpen && systemRunning) {
-                    // Open valve - green
-                    m_valveMaterials[valveIndex]->setDiffuse(QColor(50, 200, 50));
-                    m_valveMaterials[valveIndex]->setAmbient(QColor(40, 150, 40));
-                } else {
-                    // Closed valve - gray
-                    m_valveMaterials[valveIndex]->setDiffuse(QColor(120, 120, 120));
-                    m_valveMaterials[valveIndex]->setAmbient(QColor(90, 90, 90));
-                }
-            }
-        }
+    // Update channel valves
+    for (int i = 0; i < m_valveParts.size(); ++i) {
+        setPartState(m_valveParts[i], state.channelState(m_valveChannels[i]) && systemRunning);
     }
     
-    // Update refrigerant system (3 loops)
-    for (int i = 0; i < 3; ++i) {
-        bool compressorRunning = m_dataModel->getCompressorState(i);
-        bool solenoidOpen = m_dataModel->getSolenoidValveState(i);
-        bool blowerRunning = m_dataModel->getBlowerState(i);
-        
-        // Update heat exchanger state
-        if (i < m_heatExchangerMaterials.size() && m_heatExchangerMaterials[i]) {
-            if (compressorRunning) {
-                // Active heat exchanger - cyan tint
-                m_heatExchangerMaterials[i]->setDiffuse(QColor(150, 220, 250));
-                m_heatExchangerMaterials[i]->setAmbient(QColor(120, 180, 200));
-            } else {
-                // Inactive heat exchanger - gray
-                m_heatExchangerMaterials[i]->setDiffuse(QColor(180, 180, 180));
-                m_heatExchangerMaterials[i]->setAmbient(QColor(140, 140, 140));
-            }
-        }
-        
-        // Update solenoid valve state (energized visualization)
-        if (i < m_solenoidValveMaterials.size() && m_solenoidValveMaterials[i]) {
-            if (solenoidOpen) {
-                // Energized solenoid - bright yellow/green
-                m_solenoidValveMaterials[i]->setDiffuse(QColor(150, 255, 100));
-                m_solenoidValveMaterials[i]->setAmbient(QColor(100, 200, 70));
-            } else {
-                // De-energized solenoid - dark blue
-                m_solenoidValveMaterials[i]->setDiffuse(QColor(100, 100, 150));
-                m_solenoidValveMaterials[i]->setAmbient(QColor(70, 70, 110));
-            }
-        }
-        
-        // Update condenser state
-        if (i < m_condenserMaterials.size() && m_condenserMaterials[i]) {
-            if (compressorRunning) {
-                // Active condenser - warmer color
-                m_condenserMaterials[i]->setDiffuse(QColor(200, 180, 160));
-                m_condenserMaterials[i]->setAmbient(QColor(160, 140, 120));
-            } else {
-                // Inactive condenser - gray
-                m_condenserMaterials[i]->setDiffuse(QColor(160, 160, 160));
-                m_condenserMaterials[i]->setAmbient(QColor(120, 120, 120));
-            }
-        }
+    // Update heat exchanger and condenser state
+    for (int i = 0; i < m_heatExchangerParts.size(); ++i) {
+        setPartState(m_heatExchangerParts[i], state.compressorState(m_heatExchangerLoops[i]));
+    }
+    for (int i = 0; i < m_condenserParts.size(); ++i) {
+        setPartState(m_condenserParts[i], state.compressorState(m_condenserLoops[i]));
+    }
+    
+    // Update solenoid valve state (energized visualization)
+    for (int i = 0; i < m_solenoidValveParts.size(); ++i) {
+        setPartState(m_solenoidValveParts[i], state.solenoidValveState(m_solenoidValveLoops[i]));
+    }
+    
+    // Update blower rotation and state
+    for (int i = 0; i < m_blowerEntities.size(); ++i) {
+        bool blowerRunning = state.blowerState(m_blowerLoops[i]);
         
-        // Update blower rotation and state
-        if (i < m_blowerEntities.size()) {
-            if (blowerRunning && i < m_blowerTransforms.size() && m_blowerTransforms[i]) {
-                // Animate blower rotation (faster than pumps)
-                m_blowerRotation += deltaTime * 360.0;
-                if (m_blowerRotation >= 360.0) {
-                    m_blowerRotation -= 360.0;
-                }
-                m_blowerTransforms[i]->setRotationY(m_blowerRotation);
+        if (blowerRunning && m_blowerTransforms[i]) {
+            // Animate blower rotation (faster than pumps)
+            m_blowerRotation += deltaTime * 360.0;
+            if (m_blowerRotation >= 360.0) {
+                m_blowerRotation -= 360.0;
             }
+            m_blowerTransforms[i]->setRotationY(m_blowerRotation);
             
-            // Update blower color based on state
-            if (i < m_blowerMaterials.size() && m_blowerMaterials[i]) {
-                if (blowerRunning) {
-                    // Running blower - brighter blue
-                    m_blowerMaterials[i]->setDiffuse(QColor(100, 140, 200));
-                    m_blowerMaterials[i]->setAmbient(QColor(80, 100, 150));
-                } else {
-                    // Idle blower - dark blue
-                    m_blowerMaterials[i]->setDiffuse(QColor(80, 80, 120));
-                    m_blowerMaterials[i]->setAmbient(QColor(60, 60, 90));
+            if (m_blowerBlades) {
+                for (int b = 0; b < kBladesPerBlower; ++b) {
+                    m_blowerBlades->setTransform(m_blowerFirstBlade[i] + b,
+                                                 bladeMatrix(m_blowerPositions[i], float(m_blowerRotation), b * 60.0f));
                 }
             }
         }
+        
+        setPartState(m_blowerParts[i], blowerRunning);
+    }
+    
+    // One upload for every blade that turned
+    if (m_blowerBlades) {
+        m_blowerBlades->commit();
     }
 }
 
+void LCUScene3D::setPartState(StatePart &part, bool on)
+{
+    int state = on ? 1 : 0;
+    if (part.material) {
+        // A material of its own is recoloured every frame
+        part.material->setDiffuse(kLooks[part.type][state].diffuse);
+        part.material->setAmbient(kLooks[part.type][state].ambient);
+        FrameStats::count(FrameStats::MaterialUpdates3D);
+        return;
+    }
+    
+    // A shared look is only swapped when the state changes
+    if (state == part.state || !m_looks[part.type][state]) {
+        return;
+    }
+    if (part.state >= 0) {
+        part.entity->removeComponent(m_looks[part.type][part.state]);
+    }
+    part.entity->addComponent(m_looks[part.type][state]);
+    part.state = state;
+    FrameStats::count(FrameStats::MaterialUpdates3D);
+}
+
 // Helper methods for creating 3D objects
 
 Qt3DCore::QEntity* LCUScene3D::createCylinder(const QVector3D &position, float radius, 
                                                 float length, const QColor &color, 
                                                 Qt3DCore::QEntity *parent)
 {
-    if (!parent) parent = this;
-    
-    Qt3DCore::QEntity *entity = new Qt3DCore::QEntity(parent);
-    
-    Qt3DExtras::QCylinderMesh *mesh = new Qt3DExtras::QCylinderMesh();
-    mesh->setRadius(radius);
-    mesh->setLength(length);
-    mesh->setRings(20);
-    mesh->setSlices(20);
-    
-    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial();
-    material->setDiffuse(color);
-    material->setAmbient(color.darker(120));
-    material->setSpecular(QColor(255, 255, 255));
-    material->setShininess(50.0f);
-    
-    Qt3DCore::QTransform *transform = new Qt3DCore::QTransform();
-    transform->setTranslation(position);
-    
-    entity->addComponent(mesh);
-    entity->addComponent(material);
-    entity->addComponent(transform);
-    
-    return entity;
+    return createEntity(cylinderMesh(radius, length, 20, 20),
+                        phongMaterial(color, QColor(255, 255, 255), 50.0f), position, parent);
 }
 
 Qt3DCore::QEntity* LCUScene3D::createBox(const QVector3D &position, const QVector3D &size, 
                                           const QColor &color, Qt3DCore::QEntity *parent)
 {
-    if (!parent) parent = this;
-    
-    Qt3DCore::QEntity *entity = new Qt3DCore::QEntity(parent);
-    
-    Qt3DExtras::QCuboidMesh *mesh = new Qt3DExtras::QCuboidMesh();
-    mesh->setXExtent(size.x());
-    mesh->setYExtent(size.y());
-    mesh->setZExtent(size.z());
-    
-    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial();
-    material->setDiffuse(color);
-    material->setAmbient(color.darker(120));
-    material->setSpecular(QColor(255, 255, 255));
-    material->setShininess(50.0f);
-    
-    Qt3DCore::QTransform *transform = new Qt3DCore::QTransform();
-    transform->setTranslation(position);
+    return createEntity(cuboidMesh(size), phongMaterial(color, QColor(255, 255, 255), 50.0f), position, parent);
+}
+
+Qt3DCore::QEntity* LCUScene3D::createSphere(const QVector3D &position, float radius, 
+                                             const QColor &color, Qt3DCore::QEntity *parent)
+{
+    return createEntity(sphereMesh(radius, 20, 20),
+                        phongMaterial(color, QColor(255, 255, 255), 50.0f), position, parent);
+}
+
+Qt3DCore::QEntity* LCUScene3D::createPipe(const QVector3D &start, const QVector3D &end, 
+                                           float radius, const QColor &color, 
+                                           Qt3DCore::QEntity *parent)
+{
+    QVector3D direction = end - start;
+    float length = direction.length();
+    QVector3D center = (start + end) / 2.0f;
     
-    entity->addComponent(mesh);
-    entity->addComponent(material);
-    entity->addComponent(transform);
+    // A unit-length run stretched by the transform, so every pipe of one
+    // radius shares a mesh
+    Qt3DCore::QEntity *entity = createEntity(cylinderMesh(radius, 1.0f, 10, 12),
+                                             phongMaterial(color, QColor(200, 200, 200), 30.0f),
+                                             center, parent);
+    Qt3DCore::QTransform *transform = entity->findChild<Qt3DCore::QTransform*>();
+    transform->setScale3D(QVector3D(1.0f, length, 1.0f));
+    transform->setRotation(pipeRotation(direction));
     
     return entity;
 }
 
-Qt3DCore::QEntity* LCUScene3D::createSphere(const QVector3D &position, float radius, 
-                                             const QColor &color, Qt3DCore::QEntity *parent)
+Qt3DCore::QEntity* LCUScene3D::createTorus(const QVector3D &position, float radius, 
+                                            float minorRadius, const QColor &color, 
+                                            Qt3DCore::QEntity *parent)
+{
+    return createEntity(torusMesh(radius, minorRadius, 30, 30),
+                        phongMaterial(color, QColor(255, 255, 255), 50.0f), position, parent);
+}
+
+Qt3DCore::QEntity* LCUScene3D::createEntity(Qt3DRender::QGeometryRenderer *mesh, Qt3DRender::QMaterial *material,
+                                             const QVector3D &position, Qt3DCore::QEntity *parent)
 {
     if (!parent) parent = this;
     
     Qt3DCore::QEntity *entity = new Qt3DCore::QEntity(parent);
     
-    Qt3DExtras::QSphereMesh *mesh = new Qt3DExtras::QSphereMesh();
-    mesh->setRadius(radius);
-    mesh->setRings(20);
-    mesh->setSlices(20);
-    
-    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial();
-    material->setDiffuse(color);
-    material->setAmbient(color.darker(120));
-    material->setSpecular(QColor(255, 255, 255));
-    material->setShininess(50.0f);
-    
     Qt3DCore::QTransform *transform = new Qt3DCore::QTransform();
     transform->setTranslation(position);
     
@@ -576,78 +623,161 @@ Qt3DCore::QEntity* LCUScene3D::createSphere(const QVector3D &position, float rad
     return entity;
 }
 
-Qt3DCore::QEntity* LCUScene3D::createPipe(const QVector3D &start, const QVector3D &end, 
-                                           float radius, const QColor &color, 
-                                           Qt3DCore::QEntity *parent)
+Qt3DRender::QGeometryRenderer* LCUScene3D::cylinderMesh(float radius, float length, int rings, int slices)
 {
-    if (!parent) parent = this;
-    
-    QVector3D direction = end - start;
-    float length = direction.length();
-    QVector3D center = (start + end) / 2.0f;
-    
-    Qt3DCore::QEntity *entity = new Qt3DCore::QEntity(parent);
+    const QString key = QString("cylinder %1 %2 %3 %4").arg(radius).arg(length).arg(rings).arg(slices);
+    if (Qt3DRender::QGeometryRenderer *mesh = cachedMesh(key)) {
+        return mesh;
+    }
     
-    Qt3DExtras::QCylinderMesh *mesh = new Qt3DExtras::QCylinderMesh();
+    Qt3DExtras::QCylinderMesh *mesh = new Qt3DExtras::QCylinderMesh(this);
     mesh->setRadius(radius);
     mesh->setLength(length);
-    mesh->setRings(10);
-    mesh->setSlices(12);
+    mesh->setRings(rings);
+    mesh->setSlices(slices);
     
-    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial();
-    material->setDiffuse(color);
-    material->setAmbient(color.darker(120));
-    material->setSpecular(QColor(200, 200, 200));
-    material->setShininess(30.0f);
-    
-    Qt3DCore::QTransform *transform = new Qt3DCore::QTransform();
-    transform->setTranslation(center);
-    
-    // Calculate rotation to align pipe with direction vector
-    QVector3D yAxis(0, 1, 0);
-    direction.normalize();
+    // Side rings plus two capped fans
+    addMesh(key, mesh, meshBytes(qint64(rings) * (slices + 1) + 2 * (slices + 2),
+                                 qint64(slices) * (rings - 1) * 6 + slices * 6));
+    return mesh;
+}
+
+Qt3DRender::QGeometryRenderer* LCUScene3D::cuboidMesh(const QVector3D &size)
+{
+    const QString key = QString("cuboid %1 %2 %3").arg(size.x()).arg(size.y()).arg(size.z());
+    if (Qt3DRender::QGeometryRenderer *mesh = cachedMesh(key)) {
+        return mesh;
+    }
     
-    // Calculate rotation axis and angle
-    QVector3D rotationAxis = QVector3D::crossProduct(yAxis, direction);
-    float rotationAngle = qRadiansToDegrees(qAcos(QVector3D::dotProduct(yAxis, direction)));
+    Qt3DExtras::QCuboidMesh *mesh = new Qt3DExtras::QCuboidMesh(this);
+    mesh->setXExtent(size.x());
+    mesh->setYExtent(size.y());
+    mesh->setZExtent(size.z());
     
-    if (rotationAxis.length() > 0.001f) {
-        transform->setRotation(QQuaternion::fromAxisAndAngle(rotationAxis, rotationAngle));
+    // Six faces of 2x2 vertices
+    addMesh(key, mesh, meshBytes(24, 36));
+    return mesh;
+}
+
+Qt3DRender::QGeometryRenderer* LCUScene3D::sphereMesh(float radius, int rings, int slices)
+{
+    const QString key = QString("sphere %1 %2 %3").arg(radius).arg(rings).arg(slices);
+    if (Qt3DRender::QGeometryRenderer *mesh = cachedMesh(key)) {
+        return mesh;
     }
     
-    entity->addComponent(mesh);
-    entity->addComponent(material);
-    entity->addComponent(transform);
+    Qt3DExtras::QSphereMesh *mesh = new Qt3DExtras::QSphereMesh(this);
+    mesh->setRadius(radius);
+    mesh->setRings(rings);
+    mesh->setSlices(slices);
     
-    return entity;
+    addMesh(key, mesh, meshBytes(qint64(rings + 1) * (slices + 1), qint64(slices) * (rings - 1) * 6));
+    return mesh;
 }
 
-Qt3DCore::QEntity* LCUScene3D::createTorus(const QVector3D &position, float radius, 
-                                            float minorRadius, const QColor &color, 
-                                            Qt3DCore::QEntity *parent)
+Qt3DRender::QGeometryRenderer* LCUScene3D::torusMesh(float radius, float minorRadius, int rings, int slices)
 {
-    if (!parent) parent = this;
-    
-    Qt3DCore::QEntity *entity = new Qt3DCore::QEntity(parent);
+    const QString key = QString("torus %1 %2 %3 %4").arg(radius).arg(minorRadius).arg(rings).arg(slices);
+    if (Qt3DRender::QGeometryRenderer *mesh = cachedMesh(key)) {
+        return mesh;
+    }
     
-    Qt3DExtras::QTorusMesh *mesh = new Qt3DExtras::QTorusMesh();
+    Qt3DExtras::QTorusMesh *mesh = new Qt3DExtras::QTorusMesh(this);
     mesh->setRadius(radius);
     mesh->setMinorRadius(minorRadius);
-    mesh->setRings(30);
-    mesh->setSlices(30);
+    mesh->setRings(rings);
+    mesh->setSlices(slices);
     
-    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial();
+    addMesh(key, mesh, meshBytes(qint64(rings + 1) * (slices + 1), qint64(rings) * slices * 6));
+    return mesh;
+}
+
+Qt3DRender::QGeometryRenderer* LCUScene3D::cachedMesh(const QString &key)
+{
+    return s_resourceSharing ? m_meshes.value(key) : nullptr;
+}
+
+void LCUScene3D::addMesh(const QString &key, Qt3DRender::QGeometryRenderer *mesh, qint64 bytes)
+{
+    m_geometryBytes += bytes;
+    if (s_resourceSharing) {
+        m_meshes.insert(key, mesh);
+    }
+}
+
+Qt3DExtras::QPhongMaterial* LCUScene3D::phongMaterial(const QColor &color, const QColor &specular, float shininess)
+{
+    const QString key = QString("%1 %2 %3").arg(color.rgba()).arg(specular.rgba()).arg(shininess);
+    if (s_resourceSharing) {
+        if (Qt3DExtras::QPhongMaterial *material = m_materials.value(key)) {
+            return material;
+        }
+    }
+    
+    Qt3DExtras::QPhongMaterial *material = new Qt3DExtras::QPhongMaterial(this);
     material->setDiffuse(color);
     material->setAmbient(color.darker(120));
-    material->setSpecular(QColor(255, 255, 255));
-    material->setShininess(50.0f);
+    material->setSpecular(specular);
+    material->setShininess(shininess);
     
-    Qt3DCore::QTransform *transform = new Qt3DCore::QTransform();
-    transform->setTranslation(position);
+    if (s_resourceSharing) {
+        m_materials.insert(key, material);
+    }
+    return material;
+}
+
+LCUScene3D::StatePart LCUScene3D::statePart(Qt3DCore::QEntity *entity, PartType type)
+{
+    StatePart part;
+    part.entity = entity;
+    part.type = type;
     
-    entity->addComponent(mesh);
-    entity->addComponent(material);
-    entity->addComponent(transform);
+    QVector<Qt3DExtras::QPhongMaterial*> materials = entity->componentsOfType<Qt3DExtras::QPhongMaterial>();
+    if (materials.isEmpty()) {
+        return part;
+    }
     
-    return entity;
+    Qt3DExtras::QPhongMaterial *shared = materials.first();
+    if (!s_resourceSharing) {
+        part.material = shared;
+        return part;
+    }
+    
+    // Starts out in the off look
+    entity->removeComponent(shared);
+    entity->addComponent(m_looks[type][0]);
+    part.state = 0;
+    
+    // Palette colours only model-driven parts use would be left orphaned
+    if (shared->entities().isEmpty()) {
+        m_materials.remove(m_materials.key(shared));
+        delete shared;
+    }
+    return part;
+}
+
+LCUScene3D::Statistics LCUScene3D::statistics() const
+{
+    Statistics statistics;
+    statistics.entities = findChildren<Qt3DCore::QEntity*>().size();
+    statistics.meshes = findChildren<Qt3DRender::QGeometryRenderer*>().size();
+    statistics.materials = findChildren<Qt3DRender::QMaterial*>().size();
+    statistics.geometryBytes = m_geometryBytes;
+    
+    // Instance buffers: a matrix and a colour per copy
+    for (InstancedParts *parts : { m_valveHandles, m_condenserFins, m_blowerBlades, m_pipeRuns }) {
+        if (parts) {
+            statistics.geometryBytes += qint64(parts->instanceCount()) * 20 * sizeof(float);
+        }
+    }
+    
+    for (Qt3DCore::QEntity *entity : findChildren<Qt3DCore::QEntity*>()) {
+        QVector<Qt3DRender::QGeometryRenderer*> renderers = entity->componentsOfType<Qt3DRender::QGeometryRenderer>();
+        if (renderers.isEmpty() || !entity->isEnabled()) {
+            continue;
+        }
+        statistics.drawCalls++;
+        statistics.instances += qMax(1, renderers.first()->instanceCount());
+    }
+    return statistics;
 }
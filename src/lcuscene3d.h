@@ -8,8 +8,14 @@
 #include <Qt3DRender/QCamera>
 #include <Qt3DRender/QPointLight>
 #include <QVector>
+#include <QHash>
+#include <QMetaObject>
+#include "rendersnapshot.h"
 
 class DataModel;
+class InstancedParts;
+struct LayoutItem;
+struct PlantLayout;
 
 namespace Qt3DCore {
     class QEntity;
@@ -19,6 +25,7 @@ namespace Qt3DCore {
 namespace Qt3DRender {
     class QMaterial;
     class QMesh;
+    class QGeometryRenderer;
 }
 
 namespace Qt3DExtras {
@@ -34,20 +41,53 @@ class LCUScene3D : public Qt3DCore::QEntity
     Q_OBJECT
 
 public:
+    // Builds the stock unit, or the given plant layout
     explicit LCUScene3D(DataModel *dataModel, Qt3DCore::QEntity *parent = nullptr);
+    LCUScene3D(DataModel *dataModel, const PlantLayout &layout, Qt3DCore::QEntity *parent = nullptr);
     
+    // Draws the model as it is now, or as the given (interpolated) state
     void updateAnimations(double deltaTime);
+    void updateAnimations(double deltaTime, const RenderSnapshot &state);
     void setupCamera(Qt3DRender::QCamera *camera);
+    
+    // Counts the notify signals of the scene's nodes, which mark them for
+    // syncing to the Qt3D backend; connected only while enabled. Two limits:
+    // only nodes that exist when it is enabled are connected (the scene
+    // builds all of its nodes up front), and a write that notifies several
+    // properties counts once per signal, e.g. a transform's rotationZ also
+    // notifies rotation and matrix. Treat it as an upper bound on writes.
+    void setPropertyChangeCounting(bool enabled);
+    
+    // Size of the built scene; geometry bytes are estimated from the mesh
+    // parameters, as the vertex buffers are only generated by the backend
+    struct Statistics {
+        int entities = 0;
+        int meshes = 0;
+        int materials = 0;
+        qint64 geometryBytes = 0;
+        int drawCalls = 0;      // per render pass; one per enabled mesh entity
+        int instances = 0;      // parts drawn by those calls
+    };
+    Statistics statistics() const;
+    
+    // Identical parts share one mesh per set of primitive parameters and
+    // one material per colour; off gives every part its own (for comparisons)
+    static void setResourceSharing(bool enabled) { s_resourceSharing = enabled; }
+    static bool isResourceSharing() { return s_resourceSharing; }
+    
+    // Valve handles, condenser fins, blower blades and pipes drawn as one
+    // instanced draw call per part type; takes effect for scenes built later
+    static void setInstancing(bool enabled) { s_instancing = enabled; }
+    static bool isInstancing() { return s_instancing; }
+
+private slots:
+    void countPropertyChange();
 
 private:
-    void setupScene();
+    void setupScene(const PlantLayout &layout);
     void setupLighting();
-    void createCoolantSystem();
-    void createRefrigerantSystem();
-    void createChannelSystem();
-    void createPipingConnections();
-    void createLabels();
     void createFloor();
+    void createItem(const LayoutItem &item);
     
     // Helper methods for creating 3D objects
     Qt3DCore::QEntity* createCylinder(const QVector3D &position, float radius, float length, 
@@ -60,6 +100,40 @@ private:
                                    float radius, const QColor &color, Qt3DCore::QEntity *parent = nullptr);
     Qt3DCore::QEntity* createTorus(const QVector3D &position, float radius, float minorRadius,
                                     const QColor &color, Qt3DCore::QEntity *parent = nullptr);
+    Qt3DCore::QEntity* createEntity(Qt3DRender::QGeometryRenderer *mesh, Qt3DRender::QMaterial *material,
+                                    const QVector3D &position, Qt3DCore::QEntity *parent);
+    
+    // Cached meshes and the material palette, owned by the scene
+    Qt3DRender::QGeometryRenderer* cylinderMesh(float radius, float length, int rings, int slices);
+    Qt3DRender::QGeometryRenderer* cuboidMesh(const QVector3D &size);
+    Qt3DRender::QGeometryRenderer* sphereMesh(float radius, int rings, int slices);
+    Qt3DRender::QGeometryRenderer* torusMesh(float radius, float minorRadius, int rings, int slices);
+    Qt3DRender::QGeometryRenderer* cachedMesh(const QString &key);
+    void addMesh(const QString &key, Qt3DRender::QGeometryRenderer *mesh, qint64 bytes);
+    Qt3DExtras::QPhongMaterial* phongMaterial(const QColor &color, const QColor &specular, float shininess);
+    
+    // Parts whose colour follows the model, each shown in one of two looks
+    enum PartType {
+        HeaterPart,
+        PumpPart,
+        ValvePart,
+        HeatExchangerPart,
+        SolenoidValvePart,
+        CondenserPart,
+        BlowerPart,
+        PartTypeCount
+    };
+    
+    // With sharing a part wears one of its type's shared looks, swapped only
+    // when its state changes; without, it recolours a material of its own
+    struct StatePart {
+        Qt3DCore::QEntity *entity = nullptr;
+        Qt3DExtras::QPhongMaterial *material = nullptr;    // own material, or null
+        PartType type = HeaterPart;
+        int state = -1;                                     // look worn; -1 before the first update
+    };
+    StatePart statePart(Qt3DCore::QEntity *entity, PartType type);
+    void setPartState(StatePart &part, bool on);
     
     DataModel *m_dataModel;
     
@@ -67,37 +141,60 @@ private:
     Qt3DCore::QEntity *m_rootEntity;
     Qt3DCore::QEntity *m_lightEntity;
     
-    // Coolant system components
-    Qt3DCore::QEntity *m_tankEntity;
-    Qt3DExtras::QPhongMaterial *m_tankMaterial;
-    Qt3DCore::QEntity *m_heaterEntity;
-    Qt3DExtras::QPhongMaterial *m_heaterMaterial;
+    // Coolant system components; the index vectors hold the DataModel
+    // pump, channel or loop each entity follows
+    QVector<StatePart> m_heaterParts;
     QVector<Qt3DCore::QEntity*> m_pumpEntities;
     QVector<Qt3DCore::QTransform*> m_pumpTransforms;
-    QVector<Qt3DExtras::QPhongMaterial*> m_pumpMaterials;
-    QVector<Qt3DCore::QEntity*> m_coolantPipeEntities;
+    QVector<StatePart> m_pumpParts;
+    QVector<int> m_pumpIndices;
     
     // Channel system
     QVector<Qt3DCore::QEntity*> m_valveEntities;
     QVector<Qt3DCore::QTransform*> m_valveTransforms;
-    QVector<Qt3DExtras::QPhongMaterial*> m_valveMaterials;
-    QVector<Qt3DCore::QEntity*> m_channelPipeEntities;
+    QVector<StatePart> m_valveParts;
+    QVector<int> m_valveChannels;
     
     // Refrigerant system
     QVector<Qt3DCore::QEntity*> m_heatExchangerEntities;
-    QVector<Qt3DExtras::QPhongMaterial*> m_heatExchangerMaterials;
+    QVector<StatePart> m_heatExchangerParts;
+    QVector<int> m_heatExchangerLoops;
     QVector<Qt3DCore::QEntity*> m_condenserEntities;
-    QVector<Qt3DExtras::QPhongMaterial*> m_condenserMaterials;
+    QVector<StatePart> m_condenserParts;
+    QVector<int> m_condenserLoops;
     QVector<Qt3DCore::QEntity*> m_blowerEntities;
     QVector<Qt3DCore::QTransform*> m_blowerTransforms;
-    QVector<Qt3DExtras::QPhongMaterial*> m_blowerMaterials;
+    QVector<StatePart> m_blowerParts;
+    QVector<int> m_blowerLoops;
     QVector<Qt3DCore::QEntity*> m_solenoidValveEntities;
-    QVector<Qt3DExtras::QPhongMaterial*> m_solenoidValveMaterials;
-    QVector<Qt3DCore::QEntity*> m_refrigerantPipeEntities;
+    QVector<StatePart> m_solenoidValveParts;
+    QVector<int> m_solenoidValveLoops;
     
     // Animation tracking
     double m_pumpRotation;
     double m_blowerRotation;
+    
+    // Instanced parts, or null without instancing; the blades of blower i
+    // start at m_blowerFirstBlade[i] and turn about m_blowerPositions[i]
+    InstancedParts *m_valveHandles;
+    InstancedParts *m_condenserFins;
+    InstancedParts *m_blowerBlades;
+    InstancedParts *m_pipeRuns;
+    QVector<int> m_blowerFirstBlade;
+    QVector<QVector3D> m_blowerPositions;
+    
+    // Notify signals connected while counting property changes
+    QVector<QMetaObject::Connection> m_propertyConnections;
+    
+    QHash<QString, Qt3DRender::QGeometryRenderer*> m_meshes;
+    QHash<QString, Qt3DExtras::QPhongMaterial*> m_materials;
+    
+    // Shared off and on looks of each part type, or null without sharing
+    Qt3DExtras::QPhongMaterial *m_looks[PartTypeCount][2];
+    qint64 m_geometryBytes;
+    
+    static bool s_resourceSharing;
+    static bool s_instancing;
 };
 
 #endif // LCUSCENE3D_H
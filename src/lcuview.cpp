@@ -0,0 +1,131 @@
+#include "lcuview.h"
+#include "tilerenderer.h"
+#include "components/basecomponent.h"
+#include "framestats.h"
+#include <QLabel>
+#include <QPainter>
+#include <QPaintEvent>
+
+namespace {
+    const qint64 kOverlayRefreshMs = 500;
+}
+
+LCUView::LCUView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent)
+    , m_overlay(false)
+    , m_overlayLabel(new QLabel(this))
+    , m_tileRenderer(nullptr)
+{
+    // Opaque, so refreshing the label never dirties the viewport underneath
+    m_overlayLabel->setAutoFillBackground(true);
+    m_overlayLabel->setStyleSheet("QLabel { background-color: rgb(40, 40, 40); color: white; padding: 4px; "
+                                  "font-family: monospace; }");
+    m_overlayLabel->hide();
+    
+    m_windowTimer.start();
+}
+
+LCUView::~LCUView()
+{
+    delete m_tileRenderer;
+}
+
+void LCUView::setTiledRendering(bool enabled)
+{
+    if (enabled == isTiledRendering()) {
+        return;
+    }
+    
+    if (enabled) {
+        m_tileRenderer = new TileRenderer(this);
+    } else {
+        delete m_tileRenderer;
+        m_tileRenderer = nullptr;
+    }
+    viewport()->update();
+}
+
+void LCUView::setRepaintOverlay(bool enabled)
+{
+    m_overlay = enabled;
+    m_overlayLabel->setVisible(enabled);
+    m_window = RepaintStats();
+    m_windowTimer.restart();
+    updateOverlayLabel();
+    
+    // Clear or start the tint everywhere
+    viewport()->update();
+}
+
+void LCUView::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+    quint64 itemsBefore = BaseComponent::totalPaints();
+    if (m_tileRenderer) {
+        QPainter painter(viewport());
+        painter.setClipRegion(event->region());
+        m_tileRenderer->paint(&painter, event->region());
+    } else {
+        QGraphicsView::paintEvent(event);
+    }
+    
+    RepaintStats frame;
+    frame.frames = 1;
+    frame.items = BaseComponent::totalPaints() - itemsBefore;
+    FrameStats::record(FrameStats::Paint, paintTimer.nsecsElapsed());
+    FrameStats::count(FrameStats::RepaintedItems, frame.items);
+    
+    double ratio = viewport()->devicePixelRatioF();
+    double area = 0.0;
+    for (const QRect &rect : event->region()) {
+        area += double(rect.width()) * rect.height();
+    }
+    frame.pixels = quint64(area * ratio * ratio);
+    frame.viewPixels = quint64(double(viewport()->width()) * viewport()->height() * ratio * ratio);
+    
+    for (RepaintStats *stats : { &m_total, &m_window }) {
+        stats->frames += frame.frames;
+        stats->pixels += frame.pixels;
+        stats->items += frame.items;
+        stats->viewPixels += frame.viewPixels;
+    }
+    
+    if (m_overlay) {
+        QPainter painter(viewport());
+        painter.setPen(QPen(QColor(255, 0, 0, 160), 1));
+        painter.setBrush(QColor(255, 0, 0, 40));
+        for (const QRect &rect : event->region()) {
+            painter.drawRect(rect.adjusted(0, 0, -1, -1));
+        }
+        
+        if (m_windowTimer.elapsed() >= kOverlayRefreshMs) {
+            updateOverlayLabel();
+        }
+    }
+}
+
+void LCUView::resizeEvent(QResizeEvent *event)
+{
+    QGraphicsView::resizeEvent(event);
+    m_overlayLabel->move(viewport()->geometry().topLeft() + QPoint(8, 8));
+}
+
+void LCUView::updateOverlayLabel()
+{
+    double seconds = qMax(1e-3, m_windowTimer.elapsed() / 1000.0);
+    double frames = qMax<quint64>(1, m_window.frames);
+    double coverage = m_window.viewPixels > 0 ? 100.0 * m_window.pixels / m_window.viewPixels : 0.0;
+    
+    m_overlayLabel->setText(QString("Repaints: %1 frames/s\n"
+                                    "Items:     %2 per frame\n"
+                                    "Pixels:    %3 k per frame (%4% of view)")
+                                .arg(m_window.frames / seconds, 0, 'f', 1)
+                                .arg(m_window.items / frames, 0, 'f', 1)
+                                .arg(m_window.pixels / frames / 1000.0, 0, 'f', 1)
+                                .arg(coverage, 0, 'f', 1));
+    m_overlayLabel->adjustSize();
+    
+    m_window = RepaintStats();
+    m_windowTimer.restart();
+}
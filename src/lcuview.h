@@ -0,0 +1,54 @@
+#ifndef LCUVIEW_H
+#define LCUVIEW_H
+
+#include <QGraphicsView>
+#include <QElapsedTimer>
+
+class QLabel;
+class TileRenderer;
+
+// Graphics view that measures how much of the viewport each frame repaints
+class LCUView : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    struct RepaintStats {
+        quint64 frames = 0;
+        quint64 pixels = 0;     // device pixels
+        quint64 items = 0;      // component paints
+        quint64 viewPixels = 0; // device pixels of the whole viewport, summed per frame
+    };
+    
+    explicit LCUView(QGraphicsScene *scene, QWidget *parent = nullptr);
+    ~LCUView();
+    
+    // Tints each repainted region and shows per-frame counts
+    void setRepaintOverlay(bool enabled);
+    bool repaintOverlay() const { return m_overlay; }
+    
+    // Rasterize the scene in tiles on all cores instead of on the GUI thread
+    void setTiledRendering(bool enabled);
+    bool isTiledRendering() const { return m_tileRenderer != nullptr; }
+    TileRenderer *tileRenderer() const { return m_tileRenderer; }
+    
+    RepaintStats repaintStats() const { return m_total; }
+    void resetRepaintStats() { m_total = RepaintStats(); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void updateOverlayLabel();
+    
+    bool m_overlay;
+    QLabel *m_overlayLabel;
+    TileRenderer *m_tileRenderer;
+    
+    RepaintStats m_total;
+    RepaintStats m_window;      // since the overlay label was last refreshed
+    QElapsedTimer m_windowTimer;
+};
+
+#endif // LCUVIEW_H
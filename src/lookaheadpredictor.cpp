@@ -0,0 +1,229 @@
+#include "lookaheadpredictor.h"
+#include "datamodel.h"
+#include <QRunnable>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMetaObject>
+
+namespace {
+    // Samples per chunk posted back to the GUI thread
+    const int kSamplesPerChunk = 12;
+    
+    PredictionSample sampleModel(const DataModel &model, double time)
+    {
+        PredictionSample sample;
+        sample.time = time;
+        sample.supplyTemp = model.getSupplyTemp();
+        sample.returnTemp = model.getReturnTemp();
+        sample.systemPressure = model.getSystemPressure();
+        sample.flowRate = model.getFlowRate();
+        sample.tankLevel = model.getTankLevel();
+        return sample;
+    }
+}
+
+// Runs one fork to its horizon on a pool thread
+class PredictionRunner : public QRunnable
+{
+public:
+    PredictionRunner(LookAheadPredictor *predictor, int forkId, const DataModelState &state,
+                     LookAheadPredictor::Modification modification, double horizon,
+                     double sampleInterval, std::shared_ptr<std::atomic<bool>> cancelled)
+        : m_predictor(predictor)
+        , m_forkId(forkId)
+        , m_state(state)
+        , m_modification(std::move(modification))
+        , m_horizon(horizon)
+        , m_sampleInterval(sampleInterval)
+        , m_cancelled(std::move(cancelled))
+    {
+    }
+    
+    void run() override
+    {
+        // Never compete with the GUI or control thread
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+        
+        QElapsedTimer timer;
+        timer.start();
+        
+        // The model is created here so it lives on the worker thread
+        DataModel model;
+        model.restoreState(m_state);
+        if (m_modification) {
+            m_modification(&model);
+        }
+        
+        QVector<PredictionSample> chunk;
+        chunk.reserve(kSamplesPerChunk);
+        chunk.append(sampleModel(model, 0.0));
+        
+        double time = 0.0;
+        while (time < m_horizon && !m_cancelled->load(std::memory_order_relaxed)) {
+            double step = qMin(m_sampleInterval, m_horizon - time);
+            model.advanceAnalytically(step);
+            time += step;
+            chunk.append(sampleModel(model, time));
+            
+            if (chunk.size() >= kSamplesPerChunk) {
+                post(chunk);
+                chunk.clear();
+            }
+        }
+        
+        if (!chunk.isEmpty()) {
+            post(chunk);
+        }
+        
+        qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+        LookAheadPredictor *predictor = m_predictor;
+        int forkId = m_forkId;
+        QMetaObject::invokeMethod(predictor, [predictor, forkId, elapsedUs]() {
+            predictor->markFinished(forkId, elapsedUs);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    void post(const QVector<PredictionSample> &samples)
+    {
+        LookAheadPredictor *predictor = m_predictor;
+        int forkId = m_forkId;
+        QMetaObject::invokeMethod(predictor, [predictor, forkId, samples]() {
+            predictor->appendSamples(forkId, samples);
+        }, Qt::QueuedConnection);
+    }
+    
+    LookAheadPredictor *m_predictor;
+    int m_forkId;
+    DataModelState m_state;
+    LookAheadPredictor::Modification m_modification;
+    double m_horizon;
+    double m_sampleInterval;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+LookAheadPredictor::LookAheadPredictor(DataModel *dataModel, QObject *parent)
+    : QObject(parent)
+    , m_dataModel(dataModel)
+    , m_nextForkId(1)
+{
+    // Leave cores for the GUI and control threads
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 2));
+}
+
+LookAheadPredictor::~LookAheadPredictor()
+{
+    // Runners post back to this object, so they must be gone first
+    cancelAll();
+    m_pool.waitForDone();
+}
+
+int LookAheadPredictor::fork(const QString &label, Modification modification,
+                             double horizon, double sampleInterval)
+{
+    // One clamped interval sizes the trajectory and drives the runner
+    horizon = qMax(0.0, horizon);
+    sampleInterval = qMax(0.01, sampleInterval);
+    
+    int forkId = m_nextForkId++;
+    
+    Fork &fork = m_forks[forkId];
+    fork.label = label;
+    fork.horizon = horizon;
+    fork.finished = false;
+    fork.cancelled = std::make_shared<std::atomic<bool>>(false);
+    fork.trajectory.reserve(int(horizon / sampleInterval) + 2);
+    
+    // Snapshot on the GUI thread; only reference counts are touched here
+    PredictionRunner *runner = new PredictionRunner(this, forkId, m_dataModel->saveState(),
+                                                    std::move(modification), horizon,
+                                                    sampleInterval, fork.cancelled);
+    runner->setAutoDelete(true);
+    m_pool.start(runner);
+    
+    return forkId;
+}
+
+void LookAheadPredictor::cancel(int forkId)
+{
+    auto it = m_forks.find(forkId);
+    if (it != m_forks.end()) {
+        it->cancelled->store(true, std::memory_order_relaxed);
+    }
+}
+
+void LookAheadPredictor::cancelAll()
+{
+    for (auto it = m_forks.begin(); it != m_forks.end(); ++it) {
+        it->cancelled->store(true, std::memory_order_relaxed);
+    }
+}
+
+QString LookAheadPredictor::forkLabel(int forkId) const
+{
+    auto it = m_forks.constFind(forkId);
+    return it != m_forks.constEnd() ? it->label : QString();
+}
+
+double LookAheadPredictor::forkHorizon(int forkId) const
+{
+    auto it = m_forks.constFind(forkId);
+    return it != m_forks.constEnd() ? it->horizon : 0.0;
+}
+
+bool LookAheadPredictor::isForkFinished(int forkId) const
+{
+    auto it = m_forks.constFind(forkId);
+    return it != m_forks.constEnd() && it->finished;
+}
+
+QVector<PredictionSample> LookAheadPredictor::trajectory(int forkId) const
+{
+    auto it = m_forks.constFind(forkId);
+    return it != m_forks.constEnd() ? it->trajectory : QVector<PredictionSample>();
+}
+
+void LookAheadPredictor::removeFork(int forkId)
+{
+    cancel(forkId);
+    m_forks.remove(forkId);
+}
+
+int LookAheadPredictor::activeForkCount() const
+{
+    int count = 0;
+    for (auto it = m_forks.constBegin(); it != m_forks.constEnd(); ++it) {
+        if (!it->finished) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void LookAheadPredictor::setMaxConcurrentForks(int count)
+{
+    m_pool.setMaxThreadCount(qMax(1, count));
+}
+
+void LookAheadPredictor::appendSamples(int forkId, const QVector<PredictionSample> &samples)
+{
+    // Removed forks may still have chunks in flight
+    auto it = m_forks.find(forkId);
+    if (it == m_forks.end()) {
+        return;
+    }
+    
+    it->trajectory += samples;
+    emit samplesReady(forkId, samples);
+}
+
+void LookAheadPredictor::markFinished(int forkId, qint64 elapsedUs)
+{
+    auto it = m_forks.find(forkId);
+    if (it == m_forks.end()) {
+        return;
+    }
+    
+    it->finished = true;
+    emit forkFinished(forkId, elapsedUs);
+}
@@ -0,0 +1,84 @@
+#ifndef LOOKAHEADPREDICTOR_H
+#define LOOKAHEADPREDICTOR_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class DataModel;
+
+// One point of a predicted trajectory
+struct PredictionSample
+{
+    double time;            // seconds after the fork
+    double supplyTemp;
+    double returnTemp;
+    double systemPressure;
+    double flowRate;
+    double tankLevel;
+};
+
+// Forks the live model into what-if simulations that run ahead of real
+// time on a low-priority worker pool. A fork starts from a copy-on-write
+// snapshot of the model, applies a change (stop a pump, close a channel,
+// ...) and streams its trajectory back in chunks on the GUI thread.
+//
+// Forks run open loop: the equipment states after the change are held for
+// the whole horizon, so the closed-form thermal solution is exact and each
+// sample costs one analytic jump.
+class LookAheadPredictor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Applied to the forked model on the worker thread before it runs
+    using Modification = std::function<void(DataModel *)>;
+    
+    explicit LookAheadPredictor(DataModel *dataModel, QObject *parent = nullptr);
+    ~LookAheadPredictor();
+    
+    int fork(const QString &label, Modification modification,
+             double horizon = 600.0, double sampleInterval = 5.0);
+    void cancel(int forkId);
+    void cancelAll();
+    
+    QString forkLabel(int forkId) const;
+    double forkHorizon(int forkId) const;
+    bool isForkFinished(int forkId) const;
+    QVector<PredictionSample> trajectory(int forkId) const;
+    QList<int> forkIds() const { return m_forks.keys(); }
+    void removeFork(int forkId);
+    
+    int activeForkCount() const;
+    void setMaxConcurrentForks(int count);
+    int maxConcurrentForks() const { return m_pool.maxThreadCount(); }
+
+signals:
+    void samplesReady(int forkId, const QVector<PredictionSample> &samples);
+    void forkFinished(int forkId, qint64 elapsedUs);
+
+private:
+    struct Fork {
+        QString label;
+        double horizon;
+        bool finished;
+        QVector<PredictionSample> trajectory;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+    
+    friend class PredictionRunner;
+    void appendSamples(int forkId, const QVector<PredictionSample> &samples);
+    void markFinished(int forkId, qint64 elapsedUs);
+    
+    DataModel *m_dataModel;
+    QThreadPool m_pool;
+    QHash<int, Fork> m_forks;
+    int m_nextForkId;
+};
+
+#endif // LOOKAHEADPREDICTOR_H
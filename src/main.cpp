@@ -1,13 +1,48 @@
 #include <QApplication>
+#include <QCoreApplication>
+#include <QDebug>
+#include <cstring>
 #include "mainwindow.h"
+#include "headlessrunner.h"
+#include "benchmarks.h"
+#include "layoutbuilder.h"
 
 int main(int argc, char *argv[])
 {
+    // Headless scenario runs must not touch the display
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            QCoreApplication app(argc, argv);
+            app.setApplicationName("Liquid Cooling Unit Simulator");
+            app.setApplicationVersion("1.0.0");
+            return runHeadlessScenario(app.arguments());
+        }
+    }
+    
     QApplication app(argc, argv);
     app.setApplicationName("Liquid Cooling Unit Simulator");
     app.setApplicationVersion("1.0.0");
     
-    MainWindow window;
+    if (app.arguments().contains("--benchmark")) {
+        return runBenchmarks(app.arguments());
+    }
+    
+    // --layout <file> replaces the stock unit with another plant
+    PlantLayout layout = LayoutBuilder::stockLayout();
+    int layoutArgument = app.arguments().indexOf("--layout");
+    if (layoutArgument > 0) {
+        if (layoutArgument + 1 >= app.arguments().size()) {
+            qCritical().noquote() << "Usage: --layout <file>: missing layout file";
+            return 1;
+        }
+        QString errorMessage;
+        if (!LayoutBuilder::load(app.arguments().at(layoutArgument + 1), &layout, &errorMessage)) {
+            qCritical().noquote() << errorMessage;
+            return 1;
+        }
+    }
+    
+    MainWindow window(layout);
     window.show();
     
     return app.exec();
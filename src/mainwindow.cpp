@@ -1,6 +1,10 @@
 #include "mainwindow.h"
 #include "lcuscene3d.h"
 #include "animationcontroller3d.h"
+#include "components/basecomponent.h"
+#include "fleetmodel.h"
+#include "fleetview.h"
+#include "wakeupmonitor.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
@@ -8,14 +12,19 @@
 #include <QStatusBar>
 #include <QDockWidget>
 #include <QFormLayout>
+#include <QMessageBox>
 #include <Qt3DExtras/Qt3DWindow>
 #include <Qt3DExtras/QForwardRenderer>
 #include <Qt3DExtras/QOrbitCameraController>
 #include <Qt3DRender/QCamera>
+#include <algorithm>
+#include <functional>
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const PlantLayout &layout, QWidget *parent)
     : QMainWindow(parent)
     , m_is3DMode(false)
+    , m_3dSeparate(false)
+    , m_frameStatsOverlay(nullptr)
     , m_3dWindow(nullptr)
     , m_3dContainer(nullptr)
 {
@@ -25,33 +34,64 @@ MainWindow::MainWindow(QWidget *parent)
     // Create shared data model
     m_dataModel = new DataModel(this);
     
+    // Create controller (started with the system)
+    m_controlSystem = new ControlSystem(m_dataModel->controlInterface(), this);
+    
+    // Create scenario engine
+    m_scenarioEngine = new ScenarioEngine(m_dataModel, this);
+    m_scenarioEngine->setControlSystem(m_controlSystem);
+    m_scenarios = ScenarioEngine::loadScenarioFile(ScenarioEngine::defaultScenarioFile());
+    
+    // Create look-ahead predictor
+    m_predictor = new LookAheadPredictor(m_dataModel, this);
+    connect(m_predictor, &LookAheadPredictor::samplesReady, this, &MainWindow::updatePredictionDisplay);
+    connect(m_predictor, &LookAheadPredictor::forkFinished, this, &MainWindow::updatePredictionDisplay);
+    
+    // One clock steps the model for every view
+    m_clock = new SimulationClock(m_dataModel, this);
+    m_clock->setScenarioEngine(m_scenarioEngine);
+    m_clock->setControlSystem(m_controlSystem);
+    
     // Create 2D scene and controller
-    m_scene = new LCUScene(m_dataModel, this);
-    m_animationController = new AnimationController(m_scene, m_dataModel, this);
+    m_scene = new LCUScene(m_dataModel, layout, this);
+    m_animationController = new AnimationController(m_scene, m_clock, this);
     
     // Setup UI (will start in 2D mode)
     setupUI();
     
     // Setup 3D view (but don't show it yet)
-    setup3DView();
+    setup3DView(layout);
+    
+    // Ticks stop while the view is minimized or covered
+    m_animationController->setView(m_view);
+    updateControllers();
     
+    // Labels follow model changes at most every 100 ms, never while idle
     m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(100);
     connect(m_updateTimer, &QTimer::timeout, this, &MainWindow::updateDisplay);
-    m_updateTimer->start(100); // Update display every 100ms
+    connect(m_dataModel, &DataModel::dataChanged, this, &MainWindow::onDataChanged);
+    updateDisplay();
 }
 
 MainWindow::~MainWindow()
 {
+    m_clock->setControlSystem(nullptr);
+    m_controlSystem->stopControl();
 }
 
 void MainWindow::setupUI()
 {
-    // Central widget with graphics view
-    m_view = new QGraphicsView(m_scene, this);
+    // Central stack of the 2D and 3D views
+    m_viewStack = new QStackedWidget(this);
+    setCentralWidget(m_viewStack);
+    
+    m_view = new LCUView(m_scene, m_viewStack);
     m_view->setRenderHint(QPainter::Antialiasing);
-    m_view->setViewportUpdateMode(QGraphicsView::BoundingRectViewportUpdate);
+    m_view->setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
     m_view->setBackgroundBrush(QBrush(QColor(200, 220, 240)));
-    setCentralWidget(m_view);
+    m_viewStack->addWidget(m_view);
     
     createControlPanel();
     createStatusPanel();
@@ -65,6 +105,34 @@ void MainWindow::setupUI()
     viewMenu->addAction("Zoom &In", [this]() { m_view->scale(1.2, 1.2); });
     viewMenu->addAction("Zoom &Out", [this]() { m_view->scale(0.8, 0.8); });
     viewMenu->addAction("&Reset Zoom", [this]() { m_view->resetTransform(); });
+    viewMenu->addSeparator();
+    viewMenu->addAction("Render &Statistics...", this, &MainWindow::showRenderStatistics);
+    viewMenu->addAction("Reset Render Statistics", []() { BaseComponent::resetRenderCosts(); });
+    QAction *overlayAction = viewMenu->addAction("Repaint &Overlay");
+    overlayAction->setCheckable(true);
+    connect(overlayAction, &QAction::toggled, m_view, &LCUView::setRepaintOverlay);
+    QAction *batchAction = viewMenu->addAction("&Batched Rendering");
+    batchAction->setCheckable(true);
+    connect(batchAction, &QAction::toggled, m_scene, &LCUScene::setBatchedRendering);
+    QAction *timingAction = viewMenu->addAction("Frame &Timing Overlay");
+    timingAction->setCheckable(true);
+    connect(timingAction, &QAction::toggled, this, &MainWindow::setFrameTimingOverlay);
+    QAction *tiledAction = viewMenu->addAction("&Tiled Parallel Rendering");
+    tiledAction->setCheckable(true);
+    connect(tiledAction, &QAction::toggled, m_view, &LCUView::setTiledRendering);
+    QAction *valuesAction = viewMenu->addAction("Live &Values");
+    valuesAction->setCheckable(true);
+    connect(valuesAction, &QAction::toggled, m_scene, &LCUScene::setValueOverlays);
+    viewMenu->addSeparator();
+    viewMenu->addAction("&Fleet Overview...", this, &MainWindow::showFleetOverview);
+    m_separate3DAction = viewMenu->addAction("3D View in Separate &Window");
+    m_separate3DAction->setCheckable(true);
+    connect(m_separate3DAction, &QAction::toggled, this, &MainWindow::setSeparate3DWindow);
+    viewMenu->addSeparator();
+    QAction *wakeupAction = viewMenu->addAction("&Wakeup Monitor");
+    wakeupAction->setCheckable(true);
+    connect(wakeupAction, &QAction::toggled, [](bool enabled) { WakeupMonitor::setEnabled(enabled); });
+    viewMenu->addAction("Wakeup Statistics...", this, &MainWindow::showWakeupStatistics);
     
     statusBar()->showMessage("Ready");
 }
@@ -118,6 +186,91 @@ void MainWindow::createControlPanel()
     capacityGroup->setLayout(capacityLayout);
     layout->addWidget(capacityGroup);
     
+    // Automatic control
+    QGroupBox *autoControlGroup = new QGroupBox("Automatic Control");
+    QFormLayout *autoControlLayout = new QFormLayout();
+    
+    m_autoControlCheck = new QCheckBox("PID staging");
+    m_autoControlCheck->setChecked(true);
+    connect(m_autoControlCheck, &QCheckBox::toggled, this, &MainWindow::onAutoControlToggled);
+    
+    m_setpointSpin = new QDoubleSpinBox();
+    m_setpointSpin->setRange(10.0, 35.0);
+    m_setpointSpin->setSingleStep(0.5);
+    m_setpointSpin->setValue(m_controlSystem->getSupplySetpoint());
+    m_setpointSpin->setSuffix(" °C");
+    connect(m_setpointSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            [this](double value) { m_controlSystem->setSupplySetpoint(value); });
+    
+    autoControlLayout->addRow(m_autoControlCheck);
+    autoControlLayout->addRow("Supply Setpoint:", m_setpointSpin);
+    autoControlGroup->setLayout(autoControlLayout);
+    layout->addWidget(autoControlGroup);
+    
+    // Scenario playback
+    QGroupBox *scenarioGroup = new QGroupBox("Scenario");
+    QVBoxLayout *scenarioLayout = new QVBoxLayout();
+    
+    m_scenarioCombo = new QComboBox();
+    for (const ScenarioDefinition &scenario : m_scenarios) {
+        m_scenarioCombo->addItem(QString("%1 (%2 s)").arg(scenario.name).arg(scenario.duration));
+    }
+    
+    m_runScenarioButton = new QPushButton("Run Scenario");
+    m_runScenarioButton->setEnabled(!m_scenarios.isEmpty());
+    connect(m_runScenarioButton, &QPushButton::clicked, this, &MainWindow::onRunScenarioClicked);
+    
+    connect(m_scenarioEngine, &ScenarioEngine::eventApplied, this,
+            [this](const QString &description, double time) {
+                statusBar()->showMessage(QString("Scenario t=%1 s: %2").arg(time, 0, 'f', 1).arg(description));
+            });
+    connect(m_scenarioEngine, &ScenarioEngine::scenarioFinished, this,
+            [this](const QString &name) {
+                // PID staging resumes from whatever the scenario left running
+                m_autoControlCheck->setEnabled(true);
+                if (m_autoControlCheck->isChecked() && m_dataModel->isSystemRunning()) {
+                    m_controlSystem->startControl();
+                }
+                statusBar()->showMessage(QString("Scenario '%1' finished").arg(name));
+            });
+    
+    // Realistic sensor noise for HMI and alarm testing
+    m_sensorNoiseCheck = new QCheckBox("Sensor noise");
+    connect(m_sensorNoiseCheck, &QCheckBox::toggled, this, [this](bool enabled) {
+        if (enabled) {
+            m_dataModel->sensorFaults()->setDefaultNoise();
+        } else {
+            m_dataModel->sensorFaults()->clearNoise();
+        }
+    });
+    
+    scenarioLayout->addWidget(m_scenarioCombo);
+    scenarioLayout->addWidget(m_runScenarioButton);
+    scenarioLayout->addWidget(m_sensorNoiseCheck);
+    scenarioGroup->setLayout(scenarioLayout);
+    layout->addWidget(scenarioGroup);
+    
+    // What-if prediction
+    QGroupBox *whatIfGroup = new QGroupBox("What-If (10 min)");
+    QVBoxLayout *whatIfLayout = new QVBoxLayout();
+    
+    m_whatIfCombo = new QComboBox();
+    m_whatIfCombo->addItems({"Stop Pump 1", "Stop Pump 2",
+                             "Close CH1", "Close CH2", "Close CH3", "Close CH4",
+                             "Stop Compressor 1", "Stop Compressor 2", "Stop Compressor 3"});
+    
+    m_predictButton = new QPushButton("Predict");
+    connect(m_predictButton, &QPushButton::clicked, this, &MainWindow::onPredictClicked);
+    
+    m_predictionLabel = new QLabel("No predictions");
+    m_predictionLabel->setWordWrap(true);
+    
+    whatIfLayout->addWidget(m_whatIfCombo);
+    whatIfLayout->addWidget(m_predictButton);
+    whatIfLayout->addWidget(m_predictionLabel);
+    whatIfGroup->setLayout(whatIfLayout);
+    layout->addWidget(whatIfGroup);
+    
     layout->addStretch();
     controlWidget->setLayout(layout);
     controlDock->setWidget(controlWidget);
@@ -192,6 +345,25 @@ void MainWindow::createSensorDisplay()
     refrigerantGroup->setLayout(refrigerantLayout);
     layout->addWidget(refrigerantGroup);
     
+    // Controller status
+    QGroupBox *controllerGroup = new QGroupBox("Controller");
+    QFormLayout *controllerLayout = new QFormLayout();
+    
+    m_controlOutputLabel = new QLabel("-- %");
+    m_controlStagesLabel = new QLabel("0");
+    m_leadPumpLabel = new QLabel("--");
+    m_loopJitterLabel = new QLabel("-- µs");
+    m_loopExecutionLabel = new QLabel("-- µs");
+    
+    controllerLayout->addRow("Demand:", m_controlOutputLabel);
+    controllerLayout->addRow("Stages:", m_controlStagesLabel);
+    controllerLayout->addRow("Lead Pump:", m_leadPumpLabel);
+    controllerLayout->addRow("Loop Jitter:", m_loopJitterLabel);
+    controllerLayout->addRow("Loop Time:", m_loopExecutionLabel);
+    
+    controllerGroup->setLayout(controllerLayout);
+    layout->addWidget(controllerGroup);
+    
     layout->addStretch();
     sensorWidget->setLayout(layout);
     sensorDock->setWidget(sensorWidget);
@@ -202,31 +374,21 @@ void MainWindow::onStartClicked()
 {
     m_dataModel->setSystemRunning(true);
     
-    // Start the appropriate animation controller
-    if (m_is3DMode) {
-        if (m_animationController3d) {
-            m_animationController3d->start();
-        }
-    } else {
-        if (m_animationController) {
-            m_animationController->start();
-        }
+    if (m_autoControlCheck->isChecked() && !m_scenarioEngine->isActive()) {
+        m_controlSystem->startControl();
     }
     
+    updateControllers();
+    
     statusBar()->showMessage("System Running");
 }
 
 void MainWindow::onStopClicked()
 {
+    m_controlSystem->stopControl();
     m_dataModel->setSystemRunning(false);
     
-    // Stop both animation controllers
-    if (m_animationController) {
-        m_animationController->stop();
-    }
-    if (m_animationController3d) {
-        m_animationController3d->stop();
-    }
+    updateControllers();
     
     statusBar()->showMessage("System Stopped");
 }
@@ -237,9 +399,194 @@ void MainWindow::onResetClicked()
     statusBar()->showMessage("All trips reset");
 }
 
+void MainWindow::onAutoControlToggled(bool enabled)
+{
+    if (enabled && m_dataModel->isSystemRunning()) {
+        m_controlSystem->startControl();
+        statusBar()->showMessage("Automatic control enabled");
+    } else if (!enabled) {
+        m_controlSystem->stopControl();
+        statusBar()->showMessage("Automatic control disabled");
+    }
+}
+
+void MainWindow::onRunScenarioClicked()
+{
+    int index = m_scenarioCombo->currentIndex();
+    if (index < 0 || index >= m_scenarios.size()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_scenarioEngine->start(m_scenarios[index], &error)) {
+        statusBar()->showMessage(error);
+        return;
+    }
+    
+    // The scenario's equipment events win: PID staging is suspended until
+    // it finishes, and its supply_setpoint events only set the setpoint
+    // staging resumes with
+    m_controlSystem->stopControl();
+    m_autoControlCheck->setEnabled(false);
+    
+    // The clock steps the scenario instead of the model
+    m_clock->reschedule();
+    updateControllers();
+    
+    statusBar()->showMessage(QString("Running scenario '%1'").arg(m_scenarios[index].name));
+}
+
+void MainWindow::onPredictClicked()
+{
+    // Keep a handful of forks on screen; the oldest one makes room
+    const int maxForks = 4;
+    QList<int> ids = m_predictor->forkIds();
+    std::sort(ids.begin(), ids.end());
+    while (ids.size() >= maxForks) {
+        m_predictor->removeFork(ids.takeFirst());
+    }
+    
+    int index = m_whatIfCombo->currentIndex();
+    LookAheadPredictor::Modification change;
+    if (index < 2) {
+        change = [index](DataModel *model) { model->setPumpState(index, false); };
+    } else if (index < 6) {
+        change = [index](DataModel *model) { model->setChannelState(index - 2, false); };
+    } else {
+        change = [index](DataModel *model) { model->setCompressorState(index - 6, false); };
+    }
+    
+    m_predictor->fork(m_whatIfCombo->currentText(), change);
+    updatePredictionDisplay();
+}
+
+void MainWindow::updatePredictionDisplay()
+{
+    QStringList lines;
+    QList<int> ids = m_predictor->forkIds();
+    std::sort(ids.begin(), ids.end());
+    
+    for (int id : ids) {
+        QVector<PredictionSample> samples = m_predictor->trajectory(id);
+        if (samples.isEmpty()) {
+            lines << QString("%1: running...").arg(m_predictor->forkLabel(id));
+            continue;
+        }
+        
+        double peakSupply = samples.first().supplyTemp;
+        for (const PredictionSample &sample : samples) {
+            peakSupply = qMax(peakSupply, sample.supplyTemp);
+        }
+        
+        const PredictionSample &last = samples.last();
+        QString line = QString("%1: supply %2 °C at %3 min (peak %4 °C), pressure %5 bar")
+                           .arg(m_predictor->forkLabel(id))
+                           .arg(last.supplyTemp, 0, 'f', 1)
+                           .arg(last.time / 60.0, 0, 'f', 1)
+                           .arg(peakSupply, 0, 'f', 1)
+                           .arg(last.systemPressure, 0, 'f', 2);
+        if (!m_predictor->isForkFinished(id)) {
+            line += QString(" [%1%]").arg(int(100.0 * last.time / m_predictor->forkHorizon(id)));
+        }
+        lines << line;
+    }
+    
+    m_predictionLabel->setText(lines.isEmpty() ? QString("No predictions") : lines.join("\n"));
+}
+
+void MainWindow::showRenderStatistics()
+{
+    // Paint cost per 2D component type since the last reset
+    const QHash<QString, BaseComponent::RenderCost> costs = BaseComponent::renderCosts();
+    QStringList types = costs.keys();
+    std::sort(types.begin(), types.end());
+    
+    QStringList lines;
+    for (const QString &type : types) {
+        const BaseComponent::RenderCost &cost = costs[type];
+        double meanUs = cost.paints > 0 ? cost.paintNs / 1000.0 / cost.paints : 0.0;
+        lines << QString("%1: %2 paints, %3 µs each, %4 static rebuilds (%5 ms)")
+                     .arg(type)
+                     .arg(cost.paints)
+                     .arg(meanUs, 0, 'f', 1)
+                     .arg(cost.staticRebuilds)
+                     .arg(cost.rebuildNs / 1e6, 0, 'f', 2);
+    }
+    
+    QMessageBox::information(this, "Render Statistics",
+                             lines.isEmpty() ? QString("Nothing painted yet") : lines.join("\n"));
+}
+
+void MainWindow::showWakeupStatistics()
+{
+    if (!WakeupMonitor::isEnabled()) {
+        QMessageBox::information(this, "Wakeup Statistics", "Enable View → Wakeup Monitor first");
+        return;
+    }
+    
+    // GUI thread wakeups since enabled or last shown, busiest sources first
+    const WakeupMonitor::Statistics stats = WakeupMonitor::statistics();
+    QList<QPair<quint64, QString>> sources;
+    for (auto it = stats.sources.cbegin(); it != stats.sources.cend(); ++it) {
+        sources.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(sources.begin(), sources.end(), std::greater<QPair<quint64, QString>>());
+    
+    QStringList lines;
+    lines << QString("%1 wakeups/s over %2 s (2D animation: %3, model %4)")
+                 .arg(stats.perSecond(), 0, 'f', 1)
+                 .arg(stats.seconds, 0, 'f', 0)
+                 .arg(QStringList({ "dormant", "animating" }).at(m_animationController->mode()))
+                 .arg(m_clock->isStepping() ? "stepping" : "idle");
+    for (const auto &source : sources) {
+        lines << QString("%1: %2/s").arg(source.second).arg(source.first / qMax(1.0, stats.seconds), 0, 'f', 1);
+    }
+    
+    QMessageBox::information(this, "Wakeup Statistics", lines.join("\n"));
+    WakeupMonitor::reset();
+}
+
+void MainWindow::showFleetOverview()
+{
+    if (m_fleetWindow) {
+        m_fleetWindow->raise();
+        m_fleetWindow->activateWindow();
+        return;
+    }
+    
+    // Unit 1 mirrors this window's model, the rest are simulated
+    QWidget *window = new QWidget(this, Qt::Window);
+    window->setAttribute(Qt::WA_DeleteOnClose);
+    window->setWindowTitle("Fleet Overview");
+    window->resize(1200, 800);
+    
+    FleetModel *fleet = new FleetModel(m_dataModel, window);
+    fleet->setUnitCount(100);
+    FleetView *fleetView = new FleetView(fleet, m_clock, window);
+    
+    QSpinBox *unitSpin = new QSpinBox(window);
+    unitSpin->setRange(1, 10000);
+    unitSpin->setValue(fleet->unitCount());
+    connect(unitSpin, QOverload<int>::of(&QSpinBox::valueChanged), fleet, &FleetModel::setUnitCount);
+    
+    QHBoxLayout *controls = new QHBoxLayout;
+    controls->addWidget(new QLabel("Units:", window));
+    controls->addWidget(unitSpin);
+    controls->addStretch();
+    
+    QVBoxLayout *layout = new QVBoxLayout(window);
+    layout->addLayout(controls);
+    layout->addWidget(fleetView);
+    
+    m_fleetWindow = window;
+    window->show();
+}
+
 void MainWindow::onDataChanged()
 {
-    updateDisplay();
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
 }
 
 void MainWindow::updateDisplay()
@@ -264,16 +611,34 @@ void MainWindow::updateDisplay()
     m_wd1Label->setText(m_dataModel->getCompressorState(0) ? "Running" : "Idle");
     m_wd2Label->setText(m_dataModel->getCompressorState(1) ? "Running" : "Idle");
     m_wd3Label->setText(m_dataModel->getCompressorState(2) ? "Running" : "Idle");
+    
+    // Update controller status
+    if (m_controlSystem->isRunning()) {
+        ControlSystem::LoopStatistics stats = m_controlSystem->getStatistics();
+        m_controlOutputLabel->setText(QString::number(m_controlSystem->getControlOutput(), 'f', 1) + " %");
+        m_controlStagesLabel->setText(QString::number(m_controlSystem->getActiveStages()));
+        m_leadPumpLabel->setText(QString("Pump %1").arg(m_controlSystem->getLeadPump() + 1));
+        m_loopJitterLabel->setText(QString("%1 / %2 µs")
+                                   .arg(stats.jitterMeanUs, 0, 'f', 0)
+                                   .arg(stats.jitterMaxUs, 0, 'f', 0));
+        m_loopExecutionLabel->setText(QString("%1 / %2 µs")
+                                      .arg(stats.executionMeanUs, 0, 'f', 1)
+                                      .arg(stats.executionMaxUs, 0, 'f', 1));
+    } else {
+        m_controlOutputLabel->setText("-- %");
+        m_controlStagesLabel->setText("--");
+        m_leadPumpLabel->setText("--");
+    }
 }
 
-void MainWindow::setup3DView()
+void MainWindow::setup3DView(const PlantLayout &layout)
 {
     // Create 3D window
     m_3dWindow = new Qt3DExtras::Qt3DWindow();
     m_3dWindow->defaultFrameGraph()->setClearColor(QColor(200, 220, 240));
     
     // Create 3D scene
-    m_scene3d = new LCUScene3D(m_dataModel);
+    m_scene3d = new LCUScene3D(m_dataModel, layout);
     
     // Setup camera
     Qt3DRender::QCamera *camera = m_3dWindow->camera();
@@ -289,47 +654,123 @@ void MainWindow::setup3DView()
     m_3dWindow->setRootEntity(m_scene3d);
     
     // Create animation controller for 3D
-    m_animationController3d = new AnimationController3D(m_scene3d, m_dataModel, this);
+    m_animationController3d = new AnimationController3D(m_scene3d, m_clock, this);
     
-    // Create container widget (not shown initially)
-    m_3dContainer = QWidget::createWindowContainer(m_3dWindow, this);
+    // Create container widget (behind the 2D view initially)
+    m_3dContainer = QWidget::createWindowContainer(m_3dWindow, m_viewStack);
     m_3dContainer->setMinimumSize(QSize(800, 600));
-    m_3dContainer->hide();
+    m_3dContainer->setWindowTitle("Liquid Cooling Unit (LCU) - 3D View");
+    m_3dContainer->installEventFilter(this);
+    m_viewStack->addWidget(m_3dContainer);
 }
 
-void MainWindow::onToggleViewMode()
+void MainWindow::updateControllers()
 {
-    if (m_is3DMode) {
-        switchTo2D();
+    // Each shown view draws at its own rate; the clock steps the model
+    // once for however many of them there are
+    bool running = m_dataModel->isSystemRunning() || m_scenarioEngine->isActive();
+    bool show2D = !m_is3DMode || m_3dSeparate;
+    bool show3D = m_is3DMode || m_3dSeparate;
+    
+    if (show2D) {
+        m_animationController->start();
     } else {
-        switchTo3D();
+        m_animationController->stop();
+    }
+    
+    if (show3D && running) {
+        m_animationController3d->start();
+    } else {
+        m_animationController3d->stop();
     }
 }
 
-void MainWindow::switchTo2D()
+void MainWindow::setSeparate3DWindow(bool separate)
 {
-    m_is3DMode = false;
-    
-    // Stop 3D animations
-    if (m_animationController3d) {
-        m_animationController3d->stop();
+    if (separate == m_3dSeparate) {
+        return;
     }
+    m_3dSeparate = separate;
     
-    // Hide 3D view
-    if (m_3dContainer) {
+    // The 2D view stays in the main window, for a second monitor
+    if (separate) {
+        m_viewStack->removeWidget(m_3dContainer);
+        m_3dContainer->setParent(this, Qt::Window);
+        m_3dContainer->resize(1200, 800);
+        m_3dContainer->show();
+        switchTo2D();
+    } else {
         m_3dContainer->hide();
+        m_3dContainer->setParent(m_viewStack);
+        m_viewStack->addWidget(m_3dContainer);
     }
     
-    // Show 2D view
-    if (m_view) {
-        setCentralWidget(m_view);
-        m_view->show();
+    m_toggleViewButton->setEnabled(!separate);
+    m_separate3DAction->setChecked(separate);
+    updateControllers();
+}
+
+void MainWindow::setFrameTimingOverlay(bool enabled)
+{
+    if (enabled && !m_frameStatsOverlay) {
+        m_frameStatsOverlay = new FrameStatsOverlay(this);
     }
     
-    // Restart 2D animations if system is running
-    if (m_dataModel->isSystemRunning() && m_animationController) {
-        m_animationController->start();
+    // Property changes are only counted while they are on screen
+    m_scene3d->setPropertyChangeCounting(enabled);
+    if (m_frameStatsOverlay) {
+        placeFrameTimingOverlay();
+        m_frameStatsOverlay->setVisible(enabled);
+    }
+}
+
+void MainWindow::placeFrameTimingOverlay()
+{
+    if (m_frameStatsOverlay) {
+        QPoint topRight = m_viewStack->mapToGlobal(QPoint(m_viewStack->width(), 0));
+        m_frameStatsOverlay->move(topRight + QPoint(-m_frameStatsOverlay->width() - 8, 8));
     }
+}
+
+void MainWindow::moveEvent(QMoveEvent *event)
+{
+    QMainWindow::moveEvent(event);
+    placeFrameTimingOverlay();
+}
+
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+    placeFrameTimingOverlay();
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    // Closing the separate 3D window puts the view back in the stack
+    if (watched == m_3dContainer && event->type() == QEvent::Close && m_3dSeparate) {
+        event->ignore();
+        setSeparate3DWindow(false);
+        return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::onToggleViewMode()
+{
+    if (m_is3DMode) {
+        switchTo2D();
+    } else {
+        switchTo3D();
+    }
+}
+
+void MainWindow::switchTo2D()
+{
+    m_is3DMode = false;
+    
+    // The model keeps its clock; only the drawing views change
+    m_viewStack->setCurrentWidget(m_view);
+    updateControllers();
     
     // Update button text
     if (m_toggleViewButton) {
@@ -343,26 +784,9 @@ void MainWindow::switchTo3D()
 {
     m_is3DMode = true;
     
-    // Stop 2D animations
-    if (m_animationController) {
-        m_animationController->stop();
-    }
-    
-    // Hide 2D view
-    if (m_view) {
-        m_view->hide();
-    }
-    
-    // Show 3D view
-    if (m_3dContainer) {
-        setCentralWidget(m_3dContainer);
-        m_3dContainer->show();
-    }
-    
-    // Start 3D animations if system is running
-    if (m_dataModel->isSystemRunning() && m_animationController3d) {
-        m_animationController3d->start();
-    }
+    // The model keeps its clock; only the drawing views change
+    m_viewStack->setCurrentWidget(m_3dContainer);
+    updateControllers();
     
     // Update button text
     if (m_toggleViewButton) {
@@ -8,12 +8,23 @@
 #include <QPushButton>
 #include <QSpinBox>
 #include <QDoubleSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QWidget>
+#include <QStackedWidget>
+#include <QPointer>
 #include "lcuscene.h"
+#include "lcuview.h"
 #include "lcuscene3d.h"
 #include "datamodel.h"
 #include "animationcontroller.h"
 #include "animationcontroller3d.h"
+#include "simulationclock.h"
+#include "framestatsoverlay.h"
+#include "controlsystem.h"
+#include "scenarioengine.h"
+#include "lookaheadpredictor.h"
+#include "layoutbuilder.h"
 
 namespace Qt3DExtras {
     class Qt3DWindow;
@@ -29,9 +40,15 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    // Both views are built from the same plant layout
+    explicit MainWindow(const PlantLayout &layout = LayoutBuilder::stockLayout(), QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void moveEvent(QMoveEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
 private slots:
     void onStartClicked();
     void onStopClicked();
@@ -39,18 +56,35 @@ private slots:
     void onDataChanged();
     void updateDisplay();
     void onToggleViewMode();
+    void onAutoControlToggled(bool enabled);
+    void onRunScenarioClicked();
+    void onPredictClicked();
+    void showRenderStatistics();
+    void showFleetOverview();
+    void showWakeupStatistics();
+    void setSeparate3DWindow(bool separate);
+    void setFrameTimingOverlay(bool enabled);
+    void updatePredictionDisplay();
 
 private:
     void setupUI();
     void createControlPanel();
     void createStatusPanel();
     void createSensorDisplay();
-    void setup3DView();
+    void setup3DView(const PlantLayout &layout);
     void switchTo2D();
     void switchTo3D();
+    void updateControllers();
+    void placeFrameTimingOverlay();
+    
+    // Steps the model for all views
+    SimulationClock *m_clock;
+    
+    // Central stack of the 2D and 3D views
+    QStackedWidget *m_viewStack;
     
     // 2D view components
-    QGraphicsView *m_view;
+    LCUView *m_view;
     LCUScene *m_scene;
     AnimationController *m_animationController;
     
@@ -64,14 +98,40 @@ private:
     // Shared data model
     DataModel *m_dataModel;
     
-    // View state
+    // Supervisory controller (runs on its own thread)
+    ControlSystem *m_controlSystem;
+    
+    // Scenario playback
+    ScenarioEngine *m_scenarioEngine;
+    QVector<ScenarioDefinition> m_scenarios;
+    
+    // What-if forks of the live model
+    LookAheadPredictor *m_predictor;
+    
+    // View state; a separate 3D window runs beside the 2D view
     bool m_is3DMode;
+    bool m_3dSeparate;
+    QAction *m_separate3DAction;
+    
+    // Frame timing panel over the top right of the views
+    FrameStatsOverlay *m_frameStatsOverlay;
+    
+    // Fleet overview window, open at most once
+    QPointer<QWidget> m_fleetWindow;
     
     // Control widgets
     QPushButton *m_startButton;
     QPushButton *m_stopButton;
     QPushButton *m_resetButton;
     QPushButton *m_toggleViewButton;
+    QCheckBox *m_autoControlCheck;
+    QDoubleSpinBox *m_setpointSpin;
+    QComboBox *m_scenarioCombo;
+    QPushButton *m_runScenarioButton;
+    QCheckBox *m_sensorNoiseCheck;
+    QComboBox *m_whatIfCombo;
+    QPushButton *m_predictButton;
+    QLabel *m_predictionLabel;
     
     // Sensor displays
     QLabel *m_supplyTempLabel;
@@ -93,6 +153,13 @@ private:
     QLabel *m_wd2Label;
     QLabel *m_wd3Label;
     
+    // Controller displays
+    QLabel *m_controlOutputLabel;
+    QLabel *m_controlStagesLabel;
+    QLabel *m_leadPumpLabel;
+    QLabel *m_loopJitterLabel;
+    QLabel *m_loopExecutionLabel;
+    
     QTimer *m_updateTimer;
 };
 
@@ -0,0 +1,195 @@
+#include "montecarloanalysis.h"
+#include "datamodel.h"
+#include "xoshiro256.h"
+#include <QThreadPool>
+#include <QThread>
+#include <QElapsedTimer>
+#include <cmath>
+
+namespace {
+    // Fixed rather than one per core, so results do not depend on the
+    // machine; each lane keeps its own estimators, merged at the end
+    const int kLanes = 16;
+    
+    // Heat exchanger NTU (UA over coolant capacity rate) at the unit's flow
+    const double kNominalNtu = 1.0;
+}
+
+MonteCarloAnalysis::Estimators::Estimators(int samples)
+    : supplyP05(samples, P2Quantile(0.05))
+    , supplyP50(samples, P2Quantile(0.50))
+    , supplyP95(samples, P2Quantile(0.95))
+    , returnP95(samples, P2Quantile(0.95))
+    , peakSupplyP95(0.95)
+{
+}
+
+MonteCarloAnalysis::MonteCarloAnalysis(const MonteCarloConfig &config)
+    : m_config(config)
+{
+    m_config.replicas = qMax(1, m_config.replicas);
+    m_config.batchSize = qMax(1, m_config.batchSize);
+    m_config.timeStep = qMax(1e-3, m_config.timeStep);
+    m_config.sampleInterval = qMax(m_config.timeStep, m_config.sampleInterval);
+    m_config.horizon = qMax(m_config.sampleInterval, m_config.horizon);
+}
+
+int MonteCarloAnalysis::sampleCount() const
+{
+    // Includes the starting point
+    return int(m_config.horizon / m_config.sampleInterval + 1e-9) + 1;
+}
+
+MonteCarloResult MonteCarloAnalysis::run(const DataModel &model)
+{
+    Baseline baseline;
+    baseline.supplyTemp = model.getTrueValue(SensorFaultInjector::SupplyTemp);
+    baseline.flowRate = model.getTrueValue(SensorFaultInjector::FlowRate);
+    baseline.heaterPower = model.getTrueValue(SensorFaultInjector::HeaterPower);
+    baseline.refrigerationCapacity = model.getRefrigerationCapacity();
+    
+    const int samples = sampleCount();
+    const int batches = (m_config.replicas + m_config.batchSize - 1) / m_config.batchSize;
+    const int lanes = qMin(kLanes, batches);
+    QVector<Estimators> laneEstimators(lanes, Estimators(samples));
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // Lane l runs batches l, l + lanes, ... in order on a stream 2^128
+    // draws away from its neighbours
+    Xoshiro256 stream(m_config.seed);
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int lane = 0; lane < lanes; ++lane) {
+        Estimators *estimators = &laneEstimators[lane];
+        pool.start([this, lane, lanes, batches, stream, estimators, &baseline]() {
+            Xoshiro256 rng = stream;
+            for (int b = lane; b < batches; b += lanes) {
+                runBatch(b, baseline, rng, *estimators);
+            }
+        });
+        stream.jump();
+    }
+    pool.waitForDone();
+    
+    // Merged in lane order, so the result depends on the seed only
+    auto merged = [&laneEstimators](QVector<P2Quantile> Estimators::*field, int sample) {
+        QVector<P2Quantile> parts;
+        for (const Estimators &estimators : laneEstimators) {
+            parts.append((estimators.*field)[sample]);
+        }
+        return P2Quantile::merged(parts).value();
+    };
+    
+    MonteCarloResult result;
+    result.replicas = m_config.replicas;
+    result.horizon = (samples - 1) * m_config.sampleInterval;
+    for (int s = 0; s < samples; ++s) {
+        result.sampleTimes.append(s * m_config.sampleInterval);
+        result.supplyP05.append(merged(&Estimators::supplyP05, s));
+        result.supplyP50.append(merged(&Estimators::supplyP50, s));
+        result.supplyP95.append(merged(&Estimators::supplyP95, s));
+        result.returnP95.append(merged(&Estimators::returnP95, s));
+    }
+    QVector<P2Quantile> peaks;
+    for (const Estimators &estimators : laneEstimators) {
+        peaks.append(estimators.peakSupplyP95);
+    }
+    result.peakSupplyP95 = P2Quantile::merged(peaks).value();
+    result.wallTimeMs = timer.elapsed();
+    
+    double wallSeconds = qMax(1e-6, timer.nsecsElapsed() / 1e9);
+    result.replicaSecondsPerSecond = m_config.replicas * result.horizon / wallSeconds;
+    
+    return result;
+}
+
+void MonteCarloAnalysis::runBatch(int batchIndex, const Baseline &baseline, Xoshiro256 &rng,
+                                  Estimators &estimators) const
+{
+    const DataModel::LoopCoefficients loop = DataModel::loopCoefficients();
+    const int count = qMin(m_config.batchSize, m_config.replicas - batchIndex * m_config.batchSize);
+    const int samples = sampleCount();
+    const int stepsPerSample = qMax(1, int(std::lround(m_config.sampleInterval / m_config.timeStep)));
+    const double dt = m_config.sampleInterval / stepsPerSample;
+    
+    // Exact discretisation of the loop and ambient first-order lags
+    const double tau = loop.heatCapacity / loop.ambientConductance;
+    const double loopDecay = std::exp(-dt / tau);
+    const double ambientDecay = std::exp(-dt / qMax(dt, m_config.ambientTimeConstant));
+    const double ambientKick = m_config.ambientVariation * std::sqrt(1.0 - ambientDecay * ambientDecay);
+    
+    // Coolant capacity rates in kW/K; the exchanger's UA is fixed by its
+    // NTU at the unit's own flow, which removes the full capacity
+    const double nominalRate = (baseline.flowRate / 60.0) * loop.coolantHeatCapacity;
+    const double exchangerUA = kNominalNtu * nominalRate;
+    const double nominalEffectiveness = 1.0 - std::exp(-kNominalNtu);
+    
+    // Structure of arrays, one entry per replica
+    QVector<double> temp(count, baseline.supplyTemp);
+    QVector<double> ambient(count);
+    QVector<double> loopDelta(count);
+    QVector<double> equilibriumOffset(count);
+    QVector<double> peakSupply(count, -1e300);
+    QVector<double> noise(count);
+    QVector<double> noise2(count);
+    
+    rng.fillNormal(ambient.data(), count, loop.ambientTemp, m_config.ambientVariation);
+    for (int i = 0; i < count; ++i) {
+        // A degraded pump moves less coolant: the loop delta-T widens and
+        // the exchanger, sized for the full flow, removes less heat
+        double flow = baseline.flowRate * (1.0 - rng.uniform(0.0, m_config.pumpDegradation));
+        double rate = (flow / 60.0) * loop.coolantHeatCapacity;
+        double netPower = 0.0;
+        loopDelta[i] = 0.0;
+        if (rate > 0.0) {
+            double removal = baseline.refrigerationCapacity * rate * (1.0 - std::exp(-exchangerUA / rate))
+                             / (nominalRate * nominalEffectiveness);
+            netPower = baseline.heaterPower - removal;
+            loopDelta[i] = baseline.heaterPower / rate;
+        }
+        equilibriumOffset[i] = netPower / loop.ambientConductance;
+    }
+    
+    double *t = temp.data();
+    double *a = ambient.data();
+    double *n = noise.data();
+    double *n2 = noise2.data();
+    const double *delta = loopDelta.constData();
+    const double *offset = equilibriumOffset.constData();
+    double *peak = peakSupply.data();
+    
+    for (int s = 0; s < samples; ++s) {
+        if (s > 0) {
+            for (int step = 0; step < stepsPerSample; ++step) {
+                rng.fillNormal(n, count, 0.0, 1.0);
+                for (int i = 0; i < count; ++i) {
+                    a[i] = loop.ambientTemp + (a[i] - loop.ambientTemp) * ambientDecay + ambientKick * n[i];
+                    double target = a[i] + offset[i];
+                    t[i] = target + (t[i] - target) * loopDecay;
+                }
+            }
+        }
+        
+        // Sensor readings at the sample time, folded straight in
+        rng.fillNormal(n, count, 0.0, m_config.sensorNoise);
+        rng.fillNormal(n2, count, 0.0, m_config.sensorNoise);
+        P2Quantile &supplyP05 = estimators.supplyP05[s];
+        P2Quantile &supplyP50 = estimators.supplyP50[s];
+        P2Quantile &supplyP95 = estimators.supplyP95[s];
+        P2Quantile &returnP95 = estimators.returnP95[s];
+        for (int i = 0; i < count; ++i) {
+            double supply = t[i] + n[i];
+            supplyP05.add(supply);
+            supplyP50.add(supply);
+            supplyP95.add(supply);
+            returnP95.add(t[i] + delta[i] + n2[i]);
+            peak[i] = qMax(peak[i], supply);
+        }
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        estimators.peakSupplyP95.add(peak[i]);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef MONTECARLOANALYSIS_H
+#define MONTECARLOANALYSIS_H
+
+#include <QVector>
+#include "p2quantile.h"
+
+class DataModel;
+class Xoshiro256;
+
+struct MonteCarloConfig
+{
+    int replicas = 10000;
+    double horizon = 600.0;             // seconds
+    double timeStep = 1.0;              // seconds
+    double sampleInterval = 10.0;       // seconds between percentile estimates
+    int batchSize = 256;                // replicas per work item
+    quint64 seed = 1;
+    
+    // Perturbations
+    double sensorNoise = 0.2;           // °C, 1 sigma on the temperature sensors
+    // Largest fractional loss of pump flow. Less flow widens the loop
+    // delta-T and lowers the heat exchanger's removal, so it raises both
+    // return and supply temperatures
+    double pumpDegradation = 0.2;
+    double ambientVariation = 2.0;      // °C, 1 sigma of the ambient temperature
+    double ambientTimeConstant = 300.0; // seconds, ambient drift correlation
+};
+
+struct MonteCarloResult
+{
+    int replicas;
+    double horizon;
+    QVector<double> sampleTimes;
+    QVector<double> supplyP05;
+    QVector<double> supplyP50;
+    QVector<double> supplyP95;
+    QVector<double> returnP95;
+    double peakSupplyP95;               // P95 of each replica's highest reading
+    qint64 wallTimeMs;
+    double replicaSecondsPerSecond;
+};
+
+// Runs many perturbed replicas of the coolant loop heat balance forward
+// from the current DataModel state and reports streaming percentiles of
+// the measured supply and return temperatures.
+//
+// Replicas are simulated in structure-of-arrays batches, dealt round-robin
+// to a fixed number of lanes that run in parallel. Each lane draws from its
+// own jump()-separated xoshiro256++ stream and folds readings into its own
+// P-square estimators as they are produced; the lanes are merged in lane
+// order at the end. Results therefore depend on the seed only, not on
+// thread timing or core count, and no raw traces are ever kept.
+class MonteCarloAnalysis
+{
+public:
+    explicit MonteCarloAnalysis(const MonteCarloConfig &config = MonteCarloConfig());
+    
+    const MonteCarloConfig &config() const { return m_config; }
+    
+    // Blocks until every replica has run
+    MonteCarloResult run(const DataModel &model);
+
+private:
+    struct Baseline {
+        double supplyTemp;
+        double flowRate;
+        double heaterPower;
+        double refrigerationCapacity;
+    };
+    
+    // One lane's estimators for each sample time, plus replica peaks
+    struct Estimators {
+        explicit Estimators(int samples = 0);
+        
+        QVector<P2Quantile> supplyP05;
+        QVector<P2Quantile> supplyP50;
+        QVector<P2Quantile> supplyP95;
+        QVector<P2Quantile> returnP95;
+        P2Quantile peakSupplyP95;
+    };
+    
+    void runBatch(int batchIndex, const Baseline &baseline, Xoshiro256 &rng, Estimators &estimators) const;
+    int sampleCount() const;
+    
+    MonteCarloConfig m_config;
+};
+
+#endif // MONTECARLOANALYSIS_H
@@ -0,0 +1,105 @@
+#include "multiratescheduler.h"
+#include <QtMath>
+
+MultiRateScheduler::MultiRateScheduler()
+    : m_time(0.0)
+    , m_maxCatchUpSteps(1000)
+{
+}
+
+int MultiRateScheduler::addSubsystem(const QString &name, double period, StepFunction step)
+{
+    Subsystem subsystem;
+    subsystem.name = name;
+    subsystem.period = qMax(0.0, period);
+    subsystem.sampleTime = m_time;
+    subsystem.alpha = 1.0;
+    subsystem.steps = 0;
+    subsystem.step = std::move(step);
+    m_subsystems.append(subsystem);
+    return m_subsystems.size() - 1;
+}
+
+void MultiRateScheduler::advanceTo(double time)
+{
+    for (Subsystem &s : m_subsystems) {
+        if (s.period <= 0.0) {
+            // Free-running subsystem - step once with the elapsed time
+            double deltaTime = time - s.sampleTime;
+            if (deltaTime > 0.0) {
+                s.step(time, deltaTime);
+                s.sampleTime = time;
+                s.steps++;
+            }
+            s.alpha = 1.0;
+            continue;
+        }
+
+        // Step ahead until the latest sample covers the requested time
+        int steps = 0;
+        while (s.sampleTime < time && steps < m_maxCatchUpSteps) {
+            s.sampleTime += s.period;
+            s.step(s.sampleTime, s.period);
+            s.steps++;
+            steps++;
+        }
+
+        if (s.sampleTime < time) {
+            // Too far behind - drop the backlog and hold the latest sample
+            s.sampleTime = time;
+            s.alpha = 1.0;
+        } else {
+            s.alpha = qBound(0.0, 1.0 - (s.sampleTime - time) / s.period, 1.0);
+        }
+    }
+
+    m_time = time;
+}
+
+void MultiRateScheduler::reset(double time)
+{
+    m_time = time;
+    for (Subsystem &s : m_subsystems) {
+        s.sampleTime = time;
+        s.alpha = 1.0;
+    }
+}
+
+QString MultiRateScheduler::subsystemName(int index) const
+{
+    if (index >= 0 && index < m_subsystems.size()) {
+        return m_subsystems[index].name;
+    }
+    return QString();
+}
+
+double MultiRateScheduler::period(int index) const
+{
+    if (index >= 0 && index < m_subsystems.size()) {
+        return m_subsystems[index].period;
+    }
+    return 0.0;
+}
+
+void MultiRateScheduler::setPeriod(int index, double period)
+{
+    if (index >= 0 && index < m_subsystems.size()) {
+        m_subsystems[index].period = qMax(0.0, period);
+    }
+}
+
+double MultiRateScheduler::interpolationFactor(int index) const
+{
+    if (index >= 0 && index < m_subsystems.size()) {
+        return m_subsystems[index].alpha;
+    }
+    return 1.0;
+}
+
+quint64 MultiRateScheduler::stepCount(int index) const
+{
+    if (index >= 0 && index < m_subsystems.size()) {
+        return m_subsystems[index].steps;
+    }
+    return 0;
+}
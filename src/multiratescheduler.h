@@ -0,0 +1,56 @@
+#ifndef MULTIRATESCHEDULER_H
+#define MULTIRATESCHEDULER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Steps a set of subsystems, each at its own fixed period.
+//
+// A subsystem with a period of 0 is stepped once per advance with the
+// elapsed time. Fixed-rate subsystems are stepped ahead of the requested
+// time so that callers can interpolate between their last two samples
+// using interpolationFactor().
+class MultiRateScheduler
+{
+public:
+    // (sample time at the end of the step, step length)
+    using StepFunction = std::function<void(double, double)>;
+
+    MultiRateScheduler();
+
+    int addSubsystem(const QString &name, double period, StepFunction step);
+
+    void advanceTo(double time);
+
+    // Restarts every subsystem's sampling at time; step counts are kept
+    void reset(double time = 0.0);
+
+    int subsystemCount() const { return m_subsystems.size(); }
+    QString subsystemName(int index) const;
+    double period(int index) const;
+    void setPeriod(int index, double period);
+
+    // 0.0 = at the previous sample, 1.0 = at the latest sample
+    double interpolationFactor(int index) const;
+    quint64 stepCount(int index) const;
+
+    void setMaxCatchUpSteps(int steps) { m_maxCatchUpSteps = steps; }
+    int maxCatchUpSteps() const { return m_maxCatchUpSteps; }
+
+private:
+    struct Subsystem {
+        QString name;
+        double period;
+        double sampleTime;   // time of the latest sample
+        double alpha;
+        quint64 steps;
+        StepFunction step;
+    };
+
+    QVector<Subsystem> m_subsystems;
+    double m_time;
+    int m_maxCatchUpSteps;
+};
+
+#endif // MULTIRATESCHEDULER_H
@@ -0,0 +1,222 @@
+#include "p2quantile.h"
+#include <algorithm>
+#include <cmath>
+
+P2Quantile::P2Quantile(double quantile)
+    : m_quantile(qBound(0.0, quantile, 1.0))
+{
+    reset();
+}
+
+void P2Quantile::reset()
+{
+    m_count = 0;
+    for (int i = 0; i < 5; ++i) {
+        m_heights[i] = 0.0;
+        m_positions[i] = i + 1;
+    }
+    
+    const double p = m_quantile;
+    m_desired[0] = 1.0;
+    m_desired[1] = 1.0 + 2.0 * p;
+    m_desired[2] = 1.0 + 4.0 * p;
+    m_desired[3] = 3.0 + 2.0 * p;
+    m_desired[4] = 5.0;
+    
+    m_increments[0] = 0.0;
+    m_increments[1] = p / 2.0;
+    m_increments[2] = p;
+    m_increments[3] = (1.0 + p) / 2.0;
+    m_increments[4] = 1.0;
+}
+
+void P2Quantile::add(double value)
+{
+    // The first five values seed the markers
+    if (m_count < 5) {
+        m_heights[m_count++] = value;
+        if (m_count == 5) {
+            std::sort(m_heights, m_heights + 5);
+        }
+        return;
+    }
+    m_count++;
+    
+    // Find the cell the value falls into, extending the extremes
+    int k;
+    if (value < m_heights[0]) {
+        m_heights[0] = value;
+        k = 0;
+    } else if (value >= m_heights[4]) {
+        m_heights[4] = qMax(m_heights[4], value);
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && value >= m_heights[k + 1]) {
+            k++;
+        }
+    }
+    
+    for (int i = k + 1; i < 5; ++i) {
+        m_positions[i] += 1.0;
+    }
+    for (int i = 0; i < 5; ++i) {
+        m_desired[i] += m_increments[i];
+    }
+    
+    // Move the middle markers towards their desired positions
+    for (int i = 1; i < 4; ++i) {
+        double d = m_desired[i] - m_positions[i];
+        if ((d >= 1.0 && m_positions[i + 1] - m_positions[i] > 1.0)
+            || (d <= -1.0 && m_positions[i - 1] - m_positions[i] < -1.0)) {
+            int step = d >= 0.0 ? 1 : -1;
+            double candidate = parabolic(i, step);
+            if (m_heights[i - 1] < candidate && candidate < m_heights[i + 1]) {
+                m_heights[i] = candidate;
+            } else {
+                m_heights[i] = linear(i, step);
+            }
+            m_positions[i] += step;
+        }
+    }
+}
+
+P2Quantile P2Quantile::merged(const QVector<P2Quantile> &parts)
+{
+    P2Quantile result(parts.isEmpty() ? 0.5 : parts.first().m_quantile);
+    
+    // Seed values are exact, so partly seeded parts are simply replayed
+    QVector<const P2Quantile *> seeded;
+    QVector<double> loose;
+    for (const P2Quantile &part : parts) {
+        if (part.m_count >= 5) {
+            seeded.append(&part);
+        } else {
+            loose.append(QVector<double>(part.m_heights, part.m_heights + part.m_count));
+        }
+    }
+    if (seeded.size() == 1) {
+        result = *seeded.first();
+    } else if (seeded.size() > 1) {
+        result.combine(seeded);
+    }
+    for (double value : loose) {
+        result.add(value);
+    }
+    return result;
+}
+
+void P2Quantile::combine(const QVector<const P2Quantile *> &parts)
+{
+    // Each part's markers describe its rank curve; the combined markers sit
+    // where the curves together reach the desired positions
+    quint64 total = 0;
+    double heights[5] = { parts.first()->m_heights[0], 0.0, 0.0, 0.0, parts.first()->m_heights[4] };
+    for (const P2Quantile *part : parts) {
+        total += part->m_count;
+        heights[0] = qMin(heights[0], part->m_heights[0]);
+        heights[4] = qMax(heights[4], part->m_heights[4]);
+    }
+    for (int i = 1; i < 4; ++i) {
+        const double target = 1.0 + (total - 1) * m_increments[i];
+        double low = heights[i - 1];
+        double high = heights[4];
+        for (int iteration = 0; iteration < 64 && low < high; ++iteration) {
+            double middle = 0.5 * (low + high);
+            double rank = 0.0;
+            for (const P2Quantile *part : parts) {
+                rank += part->rank(middle);
+            }
+            if (rank < target) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        heights[i] = 0.5 * (low + high);
+    }
+    
+    m_count = total;
+    for (int i = 0; i < 5; ++i) {
+        m_heights[i] = heights[i];
+        m_desired[i] = 1.0 + (total - 1) * m_increments[i];
+    }
+    
+    // Integer positions, strictly increasing as add() expects
+    m_positions[0] = 1.0;
+    m_positions[4] = double(total);
+    for (int i = 1; i < 4; ++i) {
+        m_positions[i] = qBound(m_positions[i - 1] + 1.0, std::round(m_desired[i]), double(total) - (4 - i));
+    }
+}
+
+double P2Quantile::value() const
+{
+    if (m_count == 0) {
+        return 0.0;
+    }
+    
+    if (m_count < 5) {
+        // Exact quantile of the few values seen so far
+        double sorted[5];
+        std::copy(m_heights, m_heights + m_count, sorted);
+        std::sort(sorted, sorted + m_count);
+        int index = qBound(0, int(std::lround(m_quantile * (m_count - 1))), int(m_count) - 1);
+        return sorted[index];
+    }
+    
+    return m_heights[2];
+}
+
+double P2Quantile::parabolic(int i, double d) const
+{
+    const double *q = m_heights;
+    const double *n = m_positions;
+    return q[i] + d / (n[i + 1] - n[i - 1])
+           * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i])
+              + (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+    return m_heights[i] + d * (m_heights[i + d] - m_heights[i]) / (m_positions[i + d] - m_positions[i]);
+}
+
+// Approximate number of values at or below value, from quadratics
+// through neighbouring markers; only meaningful once the markers are seeded
+double P2Quantile::rank(double value) const
+{
+    if (value < m_heights[0]) {
+        return 0.0;
+    }
+    if (value >= m_heights[4]) {
+        return double(m_count);
+    }
+    
+    int k = 0;
+    while (k < 3 && value >= m_heights[k + 1]) {
+        k++;
+    }
+    if (m_heights[k + 1] <= m_heights[k]) {
+        return m_positions[k + 1];
+    }
+    
+    // Averages the quadratics through the markers either side of the cell,
+    // kept within the cell's positions
+    double sum = 0.0;
+    int fits = 0;
+    for (int first = qMax(0, k - 1); first <= qMin(2, k); ++first) {
+        const double *q = m_heights + first;
+        const double *n = m_positions + first;
+        if (q[0] < q[1] && q[1] < q[2]) {
+            sum += n[0] * (value - q[1]) * (value - q[2]) / ((q[0] - q[1]) * (q[0] - q[2]))
+                   + n[1] * (value - q[0]) * (value - q[2]) / ((q[1] - q[0]) * (q[1] - q[2]))
+                   + n[2] * (value - q[0]) * (value - q[1]) / ((q[2] - q[0]) * (q[2] - q[1]));
+            fits++;
+        }
+    }
+    double fraction = (value - m_heights[k]) / (m_heights[k + 1] - m_heights[k]);
+    double estimate = fits > 0 ? sum / fits
+                      : m_positions[k] + fraction * (m_positions[k + 1] - m_positions[k]);
+    return qBound(m_positions[k], estimate, m_positions[k + 1]);
+}
@@ -0,0 +1,40 @@
+#ifndef P2QUANTILE_H
+#define P2QUANTILE_H
+
+#include <QVector>
+
+// Streaming quantile estimate with the P-square algorithm (Jain & Chlamtac).
+// Keeps five markers regardless of how many values are added, so
+// percentiles of very long runs need no stored samples.
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double quantile = 0.5);
+    
+    void add(double value);
+    void reset();
+    
+    // Combines estimators of the same quantile, as if all their values had
+    // been added to one; the result depends on the order of parts, so a
+    // fixed order keeps it reproducible
+    static P2Quantile merged(const QVector<P2Quantile> &parts);
+    
+    double quantile() const { return m_quantile; }
+    quint64 count() const { return m_count; }
+    double value() const;
+
+private:
+    double parabolic(int i, double d) const;
+    double linear(int i, int d) const;
+    void combine(const QVector<const P2Quantile *> &parts);
+    double rank(double value) const;
+    
+    double m_quantile;
+    quint64 m_count;
+    double m_heights[5];        // marker heights
+    double m_positions[5];      // actual marker positions
+    double m_desired[5];        // desired marker positions
+    double m_increments[5];     // desired position increments
+};
+
+#endif // P2QUANTILE_H
@@ -0,0 +1,68 @@
+#include "pidcontroller.h"
+#include <QtGlobal>
+
+PidController::PidController(double kp, double ki, double kd)
+    : m_kp(kp)
+    , m_ki(ki)
+    , m_kd(kd)
+    , m_outputMin(0.0)
+    , m_outputMax(100.0)
+    , m_reverseActing(true)
+    , m_integral(0.0)
+    , m_previousMeasurement(0.0)
+    , m_hasPrevious(false)
+    , m_output(0.0)
+{
+}
+
+void PidController::setGains(double kp, double ki, double kd)
+{
+    m_kp = kp;
+    m_ki = ki;
+    m_kd = kd;
+}
+
+void PidController::setOutputLimits(double minimum, double maximum)
+{
+    m_outputMin = minimum;
+    m_outputMax = maximum;
+    m_output = qBound(m_outputMin, m_output, m_outputMax);
+}
+
+double PidController::update(double setpoint, double measurement, double deltaTime)
+{
+    if (deltaTime <= 0.0) {
+        return m_output;
+    }
+    
+    double error = m_reverseActing ? measurement - setpoint : setpoint - measurement;
+    
+    // Derivative on measurement avoids a kick on setpoint changes
+    double derivative = 0.0;
+    if (m_hasPrevious) {
+        double slope = (measurement - m_previousMeasurement) / deltaTime;
+        derivative = m_reverseActing ? slope : -slope;
+    }
+    m_previousMeasurement = measurement;
+    m_hasPrevious = true;
+    
+    double candidateIntegral = m_integral + error * deltaTime;
+    double unclamped = m_kp * error + m_ki * candidateIntegral + m_kd * derivative;
+    
+    // Only integrate while the output is not saturated in the error's direction
+    bool saturatedHigh = unclamped > m_outputMax && error > 0.0;
+    bool saturatedLow = unclamped < m_outputMin && error < 0.0;
+    if (!saturatedHigh && !saturatedLow) {
+        m_integral = candidateIntegral;
+    }
+    
+    m_output = qBound(m_outputMin, m_kp * error + m_ki * m_integral + m_kd * derivative, m_outputMax);
+    return m_output;
+}
+
+void PidController::reset()
+{
+    m_integral = 0.0;
+    m_hasPrevious = false;
+    m_output = m_outputMin;
+}
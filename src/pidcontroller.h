@@ -0,0 +1,40 @@
+#ifndef PIDCONTROLLER_H
+#define PIDCONTROLLER_H
+
+// Discrete PID controller with output clamping and conditional
+// integration (anti-windup). Reverse acting by default, i.e. the output
+// rises when the measurement is above the setpoint, as a cooling
+// controller needs.
+class PidController
+{
+public:
+    PidController(double kp = 1.0, double ki = 0.0, double kd = 0.0);
+    
+    void setGains(double kp, double ki, double kd);
+    double getKp() const { return m_kp; }
+    double getKi() const { return m_ki; }
+    double getKd() const { return m_kd; }
+    
+    void setOutputLimits(double minimum, double maximum);
+    void setReverseActing(bool reverse) { m_reverseActing = reverse; }
+    
+    double update(double setpoint, double measurement, double deltaTime);
+    void reset();
+    
+    double getOutput() const { return m_output; }
+
+private:
+    double m_kp;
+    double m_ki;
+    double m_kd;
+    double m_outputMin;
+    double m_outputMax;
+    bool m_reverseActing;
+    
+    double m_integral;
+    double m_previousMeasurement;
+    bool m_hasPrevious;
+    double m_output;
+};
+
+#endif // PIDCONTROLLER_H
@@ -0,0 +1,124 @@
+#include "rendersnapshot.h"
+#include "datamodel.h"
+
+namespace {
+    double lerp(double from, double to, double alpha)
+    {
+        return from + (to - from) * alpha;
+    }
+    
+    template <typename T, int N>
+    T at(const T (&values)[N], int index)
+    {
+        return (index >= 0 && index < N) ? values[index] : T();
+    }
+}
+
+RenderSnapshot::RenderSnapshot()
+    : systemRunning(false)
+    , supplyTemp(0.0)
+    , returnTemp(0.0)
+    , flowRate(0.0)
+    , heaterPower(0.0)
+    , tankLevel(0.0)
+{
+    for (int i = 0; i < PumpCount; ++i) {
+        pumpStates[i] = false;
+    }
+    for (int i = 0; i < ChannelCount; ++i) {
+        channelStates[i] = false;
+        channelFlowRates[i] = 0.0;
+    }
+    for (int i = 0; i < LoopCount; ++i) {
+        compressorStates[i] = false;
+        solenoidValveStates[i] = false;
+        blowerStates[i] = false;
+        blowerSpeeds[i] = 0.0;
+        pheTemps[i] = 0.0;
+        condenserTemps[i] = 0.0;
+    }
+}
+
+RenderSnapshot RenderSnapshot::capture(const DataModel *model)
+{
+    RenderSnapshot snapshot;
+    snapshot.systemRunning = model->isSystemRunning();
+    snapshot.supplyTemp = model->getSupplyTemp();
+    snapshot.returnTemp = model->getReturnTemp();
+    snapshot.flowRate = model->getFlowRate();
+    snapshot.heaterPower = model->getHeaterPower();
+    snapshot.tankLevel = model->getTankLevel();
+    
+    for (int i = 0; i < PumpCount; ++i) {
+        snapshot.pumpStates[i] = model->getPumpState(i);
+    }
+    for (int i = 0; i < ChannelCount; ++i) {
+        snapshot.channelStates[i] = model->getChannelState(i);
+        snapshot.channelFlowRates[i] = model->getChannelFlowRate(i);
+    }
+    for (int i = 0; i < LoopCount; ++i) {
+        snapshot.compressorStates[i] = model->getCompressorState(i);
+        snapshot.solenoidValveStates[i] = model->getSolenoidValveState(i);
+        snapshot.blowerStates[i] = model->getBlowerState(i);
+        snapshot.blowerSpeeds[i] = model->getBlowerSpeed(i);
+        snapshot.pheTemps[i] = model->getPHETemp(i);
+        snapshot.condenserTemps[i] = model->getCondenserTemp(i);
+    }
+    return snapshot;
+}
+
+RenderSnapshot RenderSnapshot::interpolate(const RenderSnapshot &from, const RenderSnapshot &to, double alpha)
+{
+    if (alpha >= 1.0) {
+        return to;
+    }
+    alpha = qMax(0.0, alpha);
+    
+    RenderSnapshot snapshot = to;
+    snapshot.supplyTemp = lerp(from.supplyTemp, to.supplyTemp, alpha);
+    snapshot.returnTemp = lerp(from.returnTemp, to.returnTemp, alpha);
+    snapshot.flowRate = lerp(from.flowRate, to.flowRate, alpha);
+    snapshot.heaterPower = lerp(from.heaterPower, to.heaterPower, alpha);
+    snapshot.tankLevel = lerp(from.tankLevel, to.tankLevel, alpha);
+    
+    for (int i = 0; i < ChannelCount; ++i) {
+        snapshot.channelFlowRates[i] = lerp(from.channelFlowRates[i], to.channelFlowRates[i], alpha);
+    }
+    for (int i = 0; i < LoopCount; ++i) {
+        snapshot.blowerSpeeds[i] = lerp(from.blowerSpeeds[i], to.blowerSpeeds[i], alpha);
+        snapshot.pheTemps[i] = lerp(from.pheTemps[i], to.pheTemps[i], alpha);
+        snapshot.condenserTemps[i] = lerp(from.condenserTemps[i], to.condenserTemps[i], alpha);
+    }
+    return snapshot;
+}
+
+bool RenderSnapshot::continuousEquals(const RenderSnapshot &other) const
+{
+    if (supplyTemp != other.supplyTemp || returnTemp != other.returnTemp
+        || flowRate != other.flowRate || heaterPower != other.heaterPower
+        || tankLevel != other.tankLevel) {
+        return false;
+    }
+    for (int i = 0; i < ChannelCount; ++i) {
+        if (channelFlowRates[i] != other.channelFlowRates[i]) {
+            return false;
+        }
+    }
+    for (int i = 0; i < LoopCount; ++i) {
+        if (blowerSpeeds[i] != other.blowerSpeeds[i] || pheTemps[i] != other.pheTemps[i]
+            || condenserTemps[i] != other.condenserTemps[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RenderSnapshot::pumpState(int pump) const { return at(pumpStates, pump); }
+bool RenderSnapshot::channelState(int channel) const { return at(channelStates, channel); }
+double RenderSnapshot::channelFlowRate(int channel) const { return at(channelFlowRates, channel); }
+bool RenderSnapshot::compressorState(int loop) const { return at(compressorStates, loop); }
+bool RenderSnapshot::solenoidValveState(int loop) const { return at(solenoidValveStates, loop); }
+bool RenderSnapshot::blowerState(int loop) const { return at(blowerStates, loop); }
+double RenderSnapshot::blowerSpeed(int loop) const { return at(blowerSpeeds, loop); }
+double RenderSnapshot::pheTemp(int loop) const { return at(pheTemps, loop); }
+double RenderSnapshot::condenserTemp(int loop) const { return at(condenserTemps, loop); }
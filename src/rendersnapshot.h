@@ -0,0 +1,62 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include "controlinterface.h"
+
+class DataModel;
+
+// What the views draw of the model at one instant. The simulation clock
+// keeps the snapshots of the last two steps and hands the views a blend of
+// them, so temperatures, levels and speeds move smoothly at display rate
+// however slowly the model steps. On/off states are never blended; they
+// switch when the newer snapshot is taken.
+struct RenderSnapshot
+{
+    enum {
+        PumpCount = ModelSnapshot::PumpCount,
+        ChannelCount = 4,
+        LoopCount = ModelSnapshot::LoopCount
+    };
+    
+    RenderSnapshot();
+    
+    static RenderSnapshot capture(const DataModel *model);
+    
+    // Continuous values of from..to at alpha in [0, 1], states of to
+    static RenderSnapshot interpolate(const RenderSnapshot &from, const RenderSnapshot &to, double alpha);
+    
+    // Whether any continuous value differs; equal snapshots need no blending
+    bool continuousEquals(const RenderSnapshot &other) const;
+    
+    // Bounds-checked like the DataModel getters; layouts may bind any index
+    bool pumpState(int pump) const;
+    bool channelState(int channel) const;
+    double channelFlowRate(int channel) const;
+    bool compressorState(int loop) const;
+    bool solenoidValveState(int loop) const;
+    bool blowerState(int loop) const;
+    double blowerSpeed(int loop) const;
+    double pheTemp(int loop) const;
+    double condenserTemp(int loop) const;
+    
+    // Discrete
+    bool systemRunning;
+    bool pumpStates[PumpCount];
+    bool channelStates[ChannelCount];
+    bool compressorStates[LoopCount];
+    bool solenoidValveStates[LoopCount];
+    bool blowerStates[LoopCount];
+    
+    // Continuous
+    double supplyTemp;
+    double returnTemp;
+    double flowRate;
+    double heaterPower;
+    double tankLevel;
+    double channelFlowRates[ChannelCount];
+    double blowerSpeeds[LoopCount];
+    double pheTemps[LoopCount];
+    double condenserTemps[LoopCount];
+};
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,552 @@
+#include "scenarioengine.h"
+#include "datamodel.h"
+#include "controlsystem.h"
+#include <QFile>
+#include <QDir>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QDebug>
+#include <limits>
+
+namespace {
+    // Derived sequences never space steps further apart than this
+    const double kMaxSequenceSpacing = 2.0;
+    
+    struct ActionName {
+        const char *name;
+        ScenarioEvent::Action action;
+    };
+    
+    const ActionName kActionNames[] = {
+        {"system", ScenarioEvent::SystemRunning},
+        {"pump", ScenarioEvent::Pump},
+        {"channel", ScenarioEvent::Channel},
+        {"compressor", ScenarioEvent::Compressor},
+        {"solenoid_valve", ScenarioEvent::SolenoidValve},
+        {"blower", ScenarioEvent::Blower},
+        {"blower_speed", ScenarioEvent::BlowerSpeed},
+        {"cooling_capacity", ScenarioEvent::CoolingCapacity},
+        {"supply_setpoint", ScenarioEvent::SupplySetpoint},
+        {"fault", ScenarioEvent::Fault}
+    };
+    
+    bool actionFromName(const QString &name, ScenarioEvent::Action *action)
+    {
+        for (const ActionName &entry : kActionNames) {
+            if (name == QLatin1String(entry.name)) {
+                *action = entry.action;
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    QString actionName(ScenarioEvent::Action action)
+    {
+        for (const ActionName &entry : kActionNames) {
+            if (entry.action == action) {
+                return QString::fromLatin1(entry.name);
+            }
+        }
+        return QString();
+    }
+    
+    bool isRampable(ScenarioEvent::Action action)
+    {
+        return action == ScenarioEvent::BlowerSpeed
+            || action == ScenarioEvent::CoolingCapacity
+            || action == ScenarioEvent::SupplySetpoint;
+    }
+    
+    double jsonNumber(const QJsonValue &value)
+    {
+        return value.isBool() ? (value.toBool() ? 1.0 : 0.0) : value.toDouble();
+    }
+}
+
+QString ScenarioEvent::describe() const
+{
+    if (action == SensorFault) {
+        return QString("sensor_fault %1 %2").arg(fault, value > 0.5 ? "start" : "end");
+    }
+    
+    QString text = actionName(action);
+    if (action == Fault) {
+        text += QString(" %1").arg(fault);
+    }
+    if (action != SystemRunning && action != CoolingCapacity && action != SupplySetpoint) {
+        text += QString(" %1").arg(index + 1);
+    }
+    text += QString(" -> %1").arg(value);
+    if (rampDuration > 0.0) {
+        text += QString(" over %1 s").arg(rampDuration);
+    }
+    return text;
+}
+
+ScenarioEngine::ScenarioEngine(DataModel *dataModel, QObject *parent)
+    : QObject(parent)
+    , m_dataModel(dataModel)
+    , m_controlSystem(nullptr)
+    , m_nextSequence(0)
+    , m_lastEventEnd(0.0)
+    , m_time(0.0)
+    , m_duration(0.0)
+    , m_active(false)
+    , m_analyticJumps(true)
+    , m_modelSteps(0)
+{
+}
+
+QVector<ScenarioDefinition> ScenarioEngine::loadScenarioFile(const QString &fileName, QString *errorMessage)
+{
+    QVector<ScenarioDefinition> scenarios;
+    
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("Cannot open %1").arg(fileName);
+        }
+        return scenarios;
+    }
+    
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        if (errorMessage) {
+            *errorMessage = QString("%1: %2").arg(fileName, parseError.errorString());
+        }
+        return scenarios;
+    }
+    
+    const QJsonArray entries = document.object().value("test_scenarios").toArray();
+    for (const QJsonValue &entry : entries) {
+        QJsonObject json = entry.toObject();
+        ScenarioDefinition scenario;
+        scenario.name = json.value("name").toString();
+        scenario.duration = json.value("duration_seconds").toDouble();
+        scenario.json = json;
+        scenarios.append(scenario);
+    }
+    
+    return scenarios;
+}
+
+QString ScenarioEngine::defaultScenarioFile()
+{
+    // Next to the executable, one level up (bin/), or the working directory
+    const QString appDir = QCoreApplication::applicationDirPath();
+    const QStringList candidates = {
+        appDir + "/test_data.json",
+        appDir + "/../test_data.json",
+        QDir::currentPath() + "/test_data.json"
+    };
+    
+    for (const QString &candidate : candidates) {
+        if (QFile::exists(candidate)) {
+            return QDir::cleanPath(candidate);
+        }
+    }
+    return QString();
+}
+
+bool ScenarioEngine::start(const ScenarioDefinition &scenario, QString *errorMessage)
+{
+    stop();
+    
+    if (!compile(scenario, errorMessage)) {
+        return false;
+    }
+    configureSensors(scenario.json);
+    
+    m_scenarioName = scenario.name;
+    m_time = 0.0;
+    m_modelSteps = 0;
+    m_active = true;
+    return true;
+}
+
+void ScenarioEngine::stop()
+{
+    m_active = false;
+    m_queue = decltype(m_queue)();
+    m_ramps.clear();
+    m_faultWindows.clear();
+}
+
+bool ScenarioEngine::compile(const ScenarioDefinition &scenario, QString *errorMessage)
+{
+    m_queue = decltype(m_queue)();
+    m_ramps.clear();
+    m_nextSequence = 0;
+    m_lastEventEnd = 0.0;
+    m_duration = qMax(0.0, scenario.duration);
+    
+    // Explicit timelines win; otherwise derive an ordered sequence from
+    // the target state of the scenario
+    if (scenario.json.contains("events")) {
+        compileEventList(scenario.json.value("events").toArray());
+    } else {
+        compileStateSequence(scenario.json, m_duration);
+    }
+    
+    if (m_queue.empty()) {
+        if (errorMessage) {
+            *errorMessage = QString("Scenario '%1' has no events").arg(scenario.name);
+        }
+        return false;
+    }
+    
+    m_duration = qMax(m_duration, m_lastEventEnd);
+    return true;
+}
+
+void ScenarioEngine::compileEventList(const QJsonArray &events)
+{
+    for (const QJsonValue &entry : events) {
+        QJsonObject json = entry.toObject();
+        
+        ScenarioEvent::Action action;
+        if (!actionFromName(json.value("action").toString(), &action)) {
+            qWarning() << "Unknown scenario action" << json.value("action").toString();
+            continue;
+        }
+        
+        schedule(json.value("time").toDouble(),
+                 action,
+                 json.value("id").toInt(),
+                 jsonNumber(json.value("value")),
+                 json.value("ramp_seconds").toDouble(),
+                 json.value("fault").toString());
+    }
+}
+
+void ScenarioEngine::compileStateSequence(const QJsonObject &json, double duration)
+{
+    struct Step {
+        ScenarioEvent::Action action;
+        int index;
+        double value;
+    };
+    QVector<Step> steps;
+    
+    QJsonObject systemState = json.value("system_state").toObject();
+    bool running = systemState.value("running").toBool();
+    const QJsonArray pumps = json.value("pumps").toArray();
+    const QJsonArray channels = json.value("channels").toArray();
+    const QJsonArray loops = json.value("refrigerant_loops").toArray();
+    
+    if (running) {
+        // Start-up order: power, coolant flow, channels, then refrigeration
+        steps.append({ScenarioEvent::SystemRunning, 0, 1.0});
+        for (const QJsonValue &pump : pumps) {
+            QJsonObject p = pump.toObject();
+            steps.append({ScenarioEvent::Pump, p.value("id").toInt(), jsonNumber(p.value("running"))});
+        }
+        for (const QJsonValue &channel : channels) {
+            QJsonObject c = channel.toObject();
+            steps.append({ScenarioEvent::Channel, c.value("id").toInt(), jsonNumber(c.value("open"))});
+        }
+        for (const QJsonValue &loop : loops) {
+            QJsonObject l = loop.toObject();
+            int id = l.value("id").toInt();
+            steps.append({ScenarioEvent::SolenoidValve, id, jsonNumber(l.value("solenoid_valve_open"))});
+            steps.append({ScenarioEvent::Compressor, id, jsonNumber(l.value("compressor_running"))});
+            steps.append({ScenarioEvent::BlowerSpeed, id, l.value("blower_speed_percent").toDouble()});
+            steps.append({ScenarioEvent::Blower, id, jsonNumber(l.value("blower_running"))});
+        }
+    } else {
+        // Shutdown runs the same order in reverse
+        for (const QJsonValue &loop : loops) {
+            QJsonObject l = loop.toObject();
+            int id = l.value("id").toInt();
+            steps.append({ScenarioEvent::Compressor, id, jsonNumber(l.value("compressor_running"))});
+            steps.append({ScenarioEvent::SolenoidValve, id, jsonNumber(l.value("solenoid_valve_open"))});
+            steps.append({ScenarioEvent::Blower, id, jsonNumber(l.value("blower_running"))});
+        }
+        for (const QJsonValue &channel : channels) {
+            QJsonObject c = channel.toObject();
+            steps.append({ScenarioEvent::Channel, c.value("id").toInt(), jsonNumber(c.value("open"))});
+        }
+        for (const QJsonValue &pump : pumps) {
+            QJsonObject p = pump.toObject();
+            steps.append({ScenarioEvent::Pump, p.value("id").toInt(), jsonNumber(p.value("running"))});
+        }
+        steps.append({ScenarioEvent::SystemRunning, 0, 0.0});
+    }
+    
+    // Spread the sequence over the first half of the scenario
+    double spacing = qMin(kMaxSequenceSpacing, duration * 0.5 / qMax(1, steps.size()));
+    for (int i = 0; i < steps.size(); ++i) {
+        schedule(i * spacing, steps[i].action, steps[i].index, steps[i].value);
+    }
+    
+    if (systemState.contains("cooling_capacity_kw")) {
+        schedule(0.0, ScenarioEvent::CoolingCapacity, 0,
+                 systemState.value("cooling_capacity_kw").toDouble(), duration * 0.5);
+    }
+}
+
+void ScenarioEngine::configureSensors(const QJsonObject &json)
+{
+    // Each scenario starts from perfect sensors unless it says otherwise
+    SensorFaultInjector *sensors = m_dataModel->sensorFaults();
+    sensors->clearFaults();
+    sensors->clearNoise();
+    m_faultWindows.clear();
+    
+    if (json.contains("sensor_noise")) {
+        QJsonObject noise = json.value("sensor_noise").toObject();
+        sensors->setSeed(quint64(noise.value("seed").toDouble(1.0)));
+        sensors->setDefaultNoise(noise.value("scale").toDouble(1.0));
+    }
+    
+    // Fault times are relative to the scenario start
+    const double startTime = m_dataModel->getSimulationTime();
+    for (const QJsonValue &entry : json.value("sensor_faults").toArray()) {
+        QJsonObject faultJson = entry.toObject();
+        
+        SensorFaultInjector::Fault fault;
+        fault.field = SensorFaultInjector::fieldFromName(faultJson.value("sensor").toString(),
+                                                         faultJson.value("id").toInt());
+        if (fault.field < 0
+            || !SensorFaultInjector::faultTypeFromName(faultJson.value("type").toString(), &fault.type)) {
+            qWarning() << "Ignoring sensor fault" << faultJson.value("sensor").toString()
+                       << faultJson.value("type").toString();
+            continue;
+        }
+        
+        fault.startTime = startTime + faultJson.value("time").toDouble();
+        fault.duration = faultJson.value("duration").toDouble();
+        // A stuck sensor without a value freezes at its last reading
+        double defaultValue = fault.type == SensorFaultInjector::Fault::StuckAt
+                              ? std::numeric_limits<double>::quiet_NaN() : 0.0;
+        fault.value = faultJson.value("value").toDouble(defaultValue);
+        fault.rate = faultJson.value("rate").toDouble();
+        sensors->addFault(fault);
+        
+        // Queued so analytic jumps stop at both ends of the fault; the model
+        // is stepped normally in between so intermittent faults still fire
+        const double faultTime = qMax(0.0, faultJson.value("time").toDouble());
+        const QString label = QString("%1 %2").arg(SensorFaultInjector::fieldName(fault.field),
+                                                   faultJson.value("type").toString());
+        if (faultTime <= m_duration) {
+            schedule(faultTime, ScenarioEvent::SensorFault, fault.field, 1.0, 0.0, label);
+        }
+        if (fault.duration > 0.0) {
+            const double endTime = qMin(faultTime + fault.duration, m_duration);
+            if (endTime > faultTime) {
+                schedule(endTime, ScenarioEvent::SensorFault, fault.field, 0.0, 0.0, label);
+                m_faultWindows.append({faultTime, endTime});
+            }
+        }
+    }
+}
+
+void ScenarioEngine::schedule(double time, ScenarioEvent::Action action, int index, double value,
+                              double rampDuration, const QString &fault)
+{
+    ScenarioEvent event;
+    event.time = qMax(0.0, time);
+    event.sequence = m_nextSequence++;
+    event.action = action;
+    event.index = index;
+    event.value = value;
+    event.rampDuration = isRampable(action) ? qMax(0.0, rampDuration) : 0.0;
+    event.fault = fault;
+    m_queue.push(event);
+    
+    m_lastEventEnd = qMax(m_lastEventEnd, event.time + event.rampDuration);
+}
+
+void ScenarioEngine::advance(double deltaTime)
+{
+    if (!m_active || deltaTime <= 0.0) {
+        return;
+    }
+    
+    // Realtime ticks step the model normally, split at event timestamps
+    advanceTo(m_time + deltaTime, false, deltaTime);
+    
+    if (m_queue.empty() && m_ramps.isEmpty() && m_time >= m_duration) {
+        finish();
+    }
+}
+
+void ScenarioEngine::runHeadless(double maxStep)
+{
+    if (!m_active) {
+        return;
+    }
+    
+    advanceTo(m_duration, m_analyticJumps, qMax(1e-3, maxStep));
+    finish();
+}
+
+void ScenarioEngine::advanceTo(double time, bool allowJump, double maxStep)
+{
+    while (!m_queue.empty() && m_queue.top().time <= time) {
+        ScenarioEvent event = m_queue.top();
+        m_queue.pop();
+        
+        stepModel(event.time - m_time, allowJump, maxStep);
+        applyEvent(event);
+    }
+    
+    stepModel(time - m_time, allowJump, maxStep);
+}
+
+void ScenarioEngine::stepModel(double deltaTime, bool allowJump, double maxStep)
+{
+    const double epsilon = 1e-9;
+    
+    while (deltaTime > epsilon) {
+        // Nothing changes the inputs until the next event - jump straight there
+        if (allowJump && m_ramps.isEmpty() && !inFaultWindow()) {
+            m_dataModel->advanceAnalytically(deltaTime);
+            m_time += deltaTime;
+            m_modelSteps++;
+            return;
+        }
+        
+        double step = qMin(deltaTime, maxStep);
+        for (const Ramp &ramp : m_ramps) {
+            if (ramp.endTime - m_time > epsilon) {
+                step = qMin(step, ramp.endTime - m_time);
+            }
+        }
+        
+        m_dataModel->updateSimulation(step);
+        m_time += step;
+        deltaTime -= step;
+        m_modelSteps++;
+        
+        updateRamps();
+    }
+}
+
+void ScenarioEngine::applyEvent(const ScenarioEvent &event)
+{
+    if (event.rampDuration > 0.0) {
+        // Replace any ramp already running on the same target
+        for (int i = m_ramps.size() - 1; i >= 0; --i) {
+            if (m_ramps[i].action == event.action && m_ramps[i].index == event.index) {
+                m_ramps.removeAt(i);
+            }
+        }
+        
+        Ramp ramp;
+        ramp.action = event.action;
+        ramp.index = event.index;
+        ramp.startTime = m_time;
+        ramp.endTime = m_time + event.rampDuration;
+        ramp.startValue = currentValue(event.action, event.index);
+        ramp.endValue = event.value;
+        m_ramps.append(ramp);
+    } else if (event.action == ScenarioEvent::Fault) {
+        if (event.fault == "pump_trip") {
+            m_dataModel->setPumpState(event.index, false);
+        } else if (event.fault == "compressor_trip") {
+            m_dataModel->setCompressorState(event.index, false);
+            m_dataModel->setSolenoidValveState(event.index, false);
+        } else if (event.fault == "blower_trip") {
+            m_dataModel->setBlowerState(event.index, false);
+        } else if (event.fault == "channel_block") {
+            m_dataModel->setChannelState(event.index, false);
+        } else {
+            qWarning() << "Unknown scenario fault" << event.fault;
+        }
+    } else {
+        applyValue(event.action, event.index, event.value);
+    }
+    
+    emit eventApplied(event.describe(), m_time);
+}
+
+void ScenarioEngine::applyValue(ScenarioEvent::Action action, int index, double value)
+{
+    bool on = value > 0.5;
+    
+    switch (action) {
+    case ScenarioEvent::SystemRunning:
+        // The scenario's own events bring up the equipment, in its order
+        m_dataModel->setSystemRunning(on, false);
+        break;
+    case ScenarioEvent::Pump:
+        m_dataModel->setPumpState(index, on);
+        break;
+    case ScenarioEvent::Channel:
+        m_dataModel->setChannelState(index, on);
+        break;
+    case ScenarioEvent::Compressor:
+        m_dataModel->setCompressorState(index, on);
+        break;
+    case ScenarioEvent::SolenoidValve:
+        m_dataModel->setSolenoidValveState(index, on);
+        break;
+    case ScenarioEvent::Blower:
+        m_dataModel->setBlowerState(index, on);
+        break;
+    case ScenarioEvent::BlowerSpeed:
+        m_dataModel->setBlowerSpeed(index, value);
+        break;
+    case ScenarioEvent::CoolingCapacity:
+        m_dataModel->setCoolingCapacity(qRound(value));
+        break;
+    case ScenarioEvent::SupplySetpoint:
+        if (m_controlSystem) {
+            m_controlSystem->setSupplySetpoint(value);
+        }
+        break;
+    case ScenarioEvent::Fault:
+    case ScenarioEvent::SensorFault:
+        break;
+    }
+}
+
+double ScenarioEngine::currentValue(ScenarioEvent::Action action, int index) const
+{
+    switch (action) {
+    case ScenarioEvent::BlowerSpeed:
+        return m_dataModel->getBlowerSpeed(index);
+    case ScenarioEvent::CoolingCapacity:
+        return m_dataModel->getCoolingCapacity();
+    case ScenarioEvent::SupplySetpoint:
+        return m_controlSystem ? m_controlSystem->getSupplySetpoint() : 0.0;
+    default:
+        return 0.0;
+    }
+}
+
+void ScenarioEngine::updateRamps()
+{
+    for (int i = m_ramps.size() - 1; i >= 0; --i) {
+        const Ramp &ramp = m_ramps[i];
+        double fraction = qBound(0.0, (m_time - ramp.startTime) / (ramp.endTime - ramp.startTime), 1.0);
+        applyValue(ramp.action, ramp.index, ramp.startValue + (ramp.endValue - ramp.startValue) * fraction);
+        
+        if (fraction >= 1.0) {
+            m_ramps.removeAt(i);
+        }
+    }
+}
+
+bool ScenarioEngine::inFaultWindow() const
+{
+    for (const FaultWindow &window : m_faultWindows) {
+        if (m_time >= window.start && m_time < window.end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ScenarioEngine::finish()
+{
+    if (m_active) {
+        m_active = false;
+        m_ramps.clear();
+        emit scenarioFinished(m_scenarioName);
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef SCENARIOENGINE_H
+#define SCENARIOENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <queue>
+
+class DataModel;
+class ControlSystem;
+
+// One entry of test_data.json
+struct ScenarioDefinition
+{
+    QString name;
+    double duration;
+    QJsonObject json;
+};
+
+// Timed action on the model
+struct ScenarioEvent
+{
+    enum Action {
+        SystemRunning,
+        Pump,
+        Channel,
+        Compressor,
+        SolenoidValve,
+        Blower,
+        BlowerSpeed,
+        CoolingCapacity,
+        SupplySetpoint,
+        Fault,
+        SensorFault     // value 1 opens a sensor fault window, 0 closes it
+    };
+    
+    double time;
+    quint64 sequence;       // keeps file order for equal timestamps
+    Action action;
+    int index;
+    double value;
+    double rampDuration;    // > 0 turns a setpoint change into a ramp
+    QString fault;          // fault name, or "<sensor> <type>" for SensorFault
+    
+    QString describe() const;
+};
+
+// Compiles a scenario into a time-ordered event queue and plays it
+// against the DataModel. Events are applied at their exact timestamps:
+// the model is stepped up to each event, the event applied, and stepping
+// continues. Between events, and outside timed sensor faults, the headless
+// runner can jump analytically.
+class ScenarioEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScenarioEngine(DataModel *dataModel, QObject *parent = nullptr);
+    
+    static QVector<ScenarioDefinition> loadScenarioFile(const QString &fileName, QString *errorMessage = nullptr);
+    static QString defaultScenarioFile();
+    
+    void setControlSystem(ControlSystem *controlSystem) { m_controlSystem = controlSystem; }
+    
+    bool start(const ScenarioDefinition &scenario, QString *errorMessage = nullptr);
+    void stop();
+    
+    bool isActive() const { return m_active; }
+    QString getScenarioName() const { return m_scenarioName; }
+    double getScenarioTime() const { return m_time; }
+    double getDuration() const { return m_duration; }
+    int getPendingEventCount() const { return int(m_queue.size()); }
+    
+    // Realtime mode - called from the animation tick
+    void advance(double deltaTime);
+    
+    // Headless mode - runs to the end of the scenario as fast as possible.
+    // maxStep bounds the integration step while ramps are active or when
+    // analytic jumps are disabled.
+    void runHeadless(double maxStep = 0.1);
+    
+    void setAnalyticJumps(bool enabled) { m_analyticJumps = enabled; }
+    bool analyticJumpsEnabled() const { return m_analyticJumps; }
+    
+    quint64 getModelSteps() const { return m_modelSteps; }
+
+signals:
+    void eventApplied(const QString &description, double time);
+    void scenarioFinished(const QString &name);
+
+private:
+    struct Ramp {
+        ScenarioEvent::Action action;
+        int index;
+        double startTime;
+        double endTime;
+        double startValue;
+        double endValue;
+    };
+    
+    // Scenario times during which a timed sensor fault is active
+    struct FaultWindow {
+        double start;
+        double end;
+    };
+    
+    struct LaterEvent {
+        bool operator()(const ScenarioEvent &a, const ScenarioEvent &b) const {
+            if (a.time != b.time) {
+                return a.time > b.time;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+    
+    bool compile(const ScenarioDefinition &scenario, QString *errorMessage);
+    void compileEventList(const QJsonArray &events);
+    void compileStateSequence(const QJsonObject &json, double duration);
+    void configureSensors(const QJsonObject &json);
+    void schedule(double time, ScenarioEvent::Action action, int index, double value,
+                  double rampDuration = 0.0, const QString &fault = QString());
+    
+    void advanceTo(double time, bool allowJump, double maxStep);
+    void stepModel(double deltaTime, bool allowJump, double maxStep);
+    void applyEvent(const ScenarioEvent &event);
+    void applyValue(ScenarioEvent::Action action, int index, double value);
+    double currentValue(ScenarioEvent::Action action, int index) const;
+    void updateRamps();
+    bool inFaultWindow() const;
+    void finish();
+    
+    DataModel *m_dataModel;
+    ControlSystem *m_controlSystem;
+    
+    std::priority_queue<ScenarioEvent, std::vector<ScenarioEvent>, LaterEvent> m_queue;
+    QVector<Ramp> m_ramps;
+    QVector<FaultWindow> m_faultWindows;
+    quint64 m_nextSequence;
+    double m_lastEventEnd;
+    
+    QString m_scenarioName;
+    double m_time;
+    double m_duration;
+    bool m_active;
+    bool m_analyticJumps;
+    quint64 m_modelSteps;
+};
+
+#endif // SCENARIOENGINE_H
@@ -0,0 +1,196 @@
+#include "sensorfaultinjector.h"
+#include <QtMath>
+#include <cmath>
+#include <limits>
+
+namespace {
+    struct FieldInfo {
+        const char *name;
+        int first;
+        int count;
+        double defaultNoise;    // realistic 1 sigma for the sensor type
+    };
+    
+    const FieldInfo kFields[] = {
+        { "supply_temp", SensorFaultInjector::SupplyTemp, 1, 0.05 },
+        { "return_temp", SensorFaultInjector::ReturnTemp, 1, 0.05 },
+        { "system_pressure", SensorFaultInjector::SystemPressure, 1, 0.01 },
+        { "return_pressure", SensorFaultInjector::ReturnPressure, 1, 0.01 },
+        { "flow_rate", SensorFaultInjector::FlowRate, 1, 0.5 },
+        { "tank_level", SensorFaultInjector::TankLevel, 1, 0.2 },
+        { "heater_power", SensorFaultInjector::HeaterPower, 1, 0.05 },
+        { "channel_flow", SensorFaultInjector::ChannelFlow, 4, 0.3 },
+        { "condenser_temp", SensorFaultInjector::CondenserTemp, 3, 0.1 },
+        { "phe_temp", SensorFaultInjector::PHETemp, 3, 0.1 }
+    };
+    
+    const char *const kFaultTypeNames[] = { "offset", "drift", "stuck", "dropout", "spike" };
+}
+
+SensorFaultInjector::SensorFaultInjector(quint64 seed)
+    : m_rng(seed)
+    , m_seed(seed)
+{
+    for (int i = 0; i < FieldCount; ++i) {
+        m_noise[i] = 0.0;
+        m_normals[i] = 0.0;
+        m_lastReported[i] = 0.0;
+    }
+}
+
+void SensorFaultInjector::setSeed(quint64 seed)
+{
+    m_seed = seed;
+    m_rng = Xoshiro256(seed);
+}
+
+void SensorFaultInjector::setNoise(int field, double sigma)
+{
+    if (field >= 0 && field < FieldCount) {
+        m_noise[field] = qMax(0.0, sigma);
+    }
+}
+
+double SensorFaultInjector::noise(int field) const
+{
+    if (field >= 0 && field < FieldCount) {
+        return m_noise[field];
+    }
+    return 0.0;
+}
+
+void SensorFaultInjector::setDefaultNoise(double scale)
+{
+    for (const FieldInfo &info : kFields) {
+        for (int i = 0; i < info.count; ++i) {
+            m_noise[info.first + i] = info.defaultNoise * qMax(0.0, scale);
+        }
+    }
+}
+
+void SensorFaultInjector::clearNoise()
+{
+    for (int i = 0; i < FieldCount; ++i) {
+        m_noise[i] = 0.0;
+    }
+}
+
+int SensorFaultInjector::addFault(const Fault &fault)
+{
+    if (fault.field < 0 || fault.field >= FieldCount) {
+        return -1;
+    }
+    
+    ScheduledFault scheduled;
+    scheduled.fault = fault;
+    scheduled.started = false;
+    scheduled.heldValue = 0.0;
+    m_faults.append(scheduled);
+    return m_faults.size() - 1;
+}
+
+void SensorFaultInjector::clearFaults()
+{
+    m_faults.clear();
+}
+
+bool SensorFaultInjector::isActive() const
+{
+    if (!m_faults.isEmpty()) {
+        return true;
+    }
+    for (int i = 0; i < FieldCount; ++i) {
+        if (m_noise[i] > 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SensorFaultInjector::process(const double *truth, double *measured, double time, double deltaTime)
+{
+    // Noise for every field in one pass
+    m_rng.fillNormal(m_normals, FieldCount, 0.0, 1.0);
+    for (int i = 0; i < FieldCount; ++i) {
+        measured[i] = truth[i] + m_noise[i] * m_normals[i];
+    }
+    
+    for (ScheduledFault &scheduled : m_faults) {
+        const Fault &fault = scheduled.fault;
+        bool active = time >= fault.startTime
+                      && (fault.duration <= 0.0 || time < fault.startTime + fault.duration);
+        if (!active) {
+            continue;
+        }
+        
+        double &reading = measured[fault.field];
+        if (!scheduled.started) {
+            scheduled.started = true;
+            scheduled.heldValue = m_lastReported[fault.field];
+        }
+        
+        // Chance of an intermittent event within this tick
+        double chance = 1.0 - qExp(-fault.rate * qMax(0.0, deltaTime));
+        
+        switch (fault.type) {
+        case Fault::Offset:
+            reading += fault.value;
+            break;
+        case Fault::Drift:
+            reading += fault.value * (time - fault.startTime) / 3600.0;
+            break;
+        case Fault::StuckAt:
+            reading = std::isnan(fault.value) ? scheduled.heldValue : fault.value;
+            break;
+        case Fault::Dropout:
+            if (fault.rate <= 0.0 || m_rng.uniform() < chance) {
+                reading = std::numeric_limits<double>::quiet_NaN();
+            }
+            break;
+        case Fault::Spike:
+            if (m_rng.uniform() < chance) {
+                reading += m_rng.uniform() < 0.5 ? -fault.value : fault.value;
+            }
+            break;
+        }
+    }
+    
+    // Stuck-at faults freeze the last good reading
+    for (int i = 0; i < FieldCount; ++i) {
+        if (!std::isnan(measured[i])) {
+            m_lastReported[i] = measured[i];
+        }
+    }
+}
+
+int SensorFaultInjector::fieldFromName(const QString &name, int index)
+{
+    for (const FieldInfo &info : kFields) {
+        if (name == QLatin1String(info.name)) {
+            return (index >= 0 && index < info.count) ? info.first + index : -1;
+        }
+    }
+    return -1;
+}
+
+QString SensorFaultInjector::fieldName(int field)
+{
+    for (const FieldInfo &info : kFields) {
+        if (field >= info.first && field < info.first + info.count) {
+            QString name = QString::fromLatin1(info.name);
+            return info.count > 1 ? QString("%1[%2]").arg(name).arg(field - info.first) : name;
+        }
+    }
+    return QString();
+}
+
+bool SensorFaultInjector::faultTypeFromName(const QString &name, Fault::Type *type)
+{
+    for (int i = 0; i < int(sizeof(kFaultTypeNames) / sizeof(kFaultTypeNames[0])); ++i) {
+        if (name == QLatin1String(kFaultTypeNames[i])) {
+            *type = Fault::Type(i);
+            return true;
+        }
+    }
+    return false;
+}
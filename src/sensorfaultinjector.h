@@ -0,0 +1,87 @@
+#ifndef SENSORFAULTINJECTOR_H
+#define SENSORFAULTINJECTOR_H
+
+#include <QString>
+#include <QVector>
+#include "xoshiro256.h"
+
+// Turns the true plant values into what the sensors report: Gaussian
+// noise per field plus scheduled faults (offset, drift, stuck-at, dropout
+// and spikes). Every field is processed in one pass over flat arrays, and
+// all randomness comes from one seeded xoshiro256++ stream, so a run with
+// the same seed, faults and tick sequence reports identical readings.
+class SensorFaultInjector
+{
+public:
+    enum Field {
+        SupplyTemp = 0,
+        ReturnTemp,
+        SystemPressure,
+        ReturnPressure,
+        FlowRate,
+        TankLevel,
+        HeaterPower,
+        ChannelFlow,                        // 4 channels
+        CondenserTemp = ChannelFlow + 4,    // 3 condensers
+        PHETemp = CondenserTemp + 3,        // 3 PHEs
+        FieldCount = PHETemp + 3
+    };
+    
+    struct Fault {
+        enum Type {
+            Offset,     // constant bias of value
+            Drift,      // bias growing at value per hour
+            StuckAt,    // reads value; NaN holds the last reading
+            Dropout,    // reads NaN, at rate per second (0 = continuously)
+            Spike       // +/- value at rate per second
+        };
+        
+        int field;
+        Type type;
+        double startTime;   // simulation seconds
+        double duration;    // <= 0 lasts forever
+        double value;
+        double rate;
+    };
+    
+    explicit SensorFaultInjector(quint64 seed = 1);
+    
+    void setSeed(quint64 seed);
+    quint64 seed() const { return m_seed; }
+    
+    // Noise is 1 sigma in the field's own unit
+    void setNoise(int field, double sigma);
+    double noise(int field) const;
+    void setDefaultNoise(double scale = 1.0);
+    void clearNoise();
+    
+    int addFault(const Fault &fault);
+    void clearFaults();
+    int faultCount() const { return m_faults.size(); }
+    
+    // False while there is nothing to inject
+    bool isActive() const;
+    
+    // truth and measured hold FieldCount values
+    void process(const double *truth, double *measured, double time, double deltaTime);
+    
+    static int fieldFromName(const QString &name, int index = 0);
+    static QString fieldName(int field);
+    static bool faultTypeFromName(const QString &name, Fault::Type *type);
+
+private:
+    struct ScheduledFault {
+        Fault fault;
+        bool started;
+        double heldValue;
+    };
+    
+    Xoshiro256 m_rng;
+    quint64 m_seed;
+    double m_noise[FieldCount];
+    double m_normals[FieldCount];
+    double m_lastReported[FieldCount];
+    QVector<ScheduledFault> m_faults;
+};
+
+#endif // SENSORFAULTINJECTOR_H
@@ -0,0 +1,101 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSet>
+#include "rendersnapshot.h"
+
+class DataModel;
+class ScenarioEngine;
+class ControlSystem;
+
+// The one clock of the simulation. It steps the model (or the active
+// scenario) on its own timer, at its own rate, however many views are
+// attached, and gives the views a common time base that survives view
+// switches. Each view draws frames at its own rate and tells the clock
+// while it is active; with none active, or with nothing to simulate, the
+// clock does not wake at all and fast-forwards the hidden time afterwards.
+// Between steps the views draw renderState(), which blends the last two
+// steps so a slow step rate does not show as stepping.
+class SimulationClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationClock(DataModel *dataModel, QObject *parent = nullptr);
+    
+    DataModel *dataModel() const { return m_dataModel; }
+    
+    // While a scenario is active it steps the model instead
+    void setScenarioEngine(ScenarioEngine *engine);
+    
+    // Suspended whenever the clock stops stepping, so the controller does
+    // not keep waking for a model that is not moving
+    void setControlSystem(ControlSystem *controlSystem);
+    
+    // Milliseconds between model steps
+    void setStepInterval(int interval);
+    int stepInterval() const { return m_stepInterval; }
+    
+    // Milliseconds since the clock was created; frame times of all views
+    qint64 now() const { return m_elapsedTimer.elapsed(); }
+    
+    // Views showing the model; only active ones keep the model stepping
+    void attach(QObject *view);
+    void detach(QObject *view);
+    void setViewActive(QObject *view, bool active);
+    int activeViewCount() const { return m_activeViews.size(); }
+    
+    void pause();
+    void resume();
+    bool isPaused() const { return m_paused; }
+    bool isStepping() const { return m_timer->isActive(); }
+    
+    // Re-checks whether there is anything to step; model changes do this
+    // by themselves, a scenario being started does not
+    void reschedule();
+    
+    // Model steps taken; one per interval whatever the number of views
+    quint64 stepCount() const { return m_stepCount; }
+    
+    // The model as of now(): continuous values move from the previous
+    // step's towards the latest step's over one step interval
+    RenderSnapshot renderState() const;
+    
+    // Whether renderState() still changes without a new step
+    bool isInterpolating() const;
+
+signals:
+    void stepped(double deltaTime);
+
+private slots:
+    void step();
+    void onDataChanged();
+
+private:
+    DataModel *m_dataModel;
+    ScenarioEngine *m_scenarioEngine;
+    ControlSystem *m_controlSystem;
+    QTimer *m_timer;
+    QElapsedTimer m_elapsedTimer;
+    
+    QSet<QObject*> m_views;
+    QSet<QObject*> m_activeViews;
+    
+    int m_stepInterval;
+    bool m_paused;
+    bool m_catchUp;
+    qint64 m_lastStepTime;
+    quint64 m_stepCount;
+    
+    // Snapshots of the last two steps; m_current was taken at m_currentTime
+    RenderSnapshot m_previous;
+    RenderSnapshot m_current;
+    qint64 m_currentTime;
+    bool m_blending;
+    bool m_inStep;
+};
+
+#endif // SIMULATIONCLOCK_H
@@ -0,0 +1,127 @@
+#include "tilerenderer.h"
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QPainter>
+#include <QThread>
+
+TileRenderer::TileRenderer(QGraphicsView *view, int tileSize)
+    : m_view(view)
+    , m_tileSize(qMax(16, tileSize))
+    , m_pixelRatio(1.0)
+    , m_columns(0)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+TileRenderer::~TileRenderer()
+{
+    m_pool.waitForDone();
+}
+
+void TileRenderer::setThreadCount(int threads)
+{
+    m_pool.setMaxThreadCount(qMax(1, threads));
+}
+
+void TileRenderer::layoutTiles()
+{
+    m_viewportSize = m_view->viewport()->size();
+    m_pixelRatio = m_view->viewport()->devicePixelRatioF();
+    m_columns = (m_viewportSize.width() + m_tileSize - 1) / m_tileSize;
+    m_tiles.clear();
+    
+    for (int y = 0; y < m_viewportSize.height(); y += m_tileSize) {
+        for (int x = 0; x < m_viewportSize.width(); x += m_tileSize) {
+            Tile tile;
+            tile.rect = QRect(x, y, m_tileSize, m_tileSize);
+            tile.image = QImage(tile.rect.size() * m_pixelRatio, QImage::Format_ARGB32_Premultiplied);
+            tile.image.setDevicePixelRatio(m_pixelRatio);
+            m_tiles.append(tile);
+        }
+    }
+}
+
+void TileRenderer::paint(QPainter *painter, const QRegion &region)
+{
+    QGraphicsScene *scene = m_view->scene();
+    if (!scene) {
+        return;
+    }
+    
+    if (m_view->viewport()->size() != m_viewportSize || m_view->viewport()->devicePixelRatioF() != m_pixelRatio) {
+        layoutTiles();
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    // Tiles the region touches are always redrawn whole
+    QVector<Tile*> dirty;
+    QRect bounds;
+    for (Tile &tile : m_tiles) {
+        tile.dirty = region.intersects(tile.rect);
+        tile.commands.clear();
+        if (tile.dirty) {
+            dirty.append(&tile);
+            bounds |= tile.rect;
+        }
+    }
+    if (dirty.isEmpty()) {
+        return;
+    }
+    
+    // Record the scene once over all of them, in viewport coordinates
+    QTransform toScene = m_view->viewportTransform().inverted();
+    m_recording.reset(m_viewportSize, m_view->viewport());
+    QPainter recorder(&m_recording);
+    recorder.setRenderHints(m_view->renderHints());
+    scene->render(&recorder, QRectF(bounds), toScene.mapRect(QRectF(bounds)), Qt::IgnoreAspectRatio);
+    recorder.end();
+    
+    // Hand each tile the commands whose bounds reach it
+    int rows = (m_tiles.size() + m_columns - 1) / m_columns;
+    for (int i = 0; i < m_recording.commandCount(); ++i) {
+        QRectF reach = m_recording.commandBounds(i);
+        int left = qMax(0, int(reach.left()) / m_tileSize);
+        int top = qMax(0, int(reach.top()) / m_tileSize);
+        int right = qMin(m_columns - 1, int(reach.right()) / m_tileSize);
+        int bottom = qMin(rows - 1, int(reach.bottom()) / m_tileSize);
+        for (int row = top; row <= bottom; ++row) {
+            for (int column = left; column <= right; ++column) {
+                Tile &tile = m_tiles[row * m_columns + column];
+                if (tile.dirty) {
+                    tile.commands.append(i);
+                }
+            }
+        }
+    }
+    m_stats.recordNs += timer.nsecsElapsed();
+    
+    // Replay in parallel
+    timer.restart();
+    QColor background = m_view->backgroundBrush().color();
+    if (m_view->backgroundBrush().style() == Qt::NoBrush) {
+        background = m_view->viewport()->palette().color(m_view->viewport()->backgroundRole());
+    }
+    const DisplayList *recording = &m_recording;
+    for (Tile *tile : dirty) {
+        m_pool.start([tile, background, recording]() {
+            tile->image.fill(background);
+            QPainter rasterizer(&tile->image);
+            rasterizer.translate(-tile->rect.topLeft());
+            recording->replay(&rasterizer, tile->commands);
+        });
+    }
+    m_pool.waitForDone();
+    m_stats.rasterNs += timer.nsecsElapsed();
+    
+    timer.restart();
+    for (const Tile *tile : dirty) {
+        painter->drawImage(tile->rect.topLeft(), tile->image);
+    }
+    m_stats.compositeNs += timer.nsecsElapsed();
+    
+    m_stats.frames++;
+    m_stats.tiles += dirty.size();
+}
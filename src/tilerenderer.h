@@ -0,0 +1,63 @@
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <QImage>
+#include <QRegion>
+#include <QThreadPool>
+#include <QVector>
+#include "displaylist.h"
+
+class QGraphicsView;
+class QPainter;
+
+// Renders a graphics view's scene in tiles on a thread pool. A repaint is
+// recorded once into a display list on the GUI thread (item traversal
+// only, with the items' pixmap caches in use), each touched tile replays
+// the commands that reach it into its image on a worker with its own
+// QPainter, and the tiles are composited on the GUI thread.
+class TileRenderer
+{
+public:
+    struct Statistics {
+        quint64 frames = 0;
+        quint64 tiles = 0;
+        qint64 recordNs = 0;    // GUI thread
+        qint64 rasterNs = 0;    // wall time of the parallel playback
+        qint64 compositeNs = 0; // GUI thread
+    };
+    
+    explicit TileRenderer(QGraphicsView *view, int tileSize = 128);
+    ~TileRenderer();
+    
+    // Defaults to all cores
+    void setThreadCount(int threads);
+    int threadCount() const { return m_pool.maxThreadCount(); }
+    
+    // Paints the scene into region (viewport coordinates) of the view
+    void paint(QPainter *painter, const QRegion &region);
+    
+    Statistics statistics() const { return m_stats; }
+    void resetStatistics() { m_stats = Statistics(); }
+
+private:
+    struct Tile {
+        QRect rect;         // viewport coordinates
+        QImage image;
+        QVector<int> commands;  // of the frame's recording that reach the tile
+        bool dirty = false;
+    };
+    
+    void layoutTiles();
+    
+    QGraphicsView *m_view;
+    int m_tileSize;
+    QSize m_viewportSize;
+    qreal m_pixelRatio;
+    int m_columns;
+    QVector<Tile> m_tiles;
+    DisplayList m_recording;
+    QThreadPool m_pool;
+    Statistics m_stats;
+};
+
+#endif // TILERENDERER_H
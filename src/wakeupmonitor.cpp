@@ -0,0 +1,100 @@
+#include "wakeupmonitor.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutexLocker>
+#include <QThread>
+#include <QTimer>
+
+WakeupMonitor::WakeupMonitor()
+    : m_enabled(false)
+{
+}
+
+WakeupMonitor *WakeupMonitor::instance()
+{
+    static WakeupMonitor monitor;
+    return &monitor;
+}
+
+void WakeupMonitor::setEnabled(bool enabled)
+{
+    WakeupMonitor *monitor = instance();
+    if (enabled == monitor->m_enabled || !QCoreApplication::instance()) {
+        return;
+    }
+    
+    monitor->m_enabled = enabled;
+    if (enabled) {
+        QCoreApplication::instance()->installEventFilter(monitor);
+        reset();
+    } else {
+        QCoreApplication::instance()->removeEventFilter(monitor);
+    }
+}
+
+bool WakeupMonitor::isEnabled()
+{
+    return instance()->m_enabled;
+}
+
+WakeupMonitor::Statistics WakeupMonitor::statistics()
+{
+    WakeupMonitor *monitor = instance();
+    Statistics statistics = monitor->m_statistics;
+    {
+        QMutexLocker locker(&monitor->m_threadMutex);
+        for (auto it = monitor->m_threadSources.constBegin(); it != monitor->m_threadSources.constEnd(); ++it) {
+            statistics.wakeups += it.value();
+            statistics.sources[it.key()] += it.value();
+        }
+    }
+    statistics.seconds = monitor->m_clock.isValid() ? monitor->m_clock.elapsed() / 1000.0 : 0.0;
+    return statistics;
+}
+
+void WakeupMonitor::reset()
+{
+    WakeupMonitor *monitor = instance();
+    monitor->m_statistics = Statistics();
+    {
+        QMutexLocker locker(&monitor->m_threadMutex);
+        monitor->m_threadSources.clear();
+    }
+    monitor->m_clock.start();
+}
+
+void WakeupMonitor::recordWakeup(const QString &source)
+{
+    WakeupMonitor *monitor = instance();
+    if (!monitor->m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    QMutexLocker locker(&monitor->m_threadMutex);
+    monitor->m_threadSources[source]++;
+}
+
+bool WakeupMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    // Only the GUI thread; worker threads have their own loops
+    if ((event->type() == QEvent::Timer || event->type() == QEvent::MetaCall)
+        && watched->thread() == QCoreApplication::instance()->thread()) {
+        m_statistics.wakeups++;
+        m_statistics.sources[sourceName(watched)]++;
+    }
+    return false;
+}
+
+QString WakeupMonitor::sourceName(QObject *object)
+{
+    // A QTimer's owner says more than the timer itself
+    if (qobject_cast<QTimer*>(object) && object->parent()) {
+        object = object->parent();
+    }
+    
+    QString name = QString::fromLatin1(object->metaObject()->className());
+    if (!object->objectName().isEmpty()) {
+        name += QString(" (%1)").arg(object->objectName());
+    }
+    return name;
+}
@@ -0,0 +1,56 @@
+#ifndef WAKEUPMONITOR_H
+#define WAKEUPMONITOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+
+// Counts the events that wake the GUI thread's event loop - timer fires
+// and queued calls from other threads - by the object they are for, plus
+// the wakeups that threads sleeping outside an event loop report. Off by
+// default; while on, an application event filter sees every event.
+class WakeupMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Statistics {
+        quint64 wakeups = 0;
+        double seconds = 0.0;
+        QHash<QString, quint64> sources;    // "Class (object name)" to wakeups
+        
+        double perSecond() const { return seconds > 0.0 ? wakeups / seconds : 0.0; }
+    };
+    
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    
+    static Statistics statistics();
+    static void reset();
+    
+    // One wakeup of a thread without an event loop; callable from any
+    // thread, and nearly free while the monitor is off
+    static void recordWakeup(const QString &source);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    WakeupMonitor();
+    static WakeupMonitor *instance();
+    
+    static QString sourceName(QObject *object);
+    
+    std::atomic<bool> m_enabled;
+    QElapsedTimer m_clock;
+    Statistics m_statistics;
+    
+    // Wakeups reported by other threads
+    QMutex m_threadMutex;
+    QHash<QString, quint64> m_threadSources;
+};
+
+#endif // WAKEUPMONITOR_H
@@ -0,0 +1,114 @@
+#ifndef XOSHIRO256_H
+#define XOSHIRO256_H
+
+#include <QtGlobal>
+#include <cmath>
+
+// xoshiro256++ pseudo random generator (Blackman & Vigna). Small, fast and
+// reproducible across platforms; jump() splits one seed into 2^128 long
+// non-overlapping streams for parallel workers. Kept inline because it
+// sits in the innermost simulation loops.
+class Xoshiro256
+{
+public:
+    explicit Xoshiro256(quint64 seed = 0x9E3779B97F4A7C15ULL)
+    {
+        // Expand the seed with splitmix64 so that nearby seeds differ
+        for (int i = 0; i < 4; ++i) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            quint64 z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            m_s[i] = z ^ (z >> 31);
+        }
+    }
+    
+    quint64 next()
+    {
+        const quint64 result = rotl(m_s[0] + m_s[3], 23) + m_s[0];
+        const quint64 t = m_s[1] << 17;
+        
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl(m_s[3], 45);
+        
+        return result;
+    }
+    
+    // Uniform in [0, 1)
+    double uniform()
+    {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+    
+    double uniform(double low, double high)
+    {
+        return low + (high - low) * uniform();
+    }
+    
+    // Standard normal (Box-Muller, second value cached)
+    double normal()
+    {
+        if (m_hasSpare) {
+            m_hasSpare = false;
+            return m_spare;
+        }
+        
+        double u1 = 1.0 - uniform();    // (0, 1] keeps log() finite
+        double u2 = uniform();
+        double radius = std::sqrt(-2.0 * std::log(u1));
+        double angle = 6.283185307179586 * u2;
+        
+        m_spare = radius * std::sin(angle);
+        m_hasSpare = true;
+        return radius * std::cos(angle);
+    }
+    
+    // Fill a buffer with N(mean, stddev) samples
+    void fillNormal(double *out, int count, double mean, double stddev)
+    {
+        for (int i = 0; i < count; ++i) {
+            out[i] = mean + stddev * normal();
+        }
+    }
+    
+    // Equivalent to 2^128 calls to next()
+    void jump()
+    {
+        static const quint64 kJump[] = {
+            0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+            0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+        };
+        
+        quint64 s[4] = {0, 0, 0, 0};
+        for (quint64 word : kJump) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (quint64(1) << b)) {
+                    for (int i = 0; i < 4; ++i) {
+                        s[i] ^= m_s[i];
+                    }
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            m_s[i] = s[i];
+        }
+        m_hasSpare = false;
+    }
+
+private:
+    static quint64 rotl(quint64 x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+    
+    quint64 m_s[4];
+    double m_spare = 0.0;
+    bool m_hasSpare = false;
+};
+
+#endif // XOSHIRO256_H